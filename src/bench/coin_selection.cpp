@@ -3,6 +3,10 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <bench/bench.h>
+#include <chain.h>
+#include <key.h>
+#include <random.h>
+#include <validation.h>
 #include <wallet/wallet.h>
 
 #include <set>
@@ -56,4 +60,60 @@ static void CoinSelection(benchmark::State& state)
     }
 }
 
+// A long lived wallet: most of its history has been spent, and only a few
+// hundred coins are left to enumerate.
+static const int LARGE_WALLET_TX_COUNT = 50000;
+static const int LARGE_WALLET_UNSPENT_COUNT = 200;
+
+static void AvailableCoinsLargeWallet(benchmark::State& state)
+{
+    CWallet wallet;
+    CKey key;
+    key.MakeNewKey(true);
+    const CScript scriptMine = GetScriptForDestination(key.GetPubKey().GetID());
+    const CScript scriptOther = CScript() << OP_TRUE;
+
+    LOCK2(cs_main, wallet.cs_wallet);
+    wallet.LoadKey(key, key.GetPubKey());
+
+    // Confirm everything in a single block at the tip
+    uint256 hashTip = GetRandHash();
+    CBlockIndex index;
+    index.phashBlock = &hashTip;
+    mapBlockIndex[hashTip] = &index;
+    CBlockIndex* pindexOldTip = chainActive.Tip();
+    chainActive.SetTip(&index);
+
+    for (int i = 0; i < LARGE_WALLET_TX_COUNT; i++) {
+        CMutableTransaction tx;
+        tx.nLockTime = i; // so all transactions get different hashes
+        tx.vout.emplace_back(COIN, scriptMine);
+        CWalletTx wtx(&wallet, MakeTransactionRef(std::move(tx)));
+        wtx.hashBlock = hashTip;
+        wtx.nIndex = 0;
+        wallet.LoadToWallet(wtx);
+
+        if (i < LARGE_WALLET_UNSPENT_COUNT)
+            continue;
+
+        CMutableTransaction txSpend;
+        txSpend.vin.emplace_back(wtx.GetHash(), 0);
+        txSpend.vout.emplace_back(COIN, scriptOther);
+        CWalletTx wtxSpend(&wallet, MakeTransactionRef(std::move(txSpend)));
+        wtxSpend.hashBlock = hashTip;
+        wtxSpend.nIndex = 0;
+        wallet.LoadToWallet(wtxSpend);
+    }
+
+    while (state.KeepRunning()) {
+        std::vector<COutput> vCoins;
+        wallet.AvailableCoins(vCoins);
+        assert(vCoins.size() == LARGE_WALLET_UNSPENT_COUNT);
+    }
+
+    chainActive.SetTip(pindexOldTip);
+    mapBlockIndex.erase(hashTip);
+}
+
 BENCHMARK(CoinSelection, 650);
+BENCHMARK(AvailableCoinsLargeWallet, 20);
@@ -0,0 +1,71 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <dbwrapper.h>
+#include <fs.h>
+#include <random.h>
+#include <uint256.h>
+
+#include <utility>
+#include <vector>
+
+static const int DB_PROFILE_BENCH_COINS = 20000;
+static const int DB_PROFILE_BENCH_BATCH = 2000;
+
+// The chainstate's share of initial block download: batches of new coins
+// flushed to disk, with earlier coins spent and looked up in between, plus
+// lookups of outpoints that were never created.
+static void DBProfileIBD(benchmark::State& state, const CDBProfile& profile)
+{
+    FastRandomContext rng(true);
+    std::vector<std::pair<uint256, uint32_t>> vKeys;
+    vKeys.reserve(DB_PROFILE_BENCH_COINS);
+    for (int i = 0; i < DB_PROFILE_BENCH_COINS; i++)
+        vKeys.emplace_back(rng.rand256(), rng.randrange(4));
+    std::vector<unsigned char> vchValue(40);
+    for (unsigned char& ch : vchValue)
+        ch = rng.randbits(2); // scriptPubKeys and amounts repeat a lot of bytes
+
+    fs::path path = fs::temp_directory_path() / fs::unique_path();
+    while (state.KeepRunning()) {
+        CDBWrapper dbw(path, 1 << 20, false, true, false, profile);
+        uint256 hashMissing;
+        std::vector<unsigned char> vchRead;
+        for (int nBatch = 0; nBatch < DB_PROFILE_BENCH_COINS; nBatch += DB_PROFILE_BENCH_BATCH) {
+            CDBBatch batch(dbw);
+            for (int i = nBatch; i < nBatch + DB_PROFILE_BENCH_BATCH; i++)
+                batch.Write(std::make_pair('C', vKeys[i]), vchValue);
+            // Spend half of the previous batch
+            for (int i = nBatch - DB_PROFILE_BENCH_BATCH; i >= 0 && i < nBatch; i += 2)
+                batch.Erase(std::make_pair('C', vKeys[i]));
+            dbw.WriteBatch(batch);
+
+            for (int i = 0; i < nBatch; i += 7) {
+                dbw.Read(std::make_pair('C', vKeys[i]), vchRead);
+                hashMissing = rng.rand256();
+                dbw.Exists(std::make_pair('C', std::make_pair(hashMissing, (uint32_t)0)));
+            }
+        }
+    }
+    fs::remove_all(path);
+}
+
+static void DBProfileDefault(benchmark::State& state)
+{
+    DBProfileIBD(state, CDBProfile());
+}
+
+static void DBProfileLargeBloom(benchmark::State& state)
+{
+    CDBProfile profile;
+    profile.nBloomBits = 16;
+    profile.nMaxOpenFiles = 1000;
+    profile.nBlockSize = 16 * 1024;
+    DBProfileIBD(state, profile);
+}
+
+BENCHMARK(DBProfileDefault, 2);
+BENCHMARK(DBProfileLargeBloom, 2);
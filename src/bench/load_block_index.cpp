@@ -0,0 +1,81 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <fs.h>
+#include <pow.h>
+#include <txdb.h>
+#include <util.h>
+#include <validation.h>
+
+#include <memory>
+#include <unordered_map>
+
+static const int BLOCK_INDEX_BENCH_SIZE = 20000;
+
+// Build an in-memory block tree with a regtest-difficulty header chain
+static void WriteBlockIndexChain(CBlockTreeDB& blocktree, const Consensus::Params& params, int nBlocks)
+{
+    std::vector<std::unique_ptr<CBlockIndex>> vIndex;
+    std::vector<uint256> vHash(nBlocks);
+    std::vector<const CBlockIndex*> vBlockInfo;
+
+    for (int i = 0; i < nBlocks; i++) {
+        CBlockHeader header;
+        header.nVersion = 1;
+        header.hashPrevBlock = i ? vHash[i - 1] : uint256();
+        header.nTime = 1500000000 + i * 600;
+        header.nBits = UintToArith256(params.powLimit).GetCompact();
+        while (!CheckProofOfWork(header.GetHash(), header.nBits, params))
+            header.nNonce++;
+
+        vIndex.emplace_back(new CBlockIndex(header));
+        vHash[i] = header.GetHash();
+        vIndex.back()->phashBlock = &vHash[i];
+        vIndex.back()->pprev = i ? vIndex[i - 1].get() : nullptr;
+        vIndex.back()->nHeight = i;
+        vIndex.back()->nTx = 1;
+        vIndex.back()->nStatus = BLOCK_VALID_SCRIPTS | BLOCK_HAVE_DATA;
+        vBlockInfo.push_back(vIndex.back().get());
+    }
+
+    assert(blocktree.WriteBatchSync({}, 0, vBlockInfo));
+}
+
+static void LoadBlockIndexGuts(benchmark::State& state)
+{
+    // The block tree lives in memory, but its constructor still resolves the datadir
+    SelectParams(CBaseChainParams::REGTEST);
+    fs::path pathTemp = fs::temp_directory_path() / strprintf("bench_block_index_%lu", (unsigned long)GetTime());
+    fs::create_directories(pathTemp);
+    gArgs.ForceSetArg("-datadir", pathTemp.string());
+    ClearDatadirCache();
+
+    const Consensus::Params& params = Params().GetConsensus();
+    std::unique_ptr<CBlockTreeDB> blocktree(new CBlockTreeDB(1 << 23, true));
+    WriteBlockIndexChain(*blocktree, params, BLOCK_INDEX_BENCH_SIZE);
+
+    while (state.KeepRunning()) {
+        std::unordered_map<uint256, std::unique_ptr<CBlockIndex>, BlockHasher> mapIndex;
+        mapIndex.reserve(BLOCK_INDEX_BENCH_SIZE);
+        auto insert = [&mapIndex](const uint256& hash) -> CBlockIndex* {
+            if (hash.IsNull())
+                return nullptr;
+            std::unique_ptr<CBlockIndex>& pindex = mapIndex[hash];
+            if (!pindex)
+                pindex.reset(new CBlockIndex());
+            return pindex.get();
+        };
+        assert(blocktree->LoadBlockIndexGuts(params, insert));
+        assert(mapIndex.size() == BLOCK_INDEX_BENCH_SIZE);
+    }
+
+    blocktree.reset();
+    fs::remove_all(pathTemp);
+}
+
+BENCHMARK(LoadBlockIndexGuts, 20);
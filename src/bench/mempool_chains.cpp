@@ -0,0 +1,81 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <policy/policy.h>
+#include <random.h>
+#include <txmempool.h>
+
+#include <vector>
+
+static const int CHAIN_LENGTH = 500;
+static const int FANOUT_WIDTH = 500;
+
+static CTransactionRef MakeTx(const std::vector<COutPoint>& vPrevout, int nOutputs)
+{
+    CMutableTransaction tx;
+    tx.vin.resize(vPrevout.size());
+    for (size_t i = 0; i < vPrevout.size(); i++) {
+        tx.vin[i].prevout = vPrevout[i];
+        tx.vin[i].scriptSig = CScript() << OP_1;
+    }
+    tx.vout.resize(nOutputs);
+    for (int i = 0; i < nOutputs; i++) {
+        tx.vout[i].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+        tx.vout[i].nValue = COIN;
+    }
+    return MakeTransactionRef(tx);
+}
+
+static void AddTx(const CTransactionRef& tx, CTxMemPool& pool)
+{
+    LockPoints lp;
+    pool.addUnchecked(tx->GetHash(), CTxMemPoolEntry(tx, 1000, 0, 1, false, false, 0, 4, lp));
+}
+
+// A chain of spends, like a run of sidechain deposits each spending the last,
+// accepted and then confirmed in a single block.
+static void MempoolLongChain(benchmark::State& state)
+{
+    std::vector<CTransactionRef> vtx;
+    vtx.push_back(MakeTx({COutPoint(GetRandHash(), 0)}, 1));
+    for (int i = 1; i < CHAIN_LENGTH; i++)
+        vtx.push_back(MakeTx({COutPoint(vtx.back()->GetHash(), 0)}, 1));
+
+    while (state.KeepRunning()) {
+        CTxMemPool pool;
+        for (const CTransactionRef& tx : vtx)
+            AddTx(tx, pool);
+        pool.removeForBlock(vtx, 1);
+        assert(pool.size() == 0);
+    }
+}
+
+// One transaction with many children that are confirmed in a later block,
+// and a sweep spending all of them that stays behind.
+static void MempoolWideFanout(benchmark::State& state)
+{
+    CTransactionRef txParent = MakeTx({COutPoint(GetRandHash(), 0)}, FANOUT_WIDTH);
+    std::vector<CTransactionRef> vChildren;
+    std::vector<COutPoint> vSweepInputs;
+    for (int i = 0; i < FANOUT_WIDTH; i++) {
+        vChildren.push_back(MakeTx({COutPoint(txParent->GetHash(), i)}, 1));
+        vSweepInputs.emplace_back(vChildren.back()->GetHash(), 0);
+    }
+    CTransactionRef txSweep = MakeTx(vSweepInputs, 1);
+
+    while (state.KeepRunning()) {
+        CTxMemPool pool;
+        AddTx(txParent, pool);
+        for (const CTransactionRef& tx : vChildren)
+            AddTx(tx, pool);
+        AddTx(txSweep, pool);
+        pool.removeForBlock({txParent}, 1);
+        pool.removeForBlock(vChildren, 2);
+        assert(pool.size() == 1);
+    }
+}
+
+BENCHMARK(MempoolLongChain, 5);
+BENCHMARK(MempoolWideFanout, 5);
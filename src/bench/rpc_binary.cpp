@@ -0,0 +1,67 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <rpc/protocol.h>
+#include <streams.h>
+#include <uint256.h>
+#include <version.h>
+
+#include <univalue.h>
+
+// A sync client's round trip: a batch of getblockhash calls and their replies,
+// each encoded by the client, decoded by the server, encoded and decoded back.
+static const int RPC_BATCH_SIZE = 1000;
+
+static void RPCBatchJSON(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        UniValue request(UniValue::VARR);
+        for (int i = 0; i < RPC_BATCH_SIZE; i++) {
+            UniValue params(UniValue::VARR);
+            params.push_back(i);
+            request.push_back(JSONRPCRequestObj("getblockhash", params, i));
+        }
+        UniValue requestParsed;
+        assert(requestParsed.read(request.write()));
+
+        UniValue reply(UniValue::VARR);
+        for (size_t i = 0; i < requestParsed.size(); i++)
+            reply.push_back(JSONRPCReplyObj(uint256().GetHex(), NullUniValue, find_value(requestParsed[i], "id")));
+        UniValue replyParsed;
+        assert(replyParsed.read(reply.write()));
+        assert(replyParsed.size() == RPC_BATCH_SIZE);
+    }
+}
+
+static void RPCBatchBinary(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        std::vector<BinaryRPCCall> vCall;
+        vCall.reserve(RPC_BATCH_SIZE);
+        for (int i = 0; i < RPC_BATCH_SIZE; i++) {
+            UniValue params(UniValue::VARR);
+            params.push_back(i);
+            vCall.emplace_back("getblockhash", params);
+        }
+        CDataStream ssRequest(SER_NETWORK, PROTOCOL_VERSION);
+        ssRequest << vCall;
+        std::vector<BinaryRPCCall> vCallParsed;
+        ssRequest >> vCallParsed;
+
+        std::vector<BinaryRPCReply> vReply;
+        vReply.reserve(vCallParsed.size());
+        for (size_t i = 0; i < vCallParsed.size(); i++)
+            vReply.emplace_back(false, uint256().GetHex());
+        CDataStream ssReply(SER_NETWORK, PROTOCOL_VERSION);
+        ssReply << vReply;
+        std::vector<BinaryRPCReply> vReplyParsed;
+        ssReply >> vReplyParsed;
+        assert(vReplyParsed.size() == RPC_BATCH_SIZE);
+    }
+}
+
+BENCHMARK(RPCBatchJSON, 50);
+BENCHMARK(RPCBatchBinary, 150);
@@ -10,6 +10,8 @@
 #include <script/script.h>
 #include <script/sign.h>
 #include <streams.h>
+#include <tinyformat.h>
+#include <uint256.h>
 
 #include <array>
 
@@ -105,4 +107,76 @@ static void VerifyScriptBench(benchmark::State& state)
     }
 }
 
+static const int MANY_INPUTS_COUNT = 300;
+static const int MANY_OUTPUTS_COUNT = 300;
+
+// A legacy P2PKH transaction with many inputs and outputs, such as a withdrawal
+// bundle payout or a large coinsplit. Every input is signed with SIGHASH_ALL.
+static CTransaction BuildManyInputsTransaction(CScript& scriptPubKey)
+{
+    CKey key;
+    static const std::array<unsigned char, 32> vchKey = {
+        {
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1
+        }
+    };
+    key.Set(vchKey.begin(), vchKey.end(), false);
+    CPubKey pubkey = key.GetPubKey();
+    scriptPubKey = CScript() << OP_DUP << OP_HASH160 << ToByteVector(pubkey.GetID()) << OP_EQUALVERIFY << OP_CHECKSIG;
+
+    CMutableTransaction tx;
+    tx.nVersion = 1;
+    tx.vin.resize(MANY_INPUTS_COUNT);
+    for (int i = 0; i < MANY_INPUTS_COUNT; i++) {
+        tx.vin[i].prevout.hash = uint256S(strprintf("%064x", i + 1));
+        tx.vin[i].prevout.n = i;
+    }
+    tx.vout.resize(MANY_OUTPUTS_COUNT);
+    for (int i = 0; i < MANY_OUTPUTS_COUNT; i++) {
+        tx.vout[i].scriptPubKey = scriptPubKey;
+        tx.vout[i].nValue = 1;
+    }
+    for (int i = 0; i < MANY_INPUTS_COUNT; i++) {
+        std::vector<unsigned char> vchSig;
+        key.Sign(SignatureHash(scriptPubKey, tx, i, SIGHASH_ALL, 0, SIGVERSION_BASE), vchSig);
+        vchSig.push_back(static_cast<unsigned char>(SIGHASH_ALL));
+        tx.vin[i].scriptSig = CScript() << vchSig << ToByteVector(pubkey);
+    }
+    return CTransaction(tx);
+}
+
+// Verification of every input of a large legacy transaction, as a block does
+static void VerifyScriptManyInputs(benchmark::State& state)
+{
+    CScript scriptPubKey;
+    const CTransaction tx = BuildManyInputsTransaction(scriptPubKey);
+
+    while (state.KeepRunning()) {
+        PrecomputedTransactionData txdata(tx);
+        for (int i = 0; i < MANY_INPUTS_COUNT; i++) {
+            ScriptError err;
+            bool success = VerifyScript(tx.vin[i].scriptSig, scriptPubKey, nullptr, SCRIPT_VERIFY_P2SH,
+                TransactionSignatureChecker(&tx, i, 0, txdata), &err);
+            assert(err == SCRIPT_ERR_OK);
+            assert(success);
+        }
+    }
+}
+
+// Only the signature hashes of the transaction above, which legacy inputs
+// make quadratic in the size of the transaction
+static void SignatureHashManyInputs(benchmark::State& state)
+{
+    CScript scriptPubKey;
+    const CTransaction tx = BuildManyInputsTransaction(scriptPubKey);
+
+    while (state.KeepRunning()) {
+        PrecomputedTransactionData txdata(tx);
+        for (int i = 0; i < MANY_INPUTS_COUNT; i++)
+            SignatureHash(scriptPubKey, tx, i, SIGHASH_ALL, 0, SIGVERSION_BASE, &txdata);
+    }
+}
+
 BENCHMARK(VerifyScriptBench, 6300);
+BENCHMARK(VerifyScriptManyInputs, 2);
+BENCHMARK(SignatureHashManyInputs, 20);
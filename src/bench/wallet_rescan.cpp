@@ -0,0 +1,54 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <key.h>
+#include <primitives/block.h>
+#include <script/standard.h>
+#include <wallet/wallet.h>
+
+// A synthetic chain of full blocks paying to keys the wallet does not know,
+// matched against a wallet with a filled keypool as a rescan does.
+static const int RESCAN_BENCH_BLOCKS = 64;
+static const int RESCAN_BENCH_BLOCK_TXS = 500;
+static const int RESCAN_BENCH_WALLET_KEYS = 1000;
+
+static void WalletRescanMatch(benchmark::State& state)
+{
+    CWallet wallet;
+    {
+        LOCK(wallet.cs_wallet);
+        for (int i = 0; i < RESCAN_BENCH_WALLET_KEYS; i++) {
+            CKey key;
+            key.MakeNewKey(true);
+            wallet.LoadKey(key, key.GetPubKey());
+        }
+    }
+
+    std::vector<RescanBlock> vBlocks;
+    for (int i = 0; i < RESCAN_BENCH_BLOCKS; i++) {
+        vBlocks.emplace_back(nullptr);
+        RescanBlock& entry = vBlocks.back();
+        for (int j = 0; j < RESCAN_BENCH_BLOCK_TXS; j++) {
+            CKey key;
+            key.MakeNewKey(true);
+            CMutableTransaction tx;
+            tx.nLockTime = i * RESCAN_BENCH_BLOCK_TXS + j; // so all transactions get different hashes
+            tx.vin.resize(1);
+            tx.vout.emplace_back(COIN, GetScriptForDestination(key.GetPubKey().GetID()));
+            tx.vout.emplace_back(COIN, GetScriptForDestination(WitnessV0KeyHash(key.GetPubKey().GetID())));
+            entry.block.vtx.push_back(MakeTransactionRef(std::move(tx)));
+        }
+        entry.fRead = true;
+    }
+
+    while (state.KeepRunning()) {
+        wallet.ReadRescanBlocks(vBlocks);
+        assert(vBlocks.back().vMine.size() == RESCAN_BENCH_BLOCK_TXS);
+        assert(!vBlocks.back().vMine.back());
+    }
+}
+
+BENCHMARK(WalletRescanMatch, 10);
@@ -0,0 +1,90 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockcache.h>
+
+CBlockReadCache::CBlockReadCache(size_t nMaxSizeIn) : nMaxSize(nMaxSizeIn), nTotalSize(0), nHits(0), nMisses(0)
+{
+}
+
+void CBlockReadCache::Trim()
+{
+    AssertLockHeld(cs);
+    while (nTotalSize > nMaxSize && !entries.empty()) {
+        const CacheEntry& entry = entries.back();
+        nTotalSize -= entry.nSize;
+        mapEntries.erase(entry.hash);
+        entries.pop_back();
+    }
+}
+
+std::shared_ptr<const CBlock> CBlockReadCache::Get(const uint256& hash)
+{
+    LOCK(cs);
+    auto it = mapEntries.find(hash);
+    if (it == mapEntries.end()) {
+        nMisses++;
+        return nullptr;
+    }
+    nHits++;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->block;
+}
+
+void CBlockReadCache::Insert(const std::shared_ptr<const CBlock>& block, size_t nSize)
+{
+    LOCK(cs);
+    if (nSize > nMaxSize)
+        return;
+    const uint256 hash = block->GetHash();
+    auto it = mapEntries.find(hash);
+    if (it != mapEntries.end()) {
+        // Another reader got here first
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+    entries.push_front(CacheEntry{hash, block, nSize});
+    mapEntries.emplace(hash, entries.begin());
+    nTotalSize += nSize;
+    Trim();
+}
+
+void CBlockReadCache::SetMaxSize(size_t nMaxSizeIn)
+{
+    LOCK(cs);
+    nMaxSize = nMaxSizeIn;
+    Trim();
+}
+
+void CBlockReadCache::Clear()
+{
+    LOCK(cs);
+    entries.clear();
+    mapEntries.clear();
+    nTotalSize = 0;
+}
+
+size_t CBlockReadCache::GetTotalSize() const
+{
+    LOCK(cs);
+    return nTotalSize;
+}
+
+size_t CBlockReadCache::GetCount() const
+{
+    LOCK(cs);
+    return entries.size();
+}
+
+uint64_t CBlockReadCache::GetHits() const
+{
+    LOCK(cs);
+    return nHits;
+}
+
+uint64_t CBlockReadCache::GetMisses() const
+{
+    LOCK(cs);
+    return nMisses;
+}
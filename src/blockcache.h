@@ -0,0 +1,70 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_BLOCKCACHE_H
+#define BITCOIN_BLOCKCACHE_H
+
+#include <primitives/block.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <list>
+#include <memory>
+#include <stdint.h>
+#include <unordered_map>
+
+/** Default for -blockreadcache, in MiB */
+static const int64_t DEFAULT_BLOCK_READ_CACHE = 32;
+
+/**
+ * Least recently used cache of blocks read from disk, bounded by their
+ * serialized size. Blocks are shared as immutable objects, so a block handed
+ * out stays valid after it has been evicted.
+ */
+class CBlockReadCache
+{
+private:
+    struct CacheHasher
+    {
+        size_t operator()(const uint256& hash) const { return hash.GetCheapHash(); }
+    };
+    struct CacheEntry
+    {
+        uint256 hash;
+        std::shared_ptr<const CBlock> block;
+        size_t nSize;
+    };
+
+    mutable CCriticalSection cs;
+    //! Most recently used entries first
+    std::list<CacheEntry> entries;
+    std::unordered_map<uint256, std::list<CacheEntry>::iterator, CacheHasher> mapEntries;
+    size_t nMaxSize;
+    size_t nTotalSize;
+    uint64_t nHits;
+    uint64_t nMisses;
+
+    void Trim();
+
+public:
+    explicit CBlockReadCache(size_t nMaxSizeIn);
+
+    /** Return the cached block with this hash, or nullptr. */
+    std::shared_ptr<const CBlock> Get(const uint256& hash);
+
+    /** Add a block of serialized size nSize. Blocks larger than the whole cache are not kept. */
+    void Insert(const std::shared_ptr<const CBlock>& block, size_t nSize);
+
+    /** Change the size limit, evicting blocks as needed. Zero disables the cache. */
+    void SetMaxSize(size_t nMaxSizeIn);
+
+    void Clear();
+
+    size_t GetTotalSize() const;
+    size_t GetCount() const;
+    uint64_t GetHits() const;
+    uint64_t GetMisses() const;
+};
+
+#endif // BITCOIN_BLOCKCACHE_H
@@ -0,0 +1,193 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockwriter.h>
+
+#include <clientversion.h>
+#include <streams.h>
+#include <util.h>
+#include <validation.h>
+
+#include <functional>
+
+CBlockFileWriter::CBlockFileWriter(size_t nMaxPendingIn) : nMaxPending(nMaxPendingIn), nPendingSize(0), fFailed(false), fStop(false)
+{
+}
+
+CBlockFileWriter::~CBlockFileWriter()
+{
+    Stop();
+}
+
+bool CBlockFileWriter::WriteTaskToDisk(const WriteTask& task)
+{
+    if (!task.block) {
+        FILE* file = OpenBlockFile(CDiskBlockPos(task.pos.nFile, 0));
+        if (!file)
+            return error("%s: OpenBlockFile failed for blk%05u.dat", __func__, task.pos.nFile);
+        TruncateFile(file, task.nSize);
+        FileCommit(file);
+        fclose(file);
+        std::lock_guard<std::mutex> lock(cs);
+        setDirtyFiles.erase(task.pos.nFile);
+        return true;
+    }
+
+    // The index header is written in front of the block data
+    CDiskBlockPos posHeader(task.pos.nFile, task.pos.nPos - CMessageHeader::MESSAGE_START_SIZE - sizeof(task.nSize));
+    {
+        CAutoFile fileout(OpenBlockFile(posHeader), SER_DISK, CLIENT_VERSION);
+        if (fileout.IsNull())
+            return error("%s: OpenBlockFile failed for %s", __func__, task.pos.ToString());
+        try {
+            fileout << FLATDATA(task.messageStart) << task.nSize << *task.block;
+        } catch (const std::exception& e) {
+            return error("%s: I/O error - %s at %s", __func__, e.what(), task.pos.ToString());
+        }
+    }
+    std::lock_guard<std::mutex> lock(cs);
+    setDirtyFiles.insert(task.pos.nFile);
+    return true;
+}
+
+void CBlockFileWriter::ThreadWrite()
+{
+    std::unique_lock<std::mutex> lock(cs);
+    while (true) {
+        cvWork.wait(lock, [this] { return fStop || !queue.empty(); });
+        if (queue.empty())
+            return;
+
+        // Other threads may queue more work while this task is written
+        const WriteTask task = queue.front();
+        lock.unlock();
+        bool fOk = WriteTaskToDisk(task);
+        lock.lock();
+
+        queue.pop_front();
+        if (!fOk)
+            fFailed = true;
+        if (task.block) {
+            mapPending.erase(std::make_pair(task.pos.nFile, task.pos.nPos));
+            nPendingSize -= task.nSize;
+        }
+        cvDone.notify_all();
+    }
+}
+
+void CBlockFileWriter::Start()
+{
+    std::lock_guard<std::mutex> lock(cs);
+    if (threadWriter.joinable())
+        return;
+    fStop = false;
+    threadWriter = std::thread(&TraceThread<std::function<void()> >, "blkwrite", std::function<void()>(std::bind(&CBlockFileWriter::ThreadWrite, this)));
+}
+
+void CBlockFileWriter::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        fStop = true;
+    }
+    cvWork.notify_all();
+    if (threadWriter.joinable())
+        threadWriter.join();
+}
+
+bool CBlockFileWriter::IsRunning() const
+{
+    std::lock_guard<std::mutex> lock(cs);
+    return threadWriter.joinable() && !fStop;
+}
+
+bool CBlockFileWriter::Write(const std::shared_ptr<const CBlock>& block, const CDiskBlockPos& pos, unsigned int nSize, const CMessageHeader::MessageStartChars& messageStart)
+{
+    WriteTask task{pos, block, nSize, {}};
+    memcpy(task.messageStart, messageStart, CMessageHeader::MESSAGE_START_SIZE);
+
+    std::unique_lock<std::mutex> lock(cs);
+    if (fFailed)
+        return false;
+    if (!threadWriter.joinable() || fStop) {
+        lock.unlock();
+        return WriteTaskToDisk(task);
+    }
+
+    // A block larger than the limit is still queued once the queue is empty
+    cvDone.wait(lock, [&] { return fFailed || queue.empty() || nPendingSize + nSize <= nMaxPending; });
+    queue.push_back(task);
+    mapPending.emplace(std::make_pair(pos.nFile, pos.nPos), block);
+    nPendingSize += nSize;
+    cvWork.notify_one();
+    return !fFailed;
+}
+
+void CBlockFileWriter::Finalize(int nFile, unsigned int nSize)
+{
+    WriteTask task{CDiskBlockPos(nFile, 0), nullptr, nSize, {}};
+
+    std::unique_lock<std::mutex> lock(cs);
+    if (!threadWriter.joinable() || fStop) {
+        lock.unlock();
+        WriteTaskToDisk(task);
+        return;
+    }
+    queue.push_back(task);
+    cvWork.notify_one();
+}
+
+bool CBlockFileWriter::Flush()
+{
+    std::set<int> setCommit;
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        cvDone.wait(lock, [this] { return queue.empty(); });
+        setCommit.swap(setDirtyFiles);
+    }
+
+    for (int nFile : setCommit) {
+        FILE* file = OpenBlockFile(CDiskBlockPos(nFile, 0));
+        if (file) {
+            FileCommit(file);
+            fclose(file);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(cs);
+    return !fFailed;
+}
+
+std::shared_ptr<const CBlock> CBlockFileWriter::Get(const CDiskBlockPos& pos) const
+{
+    std::lock_guard<std::mutex> lock(cs);
+    auto it = mapPending.find(std::make_pair(pos.nFile, pos.nPos));
+    if (it == mapPending.end())
+        return nullptr;
+    return it->second;
+}
+
+void CBlockFileWriter::WaitFor(const CDiskBlockPos& pos) const
+{
+    std::unique_lock<std::mutex> lock(cs);
+    cvDone.wait(lock, [&] { return !mapPending.count(std::make_pair(pos.nFile, pos.nPos)); });
+}
+
+void CBlockFileWriter::SetMaxPending(size_t nMaxPendingIn)
+{
+    std::lock_guard<std::mutex> lock(cs);
+    nMaxPending = nMaxPendingIn;
+}
+
+size_t CBlockFileWriter::GetPendingSize() const
+{
+    std::lock_guard<std::mutex> lock(cs);
+    return nPendingSize;
+}
+
+size_t CBlockFileWriter::GetPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(cs);
+    return mapPending.size();
+}
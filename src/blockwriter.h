@@ -0,0 +1,105 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_BLOCKWRITER_H
+#define BITCOIN_BLOCKWRITER_H
+
+#include <chain.h>
+#include <primitives/block.h>
+#include <protocol.h>
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdint.h>
+#include <thread>
+#include <utility>
+
+/** Default for -blockwritebuffer, in MiB */
+static const int64_t DEFAULT_BLOCK_WRITE_BUFFER = 64;
+
+/**
+ * Writes blocks to the block files from a background thread. Positions are
+ * still assigned by the caller, so blocks may be handed over in any order;
+ * the writer appends them in the order they were queued and only syncs the
+ * files when asked to flush, so many blocks share a single fsync.
+ *
+ * Blocks stay available from memory until they have been written. Without a
+ * running thread every call does its I/O immediately.
+ */
+class CBlockFileWriter
+{
+private:
+    struct WriteTask
+    {
+        //! Position of the block data, or of the file to finalize
+        CDiskBlockPos pos;
+        //! nullptr to truncate pos.nFile to nSize and sync it
+        std::shared_ptr<const CBlock> block;
+        unsigned int nSize;
+        CMessageHeader::MessageStartChars messageStart;
+    };
+
+    mutable std::mutex cs;
+    //! Signalled when tasks are queued or the thread should stop
+    std::condition_variable cvWork;
+    //! Signalled when a task has been completed
+    mutable std::condition_variable cvDone;
+    //! The front task is the one being written
+    std::deque<WriteTask> queue;
+    //! Blocks not yet written, by file and data position
+    std::map<std::pair<int, unsigned int>, std::shared_ptr<const CBlock>> mapPending;
+    //! Files written since they were last synced
+    std::set<int> setDirtyFiles;
+    size_t nMaxPending;
+    size_t nPendingSize;
+    bool fFailed;
+    bool fStop;
+    std::thread threadWriter;
+
+    bool WriteTaskToDisk(const WriteTask& task);
+    void ThreadWrite();
+
+public:
+    explicit CBlockFileWriter(size_t nMaxPendingIn);
+    ~CBlockFileWriter();
+
+    /** Start writing in the background. */
+    void Start();
+
+    /** Write out everything queued and stop the background thread. */
+    void Stop();
+
+    bool IsRunning() const;
+
+    /**
+     * Queue a block of serialized size nSize whose data starts at pos, behind
+     * its index header. Waits while more than the size limit is queued.
+     * Returns false if an earlier write failed.
+     */
+    bool Write(const std::shared_ptr<const CBlock>& block, const CDiskBlockPos& pos, unsigned int nSize, const CMessageHeader::MessageStartChars& messageStart);
+
+    /** Truncate a block file to nSize and sync it once the blocks queued before have been written. */
+    void Finalize(int nFile, unsigned int nSize);
+
+    /** Wait for all queued writes and sync the files they touched. Returns false if any write failed. */
+    bool Flush();
+
+    /** Return the block at pos if it has not been written yet, or nullptr. */
+    std::shared_ptr<const CBlock> Get(const CDiskBlockPos& pos) const;
+
+    /** Wait until the block at pos can be read from disk. */
+    void WaitFor(const CDiskBlockPos& pos) const;
+
+    /** Change the limit on the size of queued blocks. */
+    void SetMaxPending(size_t nMaxPendingIn);
+
+    size_t GetPendingSize() const;
+    size_t GetPendingCount() const;
+};
+
+#endif // BITCOIN_BLOCKWRITER_H
@@ -4,6 +4,7 @@
 
 #include <coins.h>
 
+#include <arith_uint256.h>
 #include <consensus/consensus.h>
 #include <random.h>
 #include <sidechain.h>
@@ -261,3 +262,56 @@ const Coin& AccessByTxid(const CCoinsViewCache& view, const uint256& txid)
     }
     return coinEmpty;
 }
+
+void CUTXOSetStats::SetNull()
+{
+    hashBlock.SetNull();
+    nTransactionOutputs = 0;
+    nBogoSize = 0;
+    nTotalAmount = 0;
+    mapSidechainAmount.clear();
+    hashRolling.SetNull();
+}
+
+void CUTXOSetStats::AddCoin(const COutPoint& outpoint, const Coin& coin)
+{
+    ApplyCoin(outpoint, coin, true);
+}
+
+void CUTXOSetStats::RemoveCoin(const COutPoint& outpoint, const Coin& coin)
+{
+    ApplyCoin(outpoint, coin, false);
+}
+
+void CUTXOSetStats::ApplyCoin(const COutPoint& outpoint, const Coin& coin, bool fAdd)
+{
+    CHashWriter ss(SER_GETHASH, 0);
+    ss << outpoint;
+    ss << VARINT(coin.nHeight * 2 + coin.fCoinBase);
+    ss << coin.out;
+    const arith_uint256 hashCoin = UintToArith256(ss.GetHash());
+    arith_uint256 rolling = UintToArith256(hashRolling);
+
+    const int64_t nSign = fAdd ? 1 : -1;
+    const uint64_t nSize = 32 /* txid */ + 4 /* vout index */ + 4 /* height + coinbase */ + 8 /* amount */ +
+                           2 /* scriptPubKey len */ + coin.out.scriptPubKey.size() /* scriptPubKey */;
+    if (fAdd) {
+        rolling += hashCoin;
+        nTransactionOutputs++;
+        nBogoSize += nSize;
+    } else {
+        rolling -= hashCoin;
+        nTransactionOutputs--;
+        nBogoSize -= nSize;
+    }
+    hashRolling = ArithToUint256(rolling);
+    nTotalAmount += nSign * coin.out.nValue;
+
+    uint8_t nSidechain;
+    if (coin.out.scriptPubKey.IsDrivechain(nSidechain)) {
+        CAmount& amount = mapSidechainAmount[nSidechain];
+        amount += nSign * coin.out.nValue;
+        if (!amount)
+            mapSidechainAmount.erase(nSidechain);
+    }
+}
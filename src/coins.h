@@ -17,6 +17,7 @@
 #include <assert.h>
 #include <stdint.h>
 
+#include <map>
 #include <unordered_map>
 
 /**
@@ -319,4 +320,60 @@ void AddCoins(CCoinsViewCache& cache, const CTransaction& tx, int nHeight, bool
 // lookups to database, so it should be used with care.
 const Coin& AccessByTxid(const CCoinsViewCache& cache, const uint256& txid);
 
+/**
+ * Running totals over a UTXO set, updated coin by coin as blocks are
+ * connected and disconnected so they never require walking the database.
+ *
+ * hashRolling commits to the whole set: it is the sum modulo 2^256 of a hash
+ * of every coin, so it does not depend on the order coins were added in and a
+ * spent coin is taken out by subtracting its hash again.
+ */
+class CUTXOSetStats
+{
+public:
+    //! Block the totals are for
+    uint256 hashBlock;
+    uint64_t nTransactionOutputs;
+    uint64_t nBogoSize;
+    CAmount nTotalAmount;
+    //! Value locked in each sidechain's outputs
+    std::map<uint8_t, CAmount> mapSidechainAmount;
+    uint256 hashRolling;
+
+    CUTXOSetStats()
+    {
+        SetNull();
+    }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(hashBlock);
+        READWRITE(nTransactionOutputs);
+        READWRITE(nBogoSize);
+        READWRITE(nTotalAmount);
+        READWRITE(mapSidechainAmount);
+        READWRITE(hashRolling);
+    }
+
+    void SetNull();
+
+    void AddCoin(const COutPoint& outpoint, const Coin& coin);
+    void RemoveCoin(const COutPoint& outpoint, const Coin& coin);
+
+    friend bool operator==(const CUTXOSetStats& a, const CUTXOSetStats& b)
+    {
+        return a.hashBlock == b.hashBlock &&
+               a.nTransactionOutputs == b.nTransactionOutputs &&
+               a.nBogoSize == b.nBogoSize &&
+               a.nTotalAmount == b.nTotalAmount &&
+               a.mapSidechainAmount == b.mapSidechainAmount &&
+               a.hashRolling == b.hashRolling;
+    }
+
+private:
+    void ApplyCoin(const COutPoint& outpoint, const Coin& coin, bool fAdd);
+};
+
 #endif // BITCOIN_COINS_H
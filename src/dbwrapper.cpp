@@ -12,6 +12,8 @@
 #include <memenv.h>
 #include <stdint.h>
 #include <algorithm>
+#include <atomic>
+#include <sstream>
 
 class CBitcoinLevelDBLogger : public leveldb::Logger {
 public:
@@ -71,14 +73,91 @@ public:
     }
 };
 
-static leveldb::Options GetOptions(size_t nCacheSize)
+/** Block cache that counts lookups, so the hit rate can be reported */
+class CCountingCache : public leveldb::Cache {
+private:
+    leveldb::Cache* pcache;
+    const size_t nCapacity;
+    std::atomic<uint64_t> nHits;
+    std::atomic<uint64_t> nMisses;
+
+public:
+    explicit CCountingCache(size_t nCapacityIn) : pcache(leveldb::NewLRUCache(nCapacityIn)), nCapacity(nCapacityIn), nHits(0), nMisses(0) {}
+    ~CCountingCache() { delete pcache; }
+
+    Handle* Insert(const leveldb::Slice& key, void* value, size_t charge, void (*deleter)(const leveldb::Slice& key, void* value)) override {
+        return pcache->Insert(key, value, charge, deleter);
+    }
+    Handle* Lookup(const leveldb::Slice& key) override {
+        Handle* handle = pcache->Lookup(key);
+        if (handle)
+            nHits++;
+        else
+            nMisses++;
+        return handle;
+    }
+    void Release(Handle* handle) override { pcache->Release(handle); }
+    void* Value(Handle* handle) override { return pcache->Value(handle); }
+    void Erase(const leveldb::Slice& key) override { pcache->Erase(key); }
+    uint64_t NewId() override { return pcache->NewId(); }
+    void Prune() override { pcache->Prune(); }
+    size_t TotalCharge() const override { return pcache->TotalCharge(); }
+
+    size_t GetCapacity() const { return nCapacity; }
+    uint64_t GetHits() const { return nHits; }
+    uint64_t GetMisses() const { return nMisses; }
+};
+
+const std::vector<std::string> DB_PROFILE_NAMES = {"chainstate", "index", "sidechain", "opreturn"};
+
+bool ParseDBProfileArg(const std::string& strArg, std::string& strName, std::string& strOption, int& nValue)
+{
+    size_t nColon = strArg.find(':');
+    size_t nEquals = strArg.find('=');
+    if (nColon == std::string::npos || nEquals == std::string::npos || nEquals < nColon)
+        return false;
+    strName = strArg.substr(0, nColon);
+    strOption = strArg.substr(nColon + 1, nEquals - nColon - 1);
+    if (std::find(DB_PROFILE_NAMES.begin(), DB_PROFILE_NAMES.end(), strName) == DB_PROFILE_NAMES.end())
+        return false;
+    if (!ParseInt32(strArg.substr(nEquals + 1), &nValue))
+        return false;
+    if (strOption == "bloombits")
+        return nValue >= 0 && nValue <= 64;
+    if (strOption == "maxopenfiles")
+        return nValue >= 20;
+    if (strOption == "blocksize")
+        return nValue >= 1024 && nValue <= 4 * 1024 * 1024;
+    return false;
+}
+
+CDBProfile GetDBProfile(const std::string& strName)
+{
+    CDBProfile profile;
+    for (const std::string& strArg : gArgs.GetArgs("-dbprofile")) {
+        std::string strArgName, strOption;
+        int nValue;
+        if (!ParseDBProfileArg(strArg, strArgName, strOption, nValue) || strArgName != strName)
+            continue;
+        if (strOption == "bloombits")
+            profile.nBloomBits = nValue;
+        else if (strOption == "maxopenfiles")
+            profile.nMaxOpenFiles = nValue;
+        else if (strOption == "blocksize")
+            profile.nBlockSize = nValue;
+    }
+    return profile;
+}
+
+static leveldb::Options GetOptions(size_t nCacheSize, const CDBProfile& profile)
 {
     leveldb::Options options;
-    options.block_cache = leveldb::NewLRUCache(nCacheSize / 2);
+    options.block_cache = new CCountingCache(nCacheSize / 2);
     options.write_buffer_size = nCacheSize / 4; // up to two write buffers may be held in memory simultaneously
-    options.filter_policy = leveldb::NewBloomFilterPolicy(10);
+    options.filter_policy = profile.nBloomBits > 0 ? leveldb::NewBloomFilterPolicy(profile.nBloomBits) : nullptr;
     options.compression = leveldb::kNoCompression;
-    options.max_open_files = 64;
+    options.max_open_files = profile.nMaxOpenFiles;
+    options.block_size = profile.nBlockSize;
     options.info_log = new CBitcoinLevelDBLogger();
     if (leveldb::kMajorVersion > 1 || (leveldb::kMajorVersion == 1 && leveldb::kMinorVersion >= 16)) {
         // LevelDB versions before 1.16 consider short writes to be corruption. Only trigger error
@@ -88,14 +167,14 @@ static leveldb::Options GetOptions(size_t nCacheSize)
     return options;
 }
 
-CDBWrapper::CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate)
+CDBWrapper::CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate, const CDBProfile& profileIn) : profile(profileIn)
 {
     penv = nullptr;
     readoptions.verify_checksums = true;
     iteroptions.verify_checksums = true;
     iteroptions.fill_cache = false;
     syncoptions.sync = true;
-    options = GetOptions(nCacheSize);
+    options = GetOptions(nCacheSize, profile);
     options.create_if_missing = true;
     if (fMemory) {
         penv = leveldb::NewMemEnv(leveldb::Env::Default());
@@ -187,6 +266,36 @@ bool CDBWrapper::IsEmpty()
     return !(it->Valid());
 }
 
+CDBStats CDBWrapper::GetStats() const
+{
+    CDBStats stats;
+    const CCountingCache* pcache = static_cast<const CCountingCache*>(options.block_cache);
+    stats.nCacheSize = pcache->GetCapacity();
+    stats.nCacheUsage = pcache->TotalCharge();
+    stats.nCacheHits = pcache->GetHits();
+    stats.nCacheMisses = pcache->GetMisses();
+
+    std::string strValue;
+    if (pdb->GetProperty("leveldb.approximate-memory-usage", &strValue))
+        ParseUInt64(strValue, &stats.nMemoryUsage);
+
+    // Rows of the table below the three header lines, one per non-empty level:
+    // level, files, size (MB), compaction time (sec), read (MB), written (MB)
+    strValue.clear();
+    if (pdb->GetProperty("leveldb.stats", &strValue)) {
+        std::istringstream ss(strValue);
+        std::string strLine;
+        for (int i = 0; i < 3 && std::getline(ss, strLine); i++) {}
+        while (std::getline(ss, strLine)) {
+            std::istringstream ssLine(strLine);
+            CDBStats::Level level;
+            if (ssLine >> level.nLevel >> level.nFiles >> level.dSizeMiB >> level.dCompactionSecs >> level.dCompactionReadMiB >> level.dCompactionWriteMiB)
+                stats.vLevels.push_back(level);
+        }
+    }
+    return stats;
+}
+
 CDBIterator::~CDBIterator() { delete piter; }
 bool CDBIterator::Valid() const { return piter->Valid(); }
 void CDBIterator::SeekToFirst() { piter->SeekToFirst(); }
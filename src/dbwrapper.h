@@ -25,6 +25,50 @@ public:
     explicit dbwrapper_error(const std::string& msg) : std::runtime_error(msg) {}
 };
 
+/** LevelDB options that can be tuned per database with -dbprofile */
+struct CDBProfile
+{
+    //! Bits per key of the bloom filter, 0 disables the filter
+    int nBloomBits = 10;
+    int nMaxOpenFiles = 64;
+    //! Approximate size of uncompressed table blocks in bytes
+    int nBlockSize = 4 * 1024;
+};
+
+/** Names of the databases that take a -dbprofile */
+extern const std::vector<std::string> DB_PROFILE_NAMES;
+
+/**
+ * Parse a -dbprofile=<db>:<option>=<value> argument. Returns false if the
+ * database or option is unknown or the value is out of range.
+ */
+bool ParseDBProfileArg(const std::string& strArg, std::string& strName, std::string& strOption, int& nValue);
+
+/** Return the default profile of the named database with any -dbprofile arguments applied */
+CDBProfile GetDBProfile(const std::string& strName);
+
+/** Internal LevelDB statistics of one database */
+struct CDBStats
+{
+    struct Level
+    {
+        int nLevel;
+        int nFiles;
+        double dSizeMiB;
+        //! Time spent compacting into this level and the data read and written by it
+        double dCompactionSecs;
+        double dCompactionReadMiB;
+        double dCompactionWriteMiB;
+    };
+    std::vector<Level> vLevels;
+    //! Block cache plus memtables
+    uint64_t nMemoryUsage = 0;
+    size_t nCacheSize = 0;
+    size_t nCacheUsage = 0;
+    uint64_t nCacheHits = 0;
+    uint64_t nCacheMisses = 0;
+};
+
 class CDBWrapper;
 
 /** These should be considered an implementation detail of the specific database.
@@ -195,6 +239,9 @@ private:
     //! database options used
     leveldb::Options options;
 
+    //! the profile the options were built from
+    CDBProfile profile;
+
     //! options used when reading from the database
     leveldb::ReadOptions readoptions;
 
@@ -229,8 +276,9 @@ public:
      * @param[in] fWipe       If true, remove all existing data.
      * @param[in] obfuscate   If true, store data obfuscated via simple XOR. If false, XOR
      *                        with a zero'd byte array.
+     * @param[in] profileIn   LevelDB tuning for this database.
      */
-    CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory = false, bool fWipe = false, bool obfuscate = false);
+    CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory = false, bool fWipe = false, bool obfuscate = false, const CDBProfile& profileIn = CDBProfile());
     ~CDBWrapper();
 
     template <typename K, typename V>
@@ -339,11 +387,38 @@ public:
         return new CDBIterator(*this, pdb->NewIterator(iteroptions));
     }
 
+    /**
+     * Return an iterator over the state of the database captured by snapshot.
+     * Several iterators created from one snapshot see the same entries.
+     */
+    CDBIterator *NewIterator(const leveldb::Snapshot* snapshot)
+    {
+        leveldb::ReadOptions options = iteroptions;
+        options.snapshot = snapshot;
+        return new CDBIterator(*this, pdb->NewIterator(options));
+    }
+
+    /** Capture the current state of the database. Release it with ReleaseSnapshot. */
+    const leveldb::Snapshot* GetSnapshot()
+    {
+        return pdb->GetSnapshot();
+    }
+
+    void ReleaseSnapshot(const leveldb::Snapshot* snapshot)
+    {
+        pdb->ReleaseSnapshot(snapshot);
+    }
+
     /**
      * Return true if the database managed by this class contains no entries.
      */
     bool IsEmpty();
 
+    const CDBProfile& GetProfile() const { return profile; }
+
+    /** Collect LevelDB's compaction, level and cache statistics */
+    CDBStats GetStats() const;
+
     template<typename K>
     size_t EstimateSize(const K& key_begin, const K& key_end) const
     {
@@ -10,10 +10,12 @@
 #include <rpc/protocol.h>
 #include <rpc/server.h>
 #include <random.h>
+#include <streams.h>
 #include <sync.h>
 #include <util.h>
 #include <utilstrencodings.h>
 #include <ui_interface.h>
+#include <version.h>
 #include <crypto/hmac_sha256.h>
 #include <stdio.h>
 
@@ -22,6 +24,11 @@
 /** WWW-Authenticate to present with 401 Unauthorized response */
 static const char* WWW_AUTH_HEADER_DATA = "Basic realm=\"jsonrpc\"";
 
+/** Results with at least this many elements are streamed as a chunked reply */
+static const size_t STREAM_REPLY_MIN_ELEMENTS = 256;
+/** Size at which a chunk of a streamed reply is handed to the HTTP server */
+static const size_t STREAM_REPLY_CHUNK_SIZE = 64 * 1024;
+
 /** Simple one-shot callback timer to be used by the RPC mechanism to e.g.
  * re-lock the wallet.
  */
@@ -81,6 +88,55 @@ static void JSONErrorReply(HTTPRequest* req, const UniValue& objError, const Uni
     req->WriteReply(nStatus, strReply);
 }
 
+/** Serialize val into strChunk, handing the text to req whenever a chunk
+ * fills up. Arrays and objects are descended into, so no single element has
+ * to be serialized as a whole. Returns false if the client went away.
+ */
+static bool WriteJSONChunked(HTTPRequest* req, const UniValue& val, std::string& strChunk)
+{
+    if (val.isArray() || val.isObject()) {
+        strChunk += val.isArray() ? '[' : '{';
+        for (size_t i = 0; i < val.size(); i++) {
+            if (i)
+                strChunk += ',';
+            if (val.isObject()) {
+                strChunk += UniValue(val.getKeys()[i]).write();
+                strChunk += ':';
+            }
+            if (!WriteJSONChunked(req, val[i], strChunk))
+                return false;
+        }
+        strChunk += val.isArray() ? ']' : '}';
+    } else {
+        strChunk += val.write();
+    }
+    if (strChunk.size() >= STREAM_REPLY_CHUNK_SIZE) {
+        if (!req->WriteReplyChunk(strChunk))
+            return false;
+        strChunk.clear();
+    }
+    return true;
+}
+
+/** Send a JSON-RPC result as a chunked reply. The serialized form of the result
+ * is produced a chunk at a time, and production waits for the client to catch
+ * up, so at most a few chunks of it are held in memory. The output is identical
+ * to JSONRPCReply.
+ */
+static void JSONRPCReplyChunked(HTTPRequest* req, const UniValue& result, const UniValue& id)
+{
+    req->WriteHeader("Content-Type", "application/json");
+    req->StartReplyChunked(HTTP_OK);
+
+    std::string strChunk = "{\"result\":";
+    if (!WriteJSONChunked(req, result, strChunk))
+        return; // the connection is dropped when req is destroyed
+    strChunk += ",\"id\":" + id.write() + ",\"jsonrpc\":\"2.0\"}\n";
+    if (!req->WriteReplyChunk(strChunk))
+        return;
+    req->EndReplyChunked();
+}
+
 //This function checks username and password against -rpcauth
 //entries from config file.
 static bool multiUserAuthorized(std::string strUserPass)
@@ -142,14 +198,11 @@ static bool RPCAuthorized(const std::string& strAuth, std::string& strAuthUserna
     return multiUserAuthorized(strUserPass);
 }
 
-static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
+/** Check the authorization of an RPC request, replying with 401 Unauthorized
+ * if it is missing or incorrect. On success, the user is stored in jreq.
+ */
+static bool HTTPReq_CheckAuthorization(HTTPRequest* req, JSONRPCRequest& jreq)
 {
-    // JSONRPC handles only POST
-    if (req->GetRequestMethod() != HTTPRequest::POST) {
-        req->WriteReply(HTTP_BAD_METHOD, "JSONRPC server handles only POST requests");
-        return false;
-    }
-    // Check authorization
     std::pair<bool, std::string> authHeader = req->GetHeader("authorization");
     if (!authHeader.first) {
         req->WriteHeader("WWW-Authenticate", WWW_AUTH_HEADER_DATA);
@@ -157,7 +210,6 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         return false;
     }
 
-    JSONRPCRequest jreq;
     if (!RPCAuthorized(authHeader.second, jreq.authUser)) {
         LogPrintf("ThreadRPCServer incorrect password attempt from %s\n", req->GetPeer().ToString());
 
@@ -170,6 +222,20 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         req->WriteReply(HTTP_UNAUTHORIZED);
         return false;
     }
+    return true;
+}
+
+static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
+{
+    // JSONRPC handles only POST
+    if (req->GetRequestMethod() != HTTPRequest::POST) {
+        req->WriteReply(HTTP_BAD_METHOD, "JSONRPC server handles only POST requests");
+        return false;
+    }
+    // Check authorization
+    JSONRPCRequest jreq;
+    if (!HTTPReq_CheckAuthorization(req, jreq))
+        return false;
 
     try {
         // Parse request
@@ -179,6 +245,7 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
 
         // Set the URI
         jreq.URI = req->GetURI();
+        jreq.nTimeReceived = req->GetTimeReceived();
 
         std::string strReply;
         // singleton request
@@ -187,6 +254,12 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
 
             UniValue result = tableRPC.execute(jreq);
 
+            // Stream large results instead of serializing them in one piece
+            if ((result.isArray() || result.isObject()) && result.size() >= STREAM_REPLY_MIN_ELEMENTS) {
+                JSONRPCReplyChunked(req, result, jreq.id);
+                return true;
+            }
+
             // Send reply
             strReply = JSONRPCReply(result, NullUniValue, jreq.id);
 
@@ -208,6 +281,55 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
     return true;
 }
 
+static bool HTTPReq_BinaryRPC(HTTPRequest* req, const std::string &)
+{
+    if (req->GetRequestMethod() != HTTPRequest::POST) {
+        req->WriteReply(HTTP_BAD_METHOD, "Binary RPC server handles only POST requests");
+        return false;
+    }
+    JSONRPCRequest jreq;
+    if (!HTTPReq_CheckAuthorization(req, jreq))
+        return false;
+
+    std::vector<BinaryRPCCall> vCall;
+    try {
+        std::string strBody = req->ReadBody();
+        CDataStream ssRequest(strBody.data(), strBody.data() + strBody.size(), SER_NETWORK, PROTOCOL_VERSION);
+        ssRequest >> vCall;
+        if (!ssRequest.empty())
+            throw std::ios_base::failure("Trailing data");
+    } catch (const std::exception& e) {
+        req->WriteReply(HTTP_BAD_REQUEST, strprintf("Invalid binary RPC request: %s", e.what()));
+        return false;
+    }
+
+    jreq.URI = req->GetURI();
+    jreq.nTimeReceived = req->GetTimeReceived();
+
+    std::vector<BinaryRPCReply> vReply(vCall.size());
+    for (size_t i = 0; i < vCall.size(); i++) {
+        jreq.strMethod = vCall[i].strMethod;
+        jreq.params = vCall[i].params;
+        LogPrint(BCLog::RPC, "ThreadRPCServer binary method=%s\n", SanitizeString(jreq.strMethod));
+        try {
+            if (!jreq.params.isArray() && !jreq.params.isObject())
+                throw JSONRPCError(RPC_INVALID_REQUEST, "Params must be an array or object");
+            vReply[i] = BinaryRPCReply(false, tableRPC.execute(jreq));
+        } catch (const UniValue& objError) {
+            vReply[i] = BinaryRPCReply(true, objError);
+        } catch (const std::exception& e) {
+            vReply[i] = BinaryRPCReply(true, JSONRPCError(RPC_MISC_ERROR, e.what()));
+        }
+        jreq.nTimeReceived = GetTimeMicros();
+    }
+
+    CDataStream ssReply(SER_NETWORK, PROTOCOL_VERSION);
+    ssReply << vReply;
+    req->WriteHeader("Content-Type", "application/octet-stream");
+    req->WriteReply(HTTP_OK, ssReply.str());
+    return true;
+}
+
 static bool InitRPCAuthentication()
 {
     if (gArgs.GetArg("-rpcpassword", "") == "")
@@ -233,6 +355,8 @@ bool StartHTTPRPC()
         return false;
 
     RegisterHTTPHandler("/", true, HTTPReq_JSONRPC);
+    if (gArgs.GetBoolArg("-rpcbinary", DEFAULT_RPC_BINARY))
+        RegisterHTTPHandler("/binary", true, HTTPReq_BinaryRPC);
 #ifdef ENABLE_WALLET
     // ifdef can be removed once we switch to better endpoint support and API versioning
     RegisterHTTPHandler("/wallet/", false, HTTPReq_JSONRPC);
@@ -252,6 +376,7 @@ void StopHTTPRPC()
 {
     LogPrint(BCLog::RPC, "Stopping HTTP RPC server\n");
     UnregisterHTTPHandler("/", true);
+    UnregisterHTTPHandler("/binary", true);
     if (httpRPCTimerInterface) {
         RPCUnsetTimerInterface(httpRPCTimerInterface.get());
         httpRPCTimerInterface.reset();
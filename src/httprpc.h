@@ -8,6 +8,8 @@
 #include <string>
 #include <map>
 
+static const bool DEFAULT_RPC_BINARY = false;
+
 /** Start HTTP RPC subsystem.
  * Precondition; HTTP and RPC has been started.
  */
@@ -7,6 +7,7 @@
 #include <chainparamsbase.h>
 #include <compat.h>
 #include <deque>
+#include <set>
 #include <util.h>
 #include <utilstrencodings.h>
 #include <netbase.h>
@@ -21,7 +22,9 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <signal.h>
+#include <condition_variable>
 #include <future>
+#include <mutex>
 
 #include <event2/thread.h>
 #include <event2/buffer.h>
@@ -38,8 +41,14 @@
 #endif
 #endif
 
+#ifdef WIN32
+#include <io.h> // For dup
+#endif
+
 /** Maximum size of http request (request line + headers) */
 static const size_t MAX_HEADERS_SIZE = 8192;
+/** Number of request body bytes scanned for the JSON-RPC method name */
+static const size_t MAX_METHOD_PEEK_SIZE = 512;
 
 /** HTTP request work item */
 class HTTPWorkItem final : public HTTPClosure
@@ -120,6 +129,16 @@ public:
         running = false;
         cond.notify_all();
     }
+    /** Return the number of queued work items */
+    size_t Depth()
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        return queue.size();
+    }
+    size_t MaxDepth() const
+    {
+        return maxDepth;
+    }
 };
 
 struct HTTPPathHandler
@@ -144,6 +163,13 @@ struct evhttp* eventHTTP = nullptr;
 static std::vector<CSubNet> rpc_allow_subnets;
 //! Work queue for handling longer requests off the event loop thread
 static WorkQueue<HTTPClosure>* workQueue = nullptr;
+//! Separate work queue for expensive RPC methods, so they cannot starve cheap ones
+static WorkQueue<HTTPClosure>* workQueueHeavy = nullptr;
+//! RPC methods dispatched to workQueueHeavy
+static std::set<std::string> setHeavyMethods;
+//! Number of worker threads per work queue
+static int nWorkQueueThreads = 0;
+static int nWorkQueueHeavyThreads = 0;
 //! Handlers for (sub)paths
 std::vector<HTTPPathHandler> pathHandlers;
 //! Bound listening sockets
@@ -209,6 +235,49 @@ static std::string RequestMethodString(HTTPRequest::RequestMethod m)
     }
 }
 
+/** Peek at the JSON-RPC method name of a request without consuming its body.
+ * This is only used as a scheduling hint, so a cheap scan of the start of
+ * the body is sufficient; anything unusual is treated as a cheap call.
+ */
+static std::string PeekJSONRPCMethod(struct evhttp_request* req)
+{
+    struct evbuffer* buf = evhttp_request_get_input_buffer(req);
+    if (!buf)
+        return "";
+    size_t size = std::min(evbuffer_get_length(buf), MAX_METHOD_PEEK_SIZE);
+    const char* data = (const char*)evbuffer_pullup(buf, size);
+    if (!data)
+        return "";
+    std::string strBody(data, size);
+
+    size_t pos = strBody.find("\"method\"");
+    if (pos == std::string::npos)
+        return "";
+    pos = strBody.find_first_not_of(" \t\r\n:", pos + 8);
+    if (pos == std::string::npos || strBody[pos] != '"')
+        return "";
+    size_t end = strBody.find('"', pos + 1);
+    if (end == std::string::npos)
+        return "";
+    return strBody.substr(pos + 1, end - pos - 1);
+}
+
+/** Re-enable reading from the socket after a reply has been sent. This is the
+ * second part of the libevent workaround in http_request_cb.
+ */
+static void http_reenable_read(struct evhttp_request* req)
+{
+    if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
+        evhttp_connection* conn = evhttp_request_get_connection(req);
+        if (conn) {
+            bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+            if (bev) {
+                bufferevent_enable(bev, EV_READ | EV_WRITE);
+            }
+        }
+    }
+}
+
 /** HTTP request callback */
 static void http_request_cb(struct evhttp_request* req, void* arg)
 {
@@ -258,9 +327,12 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
 
     // Dispatch to worker thread
     if (i != iend) {
+        WorkQueue<HTTPClosure>* queue = workQueue;
+        if (workQueueHeavy && setHeavyMethods.count(PeekJSONRPCMethod(req)))
+            queue = workQueueHeavy;
         std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
-        assert(workQueue);
-        if (workQueue->Enqueue(item.get()))
+        assert(queue);
+        if (queue->Enqueue(item.get()))
             item.release(); /* if true, queue took ownership */
         else {
             LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
@@ -399,6 +471,17 @@ bool InitHTTPServer()
     LogPrintf("HTTP: creating work queue of depth %d\n", workQueueDepth);
 
     workQueue = new WorkQueue<HTTPClosure>(workQueueDepth);
+    if (gArgs.GetArg("-rpcheavythreads", DEFAULT_HTTP_HEAVY_THREADS) > 0) {
+        workQueueHeavy = new WorkQueue<HTTPClosure>(workQueueDepth);
+        if (gArgs.IsArgSet("-rpcheavymethod")) {
+            for (const std::string& strMethod : gArgs.GetArgs("-rpcheavymethod"))
+                setHeavyMethods.insert(strMethod);
+        } else {
+            for (const char* strMethod : DEFAULT_HTTP_HEAVY_METHODS)
+                setHeavyMethods.insert(strMethod);
+        }
+        LogPrint(BCLog::HTTP, "Dispatching %u RPC methods to the heavy work queue\n", setHeavyMethods.size());
+    }
     // transfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
@@ -435,6 +518,15 @@ bool StartHTTPServer()
     for (int i = 0; i < rpcThreads; i++) {
         g_thread_http_workers.emplace_back(HTTPWorkQueueRun, workQueue);
     }
+    nWorkQueueThreads = rpcThreads;
+    if (workQueueHeavy) {
+        int rpcHeavyThreads = std::max((long)gArgs.GetArg("-rpcheavythreads", DEFAULT_HTTP_HEAVY_THREADS), 1L);
+        LogPrintf("HTTP: starting %d heavy worker threads\n", rpcHeavyThreads);
+        for (int i = 0; i < rpcHeavyThreads; i++) {
+            g_thread_http_workers.emplace_back(HTTPWorkQueueRun, workQueueHeavy);
+        }
+        nWorkQueueHeavyThreads = rpcHeavyThreads;
+    }
     return true;
 }
 
@@ -451,6 +543,8 @@ void InterruptHTTPServer()
     }
     if (workQueue)
         workQueue->Interrupt();
+    if (workQueueHeavy)
+        workQueueHeavy->Interrupt();
 }
 
 void StopHTTPServer()
@@ -464,6 +558,10 @@ void StopHTTPServer()
         g_thread_http_workers.clear();
         delete workQueue;
         workQueue = nullptr;
+        delete workQueueHeavy;
+        workQueueHeavy = nullptr;
+        setHeavyMethods.clear();
+        nWorkQueueThreads = nWorkQueueHeavyThreads = 0;
     }
     if (eventBase) {
         LogPrint(BCLog::HTTP, "Waiting for HTTP event thread to exit\n");
@@ -497,6 +595,16 @@ struct event_base* EventBase()
     return eventBase;
 }
 
+std::vector<HTTPWorkQueueInfo> GetHTTPWorkQueueInfo()
+{
+    std::vector<HTTPWorkQueueInfo> vInfo;
+    if (workQueue)
+        vInfo.push_back({"default", workQueue->Depth(), workQueue->MaxDepth(), nWorkQueueThreads});
+    if (workQueueHeavy)
+        vInfo.push_back({"heavy", workQueueHeavy->Depth(), workQueueHeavy->MaxDepth(), nWorkQueueHeavyThreads});
+    return vInfo;
+}
+
 static void httpevent_callback_fn(evutil_socket_t, short, void* data)
 {
     // Static handler: simply call inner handler
@@ -524,12 +632,19 @@ void HTTPEvent::trigger(struct timeval* tv)
         evtimer_add(ev, tv); // trigger after timeval passed
 }
 HTTPRequest::HTTPRequest(struct evhttp_request* _req) : req(_req),
-                                                       replySent(false)
+                                                       replySent(false),
+                                                       replyChunked(false),
+                                                       nTimeReceived(GetTimeMicros())
 {
 }
 HTTPRequest::~HTTPRequest()
 {
-    if (!replySent) {
+    if (replyChunked && !replySent) {
+        // Ending the chunked reply normally would pass a truncated body off as
+        // complete, so drop the connection instead
+        LogPrintf("%s: Unfinished chunked reply\n", __func__);
+        AbortReplyChunked();
+    } else if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
         WriteReply(HTTP_INTERNAL, "Unhandled request");
@@ -590,17 +705,189 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
     auto req_copy = req;
     HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus]{
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
-        // Re-enable reading from the socket. This is the second part of the libevent
-        // workaround above.
-        if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
-            evhttp_connection* conn = evhttp_request_get_connection(req_copy);
-            if (conn) {
-                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
-                if (bev) {
-                    bufferevent_enable(bev, EV_READ | EV_WRITE);
-                }
+        http_reenable_read(req_copy);
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+    req = nullptr; // transferred back to main thread
+}
+
+bool HTTPRequest::AddReplyFiles(const std::vector<std::pair<FILE*, int64_t>>& vFile)
+{
+    assert(!replySent && !replyChunked && req);
+    // Collect the ranges in a separate buffer so nothing is queued on failure
+    struct evbuffer* evbFiles = evbuffer_new();
+    assert(evbFiles);
+    bool fSuccess = true;
+    for (const auto& file : vFile) {
+        long nOffset = fSuccess ? ftell(file.first) : -1;
+        int fd = nOffset < 0 ? -1 : dup(fileno(file.first));
+        fclose(file.first);
+        if (fd < 0) {
+            fSuccess = false;
+            continue;
+        }
+        // On success libevent owns fd, and sends the range with sendfile or
+        // mmap where the platform supports it
+        if (evbuffer_add_file(evbFiles, fd, nOffset, file.second) != 0) {
+            close(fd);
+            fSuccess = false;
+        }
+    }
+    if (fSuccess) {
+        struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+        assert(evb);
+        evbuffer_add_buffer(evb, evbFiles);
+    }
+    evbuffer_free(evbFiles);
+    return fSuccess;
+}
+
+/** Shared between a worker thread writing a chunked reply and the main http
+ * thread sending it. Only the main http thread touches the request, and it
+ * stops doing so once the connection is closed.
+ */
+struct HTTPChunkedReplyState
+{
+    std::mutex cs;
+    std::condition_variable cond;
+    //! Bytes handed to the main http thread and not yet written to the socket
+    size_t nPending{0};
+    //! The connection was closed and the request freed by libevent
+    bool fClosed{false};
+    //! Output buffer of the connection, while the drain callback is registered
+    struct evbuffer* evbOutput{nullptr};
+    struct evbuffer_cb_entry* cbEntry{nullptr};
+};
+
+/** Called in the main http thread as the connection's output buffer drains */
+static void http_chunked_drain_cb(struct evbuffer* buffer, const struct evbuffer_cb_info* info, void* arg)
+{
+    if (info->n_deleted == 0)
+        return;
+    HTTPChunkedReplyState* state = static_cast<HTTPChunkedReplyState*>(arg);
+    std::lock_guard<std::mutex> lock(state->cs);
+    state->nPending -= std::min(state->nPending, info->n_deleted);
+    state->cond.notify_all();
+}
+
+/** Called in the main http thread when the connection of a chunked reply closes */
+static void http_chunked_close_cb(struct evhttp_connection* evcon, void* arg)
+{
+    HTTPChunkedReplyState* state = static_cast<HTTPChunkedReplyState*>(arg);
+    std::lock_guard<std::mutex> lock(state->cs);
+    state->fClosed = true;
+    state->evbOutput = nullptr;
+    state->cbEntry = nullptr;
+    state->cond.notify_all();
+}
+
+/** Unregister the callbacks of a chunked reply from its connection */
+static void http_chunked_release(struct evhttp_request* req, HTTPChunkedReplyState* state)
+{
+    std::lock_guard<std::mutex> lock(state->cs);
+    if (state->cbEntry)
+        evbuffer_remove_cb_entry(state->evbOutput, state->cbEntry);
+    state->evbOutput = nullptr;
+    state->cbEntry = nullptr;
+    evhttp_connection* evcon = evhttp_request_get_connection(req);
+    if (evcon)
+        evhttp_connection_set_closecb(evcon, nullptr, nullptr);
+}
+
+/** The chunked reply functions follow the same pattern as WriteReply: all
+ * libevent calls on the request happen in the main http thread. Events
+ * triggered from one thread are run in order, so chunks cannot be reordered.
+ */
+void HTTPRequest::StartReplyChunked(int nStatus)
+{
+    assert(!replySent && !replyChunked && req);
+    chunkState = std::make_shared<HTTPChunkedReplyState>();
+    auto req_copy = req;
+    auto state = chunkState;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, state, nStatus]{
+        evhttp_connection* evcon = evhttp_request_get_connection(req_copy);
+        if (evcon) {
+            evhttp_connection_set_closecb(evcon, http_chunked_close_cb, state.get());
+            bufferevent* bev = evhttp_connection_get_bufferevent(evcon);
+            if (bev) {
+                std::lock_guard<std::mutex> lock(state->cs);
+                state->evbOutput = bufferevent_get_output(bev);
+                state->cbEntry = evbuffer_add_cb(state->evbOutput, http_chunked_drain_cb, state.get());
             }
         }
+        evhttp_send_reply_start(req_copy, nStatus, nullptr);
+    });
+    ev->trigger(nullptr);
+    replyChunked = true;
+}
+
+bool HTTPRequest::WriteReplyChunk(const std::string& strChunk)
+{
+    assert(!replySent && replyChunked && req);
+    if (strChunk.empty())
+        return true; // an empty chunk would terminate the reply
+    {
+        // Wait for the client to read what was sent so far. A client that
+        // stops reading for the server timeout is given up on.
+        std::unique_lock<std::mutex> lock(chunkState->cs);
+        const int64_t nTimeout = gArgs.GetArg("-rpcservertimeout", DEFAULT_HTTP_SERVER_TIMEOUT);
+        while (!chunkState->fClosed && chunkState->nPending > HTTP_CHUNKED_REPLY_MAX_PENDING) {
+            const size_t nPendingBefore = chunkState->nPending;
+            if (chunkState->cond.wait_for(lock, std::chrono::seconds(nTimeout)) == std::cv_status::timeout &&
+                chunkState->nPending == nPendingBefore && !chunkState->fClosed) {
+                LogPrint(BCLog::HTTP, "%s: Client stopped reading, giving up on the reply\n", __func__);
+                return false;
+            }
+        }
+        if (chunkState->fClosed)
+            return false;
+        chunkState->nPending += strChunk.size();
+    }
+    struct evbuffer* evb = evbuffer_new();
+    assert(evb);
+    evbuffer_add(evb, strChunk.data(), strChunk.size());
+    auto req_copy = req;
+    auto state = chunkState;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, state, evb]{
+        if (!state->fClosed)
+            evhttp_send_reply_chunk(req_copy, evb);
+        evbuffer_free(evb);
+    });
+    ev->trigger(nullptr);
+    return true;
+}
+
+void HTTPRequest::EndReplyChunked()
+{
+    assert(!replySent && replyChunked && req);
+    auto req_copy = req;
+    auto state = chunkState;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, state]{
+        if (state->fClosed)
+            return;
+        http_chunked_release(req_copy, state.get());
+        evhttp_send_reply_end(req_copy);
+        http_reenable_read(req_copy);
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+    req = nullptr; // transferred back to main thread
+}
+
+void HTTPRequest::AbortReplyChunked()
+{
+    assert(!replySent && replyChunked && req);
+    auto req_copy = req;
+    auto state = chunkState;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, state]{
+        if (state->fClosed)
+            return;
+        http_chunked_release(req_copy, state.get());
+        // Frees the request along with the connection
+        evhttp_connection* evcon = evhttp_request_get_connection(req_copy);
+        if (evcon)
+            evhttp_connection_free(evcon);
     });
     ev->trigger(nullptr);
     replySent = true;
@@ -621,6 +908,11 @@ CService HTTPRequest::GetPeer()
     return peer;
 }
 
+int64_t HTTPRequest::GetTimeReceived() const
+{
+    return nTimeReceived;
+}
+
 std::string HTTPRequest::GetURI()
 {
     return evhttp_request_get_uri(req);
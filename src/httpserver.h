@@ -7,11 +7,22 @@
 
 #include <string>
 #include <stdint.h>
+#include <stdio.h>
 #include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
 
 static const int DEFAULT_HTTP_THREADS=4;
+static const int DEFAULT_HTTP_HEAVY_THREADS=1;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
+/** Bytes of a chunked reply that may wait to be sent before WriteReplyChunk blocks */
+static const size_t HTTP_CHUNKED_REPLY_MAX_PENDING = 1024 * 1024;
+/** RPC methods served from the heavy work queue unless -rpcheavymethod is given */
+static const char* const DEFAULT_HTTP_HEAVY_METHODS[] = {
+    "getblock", "getrawmempool", "listsidechaindeposits", "listtransactions",
+};
 
 struct evhttp_request;
 struct event_base;
@@ -46,11 +57,25 @@ void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPR
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
+/** Load of one of the HTTP server's work queues */
+struct HTTPWorkQueueInfo
+{
+    std::string name;
+    size_t depth;
+    size_t maxDepth;
+    int threads;
+};
+
+/** Return the current load of every HTTP work queue */
+std::vector<HTTPWorkQueueInfo> GetHTTPWorkQueueInfo();
+
 /** Return evhttp event base. This can be used by submodules to
  * queue timers or custom events.
  */
 struct event_base* EventBase();
 
+struct HTTPChunkedReplyState;
+
 /** In-flight HTTP request.
  * Thin C++ wrapper around evhttp_request.
  */
@@ -59,6 +84,9 @@ class HTTPRequest
 private:
     struct evhttp_request* req;
     bool replySent;
+    bool replyChunked;
+    std::shared_ptr<HTTPChunkedReplyState> chunkState;
+    int64_t nTimeReceived;
 
 public:
     explicit HTTPRequest(struct evhttp_request* req);
@@ -84,6 +112,10 @@ public:
      */
     RequestMethod GetRequestMethod();
 
+    /** Get the time (in microseconds) the request was handed to us by libevent.
+     */
+    int64_t GetTimeReceived() const;
+
     /**
      * Get the request header specified by hdr, or an empty string.
      * Return a pair (isPresent,string).
@@ -114,6 +146,47 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Append file ranges to the reply body without copying them into memory.
+     * Each range is given as a file positioned at its start and its length.
+     * Takes ownership of the files. Call WriteReply afterwards to send the
+     * reply.
+     *
+     * @note On failure nothing is appended.
+     */
+    bool AddReplyFiles(const std::vector<std::pair<FILE*, int64_t>>& vFile);
+
+    /**
+     * Start a chunked HTTP reply, to be continued with WriteReplyChunk and
+     * finished with EndReplyChunked. Use this instead of WriteReply for large
+     * bodies that are produced piecewise, so they never have to be held in
+     * memory as a whole.
+     *
+     * @note call WriteHeader before this, and do not call WriteReply.
+     */
+    void StartReplyChunked(int nStatus);
+
+    /**
+     * Queue one chunk of a reply started with StartReplyChunked. Blocks while
+     * more than HTTP_CHUNKED_REPLY_MAX_PENDING bytes wait to be sent.
+     * Returns false if the client went away or stopped reading, in which case
+     * the reply should be abandoned: destroying the request then closes the
+     * connection instead of finishing the reply.
+     */
+    bool WriteReplyChunk(const std::string& strChunk);
+
+    /**
+     * Finish a chunked reply.
+     *
+     * @note As with WriteReply, the request is given back to the main thread,
+     * so do not call any other HTTPRequest methods after calling this.
+     */
+    void EndReplyChunked();
+
+private:
+    /** Drop the connection of an unfinished chunked reply. */
+    void AbortReplyChunked();
 };
 
 /** Event handler closure.
@@ -11,6 +11,8 @@
 
 #include "addrman.h"
 #include "amount.h"
+#include "blockcache.h"
+#include "blockwriter.h"
 #include "chain.h"
 #include "chainparams.h"
 #include "checkpoints.h"
@@ -258,6 +260,7 @@ void Shutdown()
         psidechaintree.reset();
         popreturndb.reset();
     }
+    blockFileWriter.Stop();
 #ifdef ENABLE_WALLET
     StopWallets();
 #endif
@@ -343,9 +346,11 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-alertnotify=<cmd>", _("Execute command when a relevant alert is received or we see a really long fork (%s in cmd is replaced by message)"));
     strUsage +=HelpMessageOpt("-assumevalid=<hex>", strprintf(_("If this block is in the chain assume that it and its ancestors are valid and potentially skip their script verification (0 to verify all, default: %s, testnet: %s)"), defaultChainParams->GetConsensus().defaultAssumeValid.GetHex(), testnetChainParams->GetConsensus().defaultAssumeValid.GetHex()));
     strUsage += HelpMessageOpt("-blocknotify=<cmd>", _("Execute command when the best block changes (%s in cmd is replaced by block hash)"));
+    strUsage += HelpMessageOpt("-blockreadcache=<n>", strprintf(_("Set the size of the cache of recently read blocks in megabytes (0 to disable, default: %d)"), DEFAULT_BLOCK_READ_CACHE));
     strUsage += HelpMessageOpt("-blockreconstructionextratxn=<n>", strprintf(_("Extra transactions to keep in memory for compact block reconstructions (default: %u)"), DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN));
     if (showDebug)
         strUsage += HelpMessageOpt("-blocksonly", strprintf(_("Whether to operate in a blocks only mode (default: %u)"), DEFAULT_BLOCKSONLY));
+    strUsage += HelpMessageOpt("-blockwritebuffer=<n>", strprintf(_("Write new blocks to disk in the background, buffering up to <n> megabytes of them (0 to write immediately, default: %d)"), DEFAULT_BLOCK_WRITE_BUFFER));
     strUsage += HelpMessageOpt("-conf=<file>", strprintf(_("Specify configuration file. Relative paths will be prefixed by datadir location. (default: %s)"), BITCOIN_CONF_FILENAME));
     if (mode == HMM_BITCOIND)
     {
@@ -358,10 +363,16 @@ std::string HelpMessage(HelpMessageMode mode)
         strUsage += HelpMessageOpt("-dbbatchsize", strprintf("Maximum database write batch size in bytes (default: %u)", nDefaultDbBatchSize));
     }
     strUsage += HelpMessageOpt("-dbcache=<n>", strprintf(_("Set database cache size in megabytes (%d to %d, default: %d)"), nMinDbCache, nMaxDbCache, nDefaultDbCache));
+    strUsage += HelpMessageOpt("-dbprofile=<db>:<option>=<n>", _("Tune the LevelDB options of one database (chainstate, index, sidechain or opreturn). Options are bloombits, "
+        "maxopenfiles and blocksize. Can be specified multiple times"));
     strUsage += HelpMessageOpt("-debuglogfile=<file>", strprintf(_("Specify location of debug log file. Relative paths will be prefixed by a net-specific datadir location. (default: %s)"), DEFAULT_DEBUGLOGFILE));
     if (showDebug)
         strUsage += HelpMessageOpt("-feefilter", strprintf("Tell other nodes to filter invs to us by our mempool min fee (default: %u)", DEFAULT_FEEFILTER));
     strUsage += HelpMessageOpt("-loadblock=<file>", _("Imports blocks from external blk000??.dat file on startup"));
+    strUsage += HelpMessageOpt("-loadtxoutset=<file>", _("When the chainstate is empty, start from the snapshot in <file> written by dumptxoutset, if it matches -loadtxoutsethash. "
+        "Blocks below the snapshot are never downloaded or validated, and are not in the OP_RETURN index. Requires -prune"));
+    strUsage += HelpMessageOpt("-loadtxoutsethash=<hash>", _("Snapshot hash that -loadtxoutset must match, as reported by dumptxoutset on a node you trust. "
+        "The hashes inside a snapshot only detect a damaged file, so the node trusts whatever state this hash commits to"));
     strUsage += HelpMessageOpt("-maxmempool=<n>", strprintf(_("Keep the transaction memory pool below <n> megabytes (default: %u)"), DEFAULT_MAX_MEMPOOL_SIZE));
     strUsage += HelpMessageOpt("-maxorphantx=<n>", strprintf(_("Keep at most <n> unconnectable transactions in memory (default: %u)"), DEFAULT_MAX_ORPHAN_TRANSACTIONS));
     strUsage += HelpMessageOpt("-mempoolexpiry=<n>", strprintf(_("Do not keep transactions in the mempool longer than <n> hours (default: %u)"), DEFAULT_MEMPOOL_EXPIRY));
@@ -509,8 +520,11 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-rest", strprintf(_("Accept public REST requests (default: %u)"), DEFAULT_REST_ENABLE));
     strUsage += HelpMessageOpt("-rpcallowip=<ip>", _("Allow JSON-RPC connections from specified source. Valid for <ip> are a single IP (e.g. 1.2.3.4), a network/netmask (e.g. 1.2.3.4/255.255.255.0) or a network/CIDR (e.g. 1.2.3.4/24). This option can be specified multiple times"));
     strUsage += HelpMessageOpt("-rpcauth=<userpw>", _("Username and hashed password for JSON-RPC connections. The field <userpw> comes in the format: <USERNAME>:<SALT>$<HASH>. A canonical python script is included in share/rpcuser. The client then connects normally using the rpcuser=<USERNAME>/rpcpassword=<PASSWORD> pair of arguments. This option can be specified multiple times"));
+    strUsage += HelpMessageOpt("-rpcbinary", strprintf(_("Accept binary batch RPC requests on the /binary endpoint of the RPC port (default: %u)"), DEFAULT_RPC_BINARY));
     strUsage += HelpMessageOpt("-rpcbind=<addr>[:port]", _("Bind to given address to listen for JSON-RPC connections. This option is ignored unless -rpcallowip is also passed. Port is optional and overrides -rpcport. Use [host]:port notation for IPv6. This option can be specified multiple times (default: 127.0.0.1 and ::1 i.e., localhost, or if -rpcallowip has been specified, 0.0.0.0 and :: i.e., all addresses)"));
     strUsage += HelpMessageOpt("-rpccookiefile=<loc>", _("Location of the auth cookie. Relative paths will be prefixed by a net-specific datadir location. (default: data dir)"));
+    strUsage += HelpMessageOpt("-rpcheavymethod=<method>", _("Serve RPC method <method> from the separate heavy work queue. This option can be specified multiple times (default: getblock, getrawmempool, listsidechaindeposits and listtransactions)"));
+    strUsage += HelpMessageOpt("-rpcheavythreads=<n>", strprintf(_("Set the number of threads to service heavy RPC calls, 0 to serve them from the shared work queue (default: %d)"), DEFAULT_HTTP_HEAVY_THREADS));
     strUsage += HelpMessageOpt("-rpcpassword=<pw>", _("Password for JSON-RPC connections"));
     strUsage += HelpMessageOpt("-rpcport=<port>", strprintf(_("Listen for JSON-RPC connections on <port> (default: %u or testnet: %u)"), defaultBaseParams->RPCPort(), testnetBaseParams->RPCPort()));
     strUsage += HelpMessageOpt("-rpcserialversion", strprintf(_("Sets the serialization of raw transaction or block hex returned in non-verbose mode, non-segwit(0) or segwit(1) (default: %d)"), DEFAULT_RPC_SERIALIZE_VERSION));
@@ -916,6 +930,13 @@ bool AppInitParameterInteraction()
     if (gArgs.GetArg("-prune", 0)) {
         if (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX))
             return InitError(_("Prune mode is incompatible with -txindex."));
+    } else if (gArgs.IsArgSet("-loadtxoutset")) {
+        return InitError(_("-loadtxoutset requires -prune."));
+    }
+    if (gArgs.IsArgSet("-loadtxoutset")) {
+        const std::string strHash = gArgs.GetArg("-loadtxoutsethash", "");
+        if (strHash.size() != 64 || !IsHex(strHash))
+            return InitError(_("-loadtxoutset requires -loadtxoutsethash=<hash>."));
     }
 
     // -bind and -whitebind can't be set when not listening
@@ -1014,6 +1035,13 @@ bool AppInitParameterInteraction()
         LogPrintf("Warning: nMinimumChainWork set below default value of %s\n", chainparams.GetConsensus().nMinimumChainWork.GetHex());
     }
 
+    for (const std::string& strArg : gArgs.GetArgs("-dbprofile")) {
+        std::string strName, strOption;
+        int nValue;
+        if (!ParseDBProfileArg(strArg, strName, strOption, nValue))
+            return InitError(strprintf(_("Invalid -dbprofile argument: '%s'"), strArg));
+    }
+
     // mempool limits
     int64_t nMempoolSizeMax = gArgs.GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000;
     int64_t nMempoolSizeMin = gArgs.GetArg("-limitdescendantsize", DEFAULT_DESCENDANT_SIZE_LIMIT) * 1000 * 40;
@@ -1431,6 +1459,15 @@ bool AppInitMain()
     LogPrintf("* Using %.1fMiB for block index database\n", nBlockTreeDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for chain state database\n", nCoinDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for in-memory UTXO set (plus up to %.1fMiB of unused mempool space)\n", nCoinCacheUsage * (1.0 / 1024 / 1024), nMempoolSizeMax * (1.0 / 1024 / 1024));
+    int64_t nBlockReadCache = std::max<int64_t>(0, gArgs.GetArg("-blockreadcache", DEFAULT_BLOCK_READ_CACHE)) << 20;
+    blockReadCache.SetMaxSize(nBlockReadCache);
+    LogPrintf("* Using %.1fMiB for recently read blocks\n", nBlockReadCache * (1.0 / 1024 / 1024));
+    int64_t nBlockWriteBuffer = std::max<int64_t>(0, gArgs.GetArg("-blockwritebuffer", DEFAULT_BLOCK_WRITE_BUFFER)) << 20;
+    if (nBlockWriteBuffer > 0) {
+        blockFileWriter.SetMaxPending(nBlockWriteBuffer);
+        blockFileWriter.Start();
+        LogPrintf("* Using %.1fMiB for blocks waiting to be written\n", nBlockWriteBuffer * (1.0 / 1024 / 1024));
+    }
 
     bool fLoaded = false;
     bool drivechainsEnabled = false;
@@ -1664,6 +1701,24 @@ bool AppInitMain()
         LogPrintf(" block index %15dms\n", GetTimeMillis() - nStart);
     }
 
+    if (gArgs.IsArgSet("-loadtxoutset")) {
+        bool fEmpty;
+        {
+            LOCK(cs_main);
+            fEmpty = chainActive.Height() == 0;
+        }
+        if (fEmpty) {
+            fs::path pathSnapshot = gArgs.GetArg("-loadtxoutset", "");
+            uiInterface.InitMessage(_("Loading chainstate snapshot..."));
+            if (!LoadChainstateSnapshot(pathSnapshot, uint256S(gArgs.GetArg("-loadtxoutsethash", "")), chainparams))
+                return InitError(strprintf(_("Unable to load chainstate snapshot from %s"), pathSnapshot.string()));
+            LOCK(cs_main);
+            drivechainsEnabled = IsDrivechainEnabled(chainActive.Tip(), chainparams.GetConsensus());
+        } else {
+            LogPrintf("Chainstate is not empty, ignoring -loadtxoutset\n");
+        }
+    }
+
     fs::path est_path = GetDataDir() / FEE_ESTIMATES_FILENAME;
     CAutoFile est_filein(fsbridge::fopen(est_path, "rb"), SER_DISK, CLIENT_VERSION);
     // Allowed to fail as this file IS missing on first startup.
@@ -547,73 +547,12 @@ bool BlockAssembler::CreateWithdrawalPayout(uint8_t nSidechain, CMutableTransact
     if (scoreBest < SIDECHAIN_WITHDRAWAL_MIN_WORKSCORE)
         return false;
 
-    // Copy outputs from withdrawal tx
-    std::vector<std::pair<uint8_t, CMutableTransaction>> vTx = scdb.GetWithdrawalTxCache();
-    for (const std::pair<uint8_t, CMutableTransaction>& pair : vTx) {
-        if (pair.second.GetHash() == hashBest) {
-            for (const CTxOut& out : pair.second.vout)
-                mtx.vout.push_back(out);
-            break;
-        }
-    }
-    // Withdrawal should have at least the encoded dest output, encoded fee output,
-    // and change return output.
-    if (mtx.vout.size() < 3)
-        return false;
-
-    // Get the mainchain fee amount from the second Withdrawal output which encodes the
-    // sum of withdrawal fees.
-    CAmount amountRead = 0;
-    if (!DecodeWithdrawalFees(mtx.vout[1].scriptPubKey, amountRead)) {
-        LogPrintf("%s: Failed to decode withdrawal fees!\n", __func__);
+    // Build the payout from the cached withdrawal, spending the CTIP
+    if (!scdb.GetWithdrawalPayout(nSidechain, hashBest, mtx, nFees))
         return false;
-    }
-    nFees = amountRead;
-
-    // Calculate the amount to be withdrawn by Withdrawal
-    CAmount amountWithdrawn = CAmount(0);
-    for (const CTxOut& out : mtx.vout) {
-        uint8_t nSidechain;
-        if (!out.scriptPubKey.IsDrivechain(nSidechain))
-            amountWithdrawn += out.nValue;
-    }
-
-    // Add mainchain fees from withdrawal
-    amountWithdrawn += nFees;
-
-    // Get sidechain change return script. We will pay the sidechain the change
-    // left over from this Withdrawal. This Withdrawal transaction will look like a normal
-    // sidechain deposit but with more outputs and the destination string will
-    // be SIDECHAIN_WITHDRAWAL_RETURN_DEST.
-    CScript sidechainScript;
-    if (!scdb.GetSidechainScript(nSidechain, sidechainScript))
-        return false;
-
-    // Note: Withdrawal change return must be the final output
-    // Add placeholder change return as the final output.
-    mtx.vout.push_back(CTxOut(0, sidechainScript));
-
-    // Get sidechain's CTIP
-    SidechainCTIP ctip;
-    if (!scdb.GetCTIP(nSidechain, ctip))
-        return false;
-
-    mtx.vin.push_back(CTxIn(ctip.out));
 
     LogPrintf("%s: Withdrawal will spend CTIP: %s : %u.\n", __func__,
-            ctip.out.hash.ToString(), ctip.out.n);
-
-    // Start calculating amount returning to sidechain
-    CAmount returnAmount = ctip.amount;
-    mtx.vout.back().nValue += returnAmount;
-
-    // Subtract payout amount from sidechain change return
-    mtx.vout.back().nValue -= amountWithdrawn;
-
-    if (mtx.vout.back().nValue < 0)
-        return false;
-    if (!mtx.vin.size())
-        return false;
+            mtx.vin[0].prevout.hash.ToString(), mtx.vin[0].prevout.n);
 
     // Check to make sure that all of the outputs in this Withdrawal are unknown / new
     for (size_t o = 0; o < mtx.vout.size(); o++) {
@@ -798,8 +737,13 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
 
         ++nPackagesSelected;
 
-        // Update transactions that depend on each of these
-        nDescendantsUpdated += UpdatePackagesForAdded(ancestors, mapModifiedTx);
+        // Update transactions that depend on each of these, unless the
+        // package is its whole cluster and nothing else depends on it
+        uint64_t nClusterCount, nClusterSize;
+        CAmount nClusterFees;
+        mempool.GetClusterStats(iter, nClusterCount, nClusterSize, nClusterFees);
+        if (nClusterCount > ancestors.size())
+            nDescendantsUpdated += UpdatePackagesForAdded(ancestors, mapModifiedTx);
     }
 }
 
@@ -895,11 +839,17 @@ void static BitcoinMiner(const CChainParams& chainparams)
 
     unsigned int nExtraNonce = 0;
 
+#ifndef ENABLE_WALLET
+    return;
+#else
     if (vpwallets.empty())
         return; // TODO error message
+#endif
 
     std::shared_ptr<CReserveScript> coinbaseScript;
+#ifdef ENABLE_WALLET
     vpwallets[0]->GetScriptForMining(coinbaseScript);
+#endif
 
     bool fBreakForBMM = gArgs.GetBoolArg("-minerbreakforbmm", false);
     int nBMMBreakAttempts = 0;
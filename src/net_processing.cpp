@@ -23,6 +23,7 @@
 #include <random.h>
 #include <reverse_iterator.h>
 #include <scheduler.h>
+#include <sidechaindb.h>
 #include <tinyformat.h>
 #include <txmempool.h>
 #include <ui_interface.h>
@@ -59,6 +60,13 @@ void EraseOrphansFor(NodeId peer);
 static size_t vExtraTxnForCompactIt GUARDED_BY(g_cs_orphans) = 0;
 static std::vector<std::pair<uint256, CTransactionRef>> vExtraTxnForCompact GUARDED_BY(g_cs_orphans);
 
+/** Compact block reconstruction counters, see CompactBlockStats */
+static std::atomic<uint64_t> nCompactBlocksReceived(0);
+static std::atomic<uint64_t> nCompactBlocksReconstructed(0);
+static std::atomic<uint64_t> nCompactBlockRoundTrips(0);
+static std::atomic<uint64_t> nCompactBlockTxRequested(0);
+static std::atomic<uint64_t> nCompactBlockTxFromExtra(0);
+
 static const uint64_t RANDOMIZER_ID_ADDRESS_RELAY = 0x3cac0035b5866b90ULL; // SHA256("main address relay")[0:8]
 
 /// Age after which a stale block will no longer be served if requested as
@@ -112,6 +120,7 @@ namespace {
         const CBlockIndex* pindex;                               //!< Optional.
         bool fValidatedHeaders;                                  //!< Whether this block has validated headers at the time of request.
         std::unique_ptr<PartiallyDownloadedBlock> partialBlock;  //!< Optional, used for CMPCTBLOCK downloads
+        int64_t nTimeRequested;                                  //!< When the block was requested (in microseconds).
     };
     std::map<uint256, std::pair<NodeId, std::list<QueuedBlock>::iterator> > mapBlocksInFlight;
 
@@ -185,6 +194,16 @@ struct CNodeState {
     int64_t nDownloadingSince;
     int nBlocksInFlight;
     int nBlocksInFlightValidHeaders;
+    //! Number of blocks we requested that this peer delivered.
+    int nBlocksDelivered;
+    //! When this peer last delivered a block we requested (in microseconds).
+    int64_t nLastBlockDelivery;
+    //! Moving average of the time from requesting a block to receiving it (in microseconds).
+    int64_t nBlockLatency;
+    //! Moving average of the time between blocks received while more were requested (in microseconds).
+    int64_t nBlockInterval;
+    //! Whether blocks were taken away from this peer since it last delivered one.
+    bool fBlocksReassigned;
     //! Whether we consider this a preferred download peer.
     bool fPreferredDownload;
     //! Whether this peer wants invs or headers (when possible) for block announcements.
@@ -254,6 +273,11 @@ struct CNodeState {
         nDownloadingSince = 0;
         nBlocksInFlight = 0;
         nBlocksInFlightValidHeaders = 0;
+        nBlocksDelivered = 0;
+        nLastBlockDelivery = 0;
+        nBlockLatency = 0;
+        nBlockInterval = 0;
+        fBlocksReassigned = false;
         fPreferredDownload = false;
         fPreferHeaders = false;
         fPreferHeaderAndIDs = false;
@@ -335,6 +359,30 @@ bool MarkBlockAsReceived(const uint256& hash) {
     return false;
 }
 
+// Requires cs_main.
+// Take a block away from the peer it is in flight from, so it can be requested
+// from a faster one. Unlike MarkBlockAsReceived this leaves the old peer's
+// download and stalling timers running, and counts the time the block spent in
+// flight against the peer's rate.
+void MarkBlockAsReassigned(const uint256& hash) {
+    std::map<uint256, std::pair<NodeId, std::list<QueuedBlock>::iterator> >::iterator itInFlight = mapBlocksInFlight.find(hash);
+    if (itInFlight == mapBlocksInFlight.end())
+        return;
+    CNodeState *state = State(itInFlight->second.first);
+    assert(state != nullptr);
+    int64_t nInFlight = GetTimeMicros() - itInFlight->second.second->nTimeRequested;
+    state->nBlockLatency = (state->nBlockLatency * 7 + nInFlight) / 8;
+    state->nBlockInterval = (state->nBlockInterval * 7 + nInFlight) / 8;
+    state->fBlocksReassigned = true;
+    state->nBlocksInFlightValidHeaders -= itInFlight->second.second->fValidatedHeaders;
+    if (state->nBlocksInFlightValidHeaders == 0 && itInFlight->second.second->fValidatedHeaders) {
+        nPeersWithValidatedDownloads--;
+    }
+    state->vBlocksInFlight.erase(itInFlight->second.second);
+    state->nBlocksInFlight--;
+    mapBlocksInFlight.erase(itInFlight);
+}
+
 // Requires cs_main.
 // returns false, still setting pit, if the block was already in flight from the same peer
 // pit will only be valid as long as the same cs_main lock is being held
@@ -355,11 +403,12 @@ bool MarkBlockAsInFlight(NodeId nodeid, const uint256& hash, const CBlockIndex*
     MarkBlockAsReceived(hash);
 
     std::list<QueuedBlock>::iterator it = state->vBlocksInFlight.insert(state->vBlocksInFlight.end(),
-            {hash, pindex, pindex != nullptr, std::unique_ptr<PartiallyDownloadedBlock>(pit ? new PartiallyDownloadedBlock(&mempool) : nullptr)});
+            {hash, pindex, pindex != nullptr, std::unique_ptr<PartiallyDownloadedBlock>(pit ? new PartiallyDownloadedBlock(&mempool) : nullptr), GetTimeMicros()});
     state->nBlocksInFlight++;
     state->nBlocksInFlightValidHeaders += it->fValidatedHeaders;
-    if (state->nBlocksInFlight == 1) {
-        // We're starting a block download (batch) from this peer.
+    if (state->nBlocksInFlight == 1 && !state->fBlocksReassigned) {
+        // We're starting a block download (batch) from this peer. A peer that
+        // had blocks taken away keeps the deadline of its earlier batch.
         state->nDownloadingSince = GetTimeMicros();
     }
     if (state->nBlocksInFlightValidHeaders == 1 && pindex != nullptr) {
@@ -371,6 +420,55 @@ bool MarkBlockAsInFlight(NodeId nodeid, const uint256& hash, const CBlockIndex*
     return true;
 }
 
+// Requires cs_main.
+// Update the download rate of a peer that delivered a block we requested from it.
+void RecordBlockDelivery(NodeId nodeid, const uint256& hash) {
+    std::map<uint256, std::pair<NodeId, std::list<QueuedBlock>::iterator> >::iterator itInFlight = mapBlocksInFlight.find(hash);
+    if (itInFlight == mapBlocksInFlight.end() || itInFlight->second.first != nodeid)
+        return;
+    CNodeState *state = State(nodeid);
+    assert(state != nullptr);
+
+    int64_t nNow = GetTimeMicros();
+    int64_t nRequested = itInFlight->second.second->nTimeRequested;
+    int64_t nLatency = nNow - nRequested;
+    // A block queued behind others only gets the peer's attention once the
+    // previous one has been delivered
+    int64_t nInterval = nNow - std::max(nRequested, state->nLastBlockDelivery);
+    if (state->nBlocksDelivered == 0) {
+        state->nBlockLatency = nLatency;
+        state->nBlockInterval = nInterval;
+    } else {
+        state->nBlockLatency = (state->nBlockLatency * 7 + nLatency) / 8;
+        state->nBlockInterval = (state->nBlockInterval * 7 + nInterval) / 8;
+    }
+    state->nLastBlockDelivery = nNow;
+    state->nBlocksDelivered++;
+    state->fBlocksReassigned = false;
+}
+
+// Requires cs_main.
+// Number of blocks to keep requested from a peer: enough to cover
+// BLOCK_DOWNLOAD_QUEUE_TIME at the rate it has delivered blocks so far. A peer
+// that had blocks taken away only gets one at a time until it delivers again.
+int GetBlockDownloadWindow(const CNodeState* state) {
+    if (state->fBlocksReassigned)
+        return 1;
+    if (state->nBlocksDelivered < BLOCK_DOWNLOAD_MIN_SAMPLES)
+        return MAX_BLOCKS_IN_TRANSIT_PER_PEER;
+    int64_t nWindow = BLOCK_DOWNLOAD_QUEUE_TIME / std::max<int64_t>(state->nBlockInterval, 1);
+    return std::max<int64_t>(MIN_BLOCKS_IN_TRANSIT_PER_PEER, std::min<int64_t>(nWindow, MAX_ADAPTIVE_BLOCKS_IN_TRANSIT_PER_PEER));
+}
+
+// Requires cs_main.
+// Time a peer's measured rate predicts for delivering everything we have
+// requested from it, or 0 if its rate is not known yet.
+int64_t GetExpectedBlockDownloadTime(const CNodeState* state) {
+    if (state->nBlocksDelivered < BLOCK_DOWNLOAD_MIN_SAMPLES)
+        return 0;
+    return state->nBlockLatency + state->nBlockInterval * state->nBlocksInFlight;
+}
+
 /** Check whether the last unknown block a peer advertised is not yet known. */
 void ProcessBlockAvailability(NodeId nodeid) {
     CNodeState *state = State(nodeid);
@@ -500,6 +598,10 @@ void FindNextBlocksToDownload(NodeId nodeid, unsigned int count, std::vector<con
     int nWindowEnd = state->pindexLastCommonBlock->nHeight + BLOCK_DOWNLOAD_WINDOW;
     int nMaxHeight = std::min<int>(state->pindexBestKnownBlock->nHeight, nWindowEnd + 1);
     NodeId waitingfor = -1;
+    // Blocks in flight from a slower peer that are well past the time its rate
+    // predicts are requested from this peer instead, if it is expected to be faster
+    int64_t nNow = GetTimeMicros();
+    int64_t nExpected = GetExpectedBlockDownloadTime(state);
     while (pindexWalk->nHeight < nMaxHeight) {
         // Read up to 128 (or more, if more blocks than that are needed) successors of pindexWalk (towards
         // pindexBestKnownBlock) into vToFetch. We fetch 128, because CBlockIndex::GetAncestor may be as expensive
@@ -547,9 +649,25 @@ void FindNextBlocksToDownload(NodeId nodeid, unsigned int count, std::vector<con
                 if (vBlocks.size() == count) {
                     return;
                 }
-            } else if (waitingfor == -1) {
-                // This is the first already-in-flight block.
-                waitingfor = mapBlocksInFlight[pindex->GetBlockHash()].first;
+            } else {
+                const std::pair<NodeId, std::list<QueuedBlock>::iterator>& inFlight = mapBlocksInFlight[pindex->GetBlockHash()];
+                if (inFlight.first != nodeid && nExpected > 0 && pindex->nHeight <= nWindowEnd) {
+                    int64_t nExpectedOther = GetExpectedBlockDownloadTime(State(inFlight.first));
+                    int64_t nInFlight = nNow - inFlight.second->nTimeRequested;
+                    if (nExpectedOther > nExpected && nInFlight > BLOCK_REASSIGN_MIN_TIME && nInFlight > nExpectedOther * BLOCK_REASSIGN_FACTOR) {
+                        LogPrint(BCLog::NET, "Reassigning block %s (%d) from peer=%d to peer=%d\n", pindex->GetBlockHash().ToString(),
+                            pindex->nHeight, inFlight.first, nodeid);
+                        vBlocks.push_back(pindex);
+                        if (vBlocks.size() == count) {
+                            return;
+                        }
+                        continue;
+                    }
+                }
+                if (waitingfor == -1) {
+                    // This is the first already-in-flight block.
+                    waitingfor = inFlight.first;
+                }
             }
         }
     }
@@ -632,6 +750,9 @@ bool GetNodeStateStats(NodeId nodeid, CNodeStateStats &stats) {
         if (queue.pindex)
             stats.vHeightInFlight.push_back(queue.pindex->nHeight);
     }
+    stats.nBlockWindow = GetBlockDownloadWindow(state);
+    stats.nBlockLatency = state->nBlockLatency;
+    stats.nBlockInterval = state->nBlockInterval;
     return true;
 }
 
@@ -651,6 +772,41 @@ void AddToCompactExtraTransactions(const CTransactionRef& tx) EXCLUSIVE_LOCKS_RE
     vExtraTxnForCompactIt = (vExtraTxnForCompactIt + 1) % max_extra_txn;
 }
 
+/**
+ * Transactions besides the mempool to look at when reconstructing a compact
+ * block: orphans and replaced transactions, the withdrawal payouts SCDB can
+ * currently build and the BMM requests the mempool recently evicted. The
+ * payouts and BMM requests are never relayed, so without them every block
+ * that includes one costs a getblocktxn round trip.
+ */
+static std::vector<std::pair<uint256, CTransactionRef>> GetExtraTxnForCompact() EXCLUSIVE_LOCKS_REQUIRED(cs_main, g_cs_orphans)
+{
+    std::vector<std::pair<uint256, CTransactionRef>> vExtraTxn;
+    vExtraTxn.reserve(vExtraTxnForCompact.size());
+    for (const auto& extra : vExtraTxnForCompact) {
+        if (extra.second)
+            vExtraTxn.push_back(extra);
+    }
+    if (IsDrivechainEnabled(chainActive.Tip(), Params().GetConsensus())) {
+        for (const CTransactionRef& tx : scdb.GetWithdrawalPayoutCandidates())
+            vExtraTxn.emplace_back(tx->GetWitnessHash(), tx);
+        for (const CTransactionRef& tx : mempool.GetEvictedBMMRequests())
+            vExtraTxn.emplace_back(tx->GetWitnessHash(), tx);
+    }
+    return vExtraTxn;
+}
+
+CompactBlockStats GetCompactBlockStats()
+{
+    CompactBlockStats stats;
+    stats.nReceived = nCompactBlocksReceived;
+    stats.nReconstructed = nCompactBlocksReconstructed;
+    stats.nRoundTrips = nCompactBlockRoundTrips;
+    stats.nTxRequested = nCompactBlockTxRequested;
+    stats.nTxFromExtra = nCompactBlockTxFromExtra;
+    return stats;
+}
+
 bool AddOrphanTx(const CTransactionRef& tx, NodeId peer) EXCLUSIVE_LOCKS_REQUIRED(g_cs_orphans)
 {
     const uint256& hash = tx->GetHash();
@@ -1130,10 +1286,9 @@ void static ProcessGetBlockData(CNode* pfrom, const Consensus::Params& consensus
             pblock = a_recent_block;
         } else {
             // Send block from disk
-            std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
-            if (!ReadBlockFromDisk(*pblockRead, (*mi).second, consensusParams))
+            pblock = ReadBlockFromDiskCached((*mi).second, consensusParams);
+            if (!pblock)
                 assert(!"cannot load block from disk");
-            pblock = pblockRead;
         }
         if (inv.type == MSG_BLOCK) {
             connman->PushMessage(pfrom, msgMaker.Make(SERIALIZE_TRANSACTION_NO_WITNESS | SERIALIZE_TRANSACTION_NO_DRIVECHAIN, NetMsgType::BLOCK, *pblock));
@@ -2469,7 +2624,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 }
 
                 PartiallyDownloadedBlock& partialBlock = *(*queuedBlockIt)->partialBlock;
-                ReadStatus status = partialBlock.InitData(cmpctblock, vExtraTxnForCompact);
+                ReadStatus status = partialBlock.InitData(cmpctblock, GetExtraTxnForCompact());
                 if (status == READ_STATUS_INVALID) {
                     MarkBlockAsReceived(pindex->GetBlockHash()); // Reset in-flight state in case of whitelist
                     Misbehaving(pfrom->GetId(), 100, strprintf("Peer %d sent us invalid compact block\n", pfrom->GetId()));
@@ -2487,13 +2642,18 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                     if (!partialBlock.IsTxAvailable(i))
                         req.indexes.push_back(i);
                 }
+                nCompactBlocksReceived++;
+                nCompactBlockTxFromExtra += partialBlock.GetExtraCount();
                 if (req.indexes.empty()) {
+                    nCompactBlocksReconstructed++;
                     // Dirty hack to jump to BLOCKTXN code (TODO: move message handling into their own functions)
                     BlockTransactions txn;
                     txn.blockhash = cmpctblock.header.GetHash();
                     blockTxnMsg << txn;
                     fProcessBLOCKTXN = true;
                 } else {
+                    nCompactBlockRoundTrips++;
+                    nCompactBlockTxRequested += req.indexes.size();
                     req.blockhash = pindex->GetBlockHash();
                     connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::GETBLOCKTXN, req));
                 }
@@ -2504,7 +2664,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 // Optimistically try to reconstruct anyway since we might be
                 // able to without any round trips.
                 PartiallyDownloadedBlock tempBlock(&mempool);
-                ReadStatus status = tempBlock.InitData(cmpctblock, vExtraTxnForCompact);
+                ReadStatus status = tempBlock.InitData(cmpctblock, GetExtraTxnForCompact());
                 if (status != READ_STATUS_OK) {
                     // TODO: don't ignore failures
                     return true;
@@ -2624,6 +2784,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 // though the block was successfully read, and rely on the
                 // handling in ProcessNewBlock to ensure the block index is
                 // updated, reject messages go out, etc.
+                RecordBlockDelivery(pfrom->GetId(), resp.blockhash);
                 MarkBlockAsReceived(resp.blockhash); // it is now an empty pointer
                 fBlockRead = true;
                 // mapBlockSource is only used for sending reject messages and DoS scores,
@@ -2691,6 +2852,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
             LOCK(cs_main);
             // Also always process if we requested the block explicitly, as we may
             // need it even though it is not a candidate for a new best tip.
+            RecordBlockDelivery(pfrom->GetId(), hash);
             forceProcessing |= MarkBlockAsReceived(hash);
             // mapBlockSource is only used for sending reject messages and DoS scores,
             // so the race between here and cs_main in ProcessNewBlock is fine.
@@ -3674,13 +3836,19 @@ bool PeerLogicValidation::SendMessages(CNode* pto, std::atomic<bool>& interruptM
         // Message: getdata (blocks)
         //
         std::vector<CInv> vGetData;
-        if (!pto->fClient && (fFetch || !IsInitialBlockDownload()) && state.nBlocksInFlight < MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+        int nBlockWindow = GetBlockDownloadWindow(&state);
+        // During initial block download, only top up a peer's requests once half
+        // of them have arrived, so each peer is given a contiguous range of blocks
+        // and they end up close together on disk.
+        bool fTopUp = state.nBlocksInFlight == 0 || state.nBlocksInFlight <= nBlockWindow / 2 || !IsInitialBlockDownload();
+        if (!pto->fClient && (fFetch || !IsInitialBlockDownload()) && state.nBlocksInFlight < nBlockWindow && fTopUp) {
             std::vector<const CBlockIndex*> vToDownload;
             NodeId staller = -1;
-            FindNextBlocksToDownload(pto->GetId(), MAX_BLOCKS_IN_TRANSIT_PER_PEER - state.nBlocksInFlight, vToDownload, staller, consensusParams);
+            FindNextBlocksToDownload(pto->GetId(), nBlockWindow - state.nBlocksInFlight, vToDownload, staller, consensusParams);
             for (const CBlockIndex *pindex : vToDownload) {
                 uint32_t nFetchFlags = GetFetchFlags(pto);
                 vGetData.push_back(CInv(MSG_BLOCK | nFetchFlags, pindex->GetBlockHash()));
+                MarkBlockAsReassigned(pindex->GetBlockHash());
                 MarkBlockAsInFlight(pto->GetId(), pindex->GetBlockHash(), pindex);
                 LogPrint(BCLog::NET, "Requesting block %s (%d) peer=%d\n", pindex->GetBlockHash().ToString(),
                     pindex->nHeight, pto->GetId());
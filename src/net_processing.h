@@ -22,6 +22,20 @@ static const unsigned int DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN = 100;
  *  Timeout = base + per_header * (expected number of headers) */
 static constexpr int64_t HEADERS_DOWNLOAD_TIMEOUT_BASE = 15 * 60 * 1000000; // 15 minutes
 static constexpr int64_t HEADERS_DOWNLOAD_TIMEOUT_PER_HEADER = 1000; // 1ms/header
+/** Fewest blocks we keep requested from a slow peer */
+static constexpr int MIN_BLOCKS_IN_TRANSIT_PER_PEER = 2;
+/** Most blocks we keep requested from a fast peer */
+static constexpr int MAX_ADAPTIVE_BLOCKS_IN_TRANSIT_PER_PEER = 64;
+/** Blocks a peer must deliver before its measured rate sizes its window; until
+ *  then MAX_BLOCKS_IN_TRANSIT_PER_PEER is used */
+static constexpr int BLOCK_DOWNLOAD_MIN_SAMPLES = 4;
+/** How much download time (in microseconds) to keep queued at each peer */
+static constexpr int64_t BLOCK_DOWNLOAD_QUEUE_TIME = 2 * 1000000;
+/** A block is reassigned to a faster peer once it has been in flight this many
+ *  times longer than its peer's measured rate predicts... */
+static constexpr int BLOCK_REASSIGN_FACTOR = 4;
+/** ...and at least this long, in microseconds */
+static constexpr int64_t BLOCK_REASSIGN_MIN_TIME = 500000;
 /** Protect at least this many outbound peers from disconnection due to slow/
  * behind headers chain.
  */
@@ -74,8 +88,31 @@ struct CNodeStateStats {
     int nSyncHeight;
     int nCommonHeight;
     std::vector<int> vHeightInFlight;
+    //! Number of blocks we currently keep requested from this peer
+    int nBlockWindow;
+    //! Moving average of the time from requesting a block to receiving it, in microseconds
+    int64_t nBlockLatency;
+    //! Moving average of the time between two blocks received, in microseconds
+    int64_t nBlockInterval;
 };
 
+/** Compact block reconstruction statistics since startup */
+struct CompactBlockStats {
+    //! Compact blocks we requested or accepted for reconstruction
+    uint64_t nReceived;
+    //! Of those, blocks reconstructed without a getblocktxn round trip
+    uint64_t nReconstructed;
+    //! Number of getblocktxn requests sent for missing transactions
+    uint64_t nRoundTrips;
+    //! Number of transactions requested with getblocktxn
+    uint64_t nTxRequested;
+    //! Transactions found outside the mempool (orphans, replaced
+    //! transactions, withdrawal payouts and evicted BMM requests)
+    uint64_t nTxFromExtra;
+};
+
+CompactBlockStats GetCompactBlockStats();
+
 /** Get statistics from node state */
 bool GetNodeStateStats(NodeId nodeid, CNodeStateStats &stats);
 /** Increase a node's misbehavior score. */
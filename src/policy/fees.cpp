@@ -108,7 +108,16 @@ private:
     // transactions still unconfirmed after GetMaxConfirms for each bucket
     std::vector<int> oldUnconfTxs;
 
+    // Suffix sums of unconfTxs over confirmation counts, so that
+    // EstimateMedianVal can look up how many txs have been outstanding for
+    // at least confTarget blocks without walking the circular buffer.
+    // unconfSums[Y][X] is only valid at unconfSumsHeight
+    mutable std::vector<std::vector<int> > unconfSums;
+    mutable unsigned int unconfSumsHeight;
+    mutable bool fUnconfSumsValid;
+
     void resizeInMemoryCounters(size_t newbuckets);
+    void UpdateUnconfirmedSums(unsigned int nBlockHeight) const;
 
 public:
     /**
@@ -175,7 +184,7 @@ public:
 TxConfirmStats::TxConfirmStats(const std::vector<double>& defaultBuckets,
                                 const std::map<double, unsigned int>& defaultBucketMap,
                                unsigned int maxPeriods, double _decay, unsigned int _scale)
-    : buckets(defaultBuckets), bucketMap(defaultBucketMap)
+    : buckets(defaultBuckets), bucketMap(defaultBucketMap), unconfSumsHeight(0), fUnconfSumsValid(false)
 {
     decay = _decay;
     assert(_scale != 0 && "_scale must be non-zero");
@@ -202,6 +211,25 @@ void TxConfirmStats::resizeInMemoryCounters(size_t newbuckets) {
         unconfTxs[i].resize(newbuckets);
     }
     oldUnconfTxs.resize(newbuckets);
+    fUnconfSumsValid = false;
+}
+
+void TxConfirmStats::UpdateUnconfirmedSums(unsigned int nBlockHeight) const
+{
+    if (fUnconfSumsValid && unconfSumsHeight == nBlockHeight)
+        return;
+    unsigned int bins = unconfTxs.size();
+    unconfSums.resize(bins + 1);
+    unconfSums[bins].assign(oldUnconfTxs.size(), 0);
+    for (unsigned int confct = bins; confct-- > 0; ) {
+        const std::vector<int>& unconf = unconfTxs[(nBlockHeight - confct)%bins];
+        unconfSums[confct].resize(unconf.size());
+        for (unsigned int j = 0; j < unconf.size(); j++) {
+            unconfSums[confct][j] = unconfSums[confct + 1][j] + unconf[j];
+        }
+    }
+    unconfSumsHeight = nBlockHeight;
+    fUnconfSumsValid = true;
 }
 
 // Roll the unconfirmed txs circular buffer
@@ -211,6 +239,7 @@ void TxConfirmStats::ClearCurrent(unsigned int nBlockHeight)
         oldUnconfTxs[j] += unconfTxs[nBlockHeight%unconfTxs.size()][j];
         unconfTxs[nBlockHeight%unconfTxs.size()][j] = 0;
     }
+    fUnconfSumsValid = false;
 }
 
 
@@ -276,6 +305,8 @@ double TxConfirmStats::EstimateMedianVal(int confTarget, double sufficientTxVal,
     bool newBucketRange = true;
     bool passing = true;
     EstimatorBucket passBucket;
+    UpdateUnconfirmedSums(nBlockHeight);
+    const std::vector<int>& unconfOutstanding = unconfSums[std::min((unsigned int)confTarget, bins)];
     EstimatorBucket failBucket;
 
     // Start counting from highest(default) or lowest feerate transactions
@@ -288,8 +319,7 @@ double TxConfirmStats::EstimateMedianVal(int confTarget, double sufficientTxVal,
         nConf += confAvg[periodTarget - 1][bucket];
         totalNum += txCtAvg[bucket];
         failNum += failAvg[periodTarget - 1][bucket];
-        for (unsigned int confct = confTarget; confct < GetMaxConfirms(); confct++)
-            extraNum += unconfTxs[(nBlockHeight - confct)%bins][bucket];
+        extraNum += unconfOutstanding[bucket];
         extraNum += oldUnconfTxs[bucket];
         // If we have enough transaction data points in this range of buckets,
         // we can test for success
@@ -464,6 +494,7 @@ unsigned int TxConfirmStats::NewTx(unsigned int nBlockHeight, double val)
     unsigned int bucketindex = bucketMap.lower_bound(val)->second;
     unsigned int blockIndex = nBlockHeight % unconfTxs.size();
     unconfTxs[blockIndex][bucketindex]++;
+    fUnconfSumsValid = false;
     return bucketindex;
 }
 
@@ -477,6 +508,7 @@ void TxConfirmStats::removeTx(unsigned int entryHeight, unsigned int nBestSeenHe
         LogPrint(BCLog::ESTIMATEFEE, "Blockpolicy error, blocks ago is negative for mempool tx\n");
         return;  //This can't happen because we call this with our best seen height, no entries can have higher
     }
+    fUnconfSumsValid = false;
 
     if (blocksAgo >= (int)unconfTxs.size()) {
         if (oldUnconfTxs[bucketindex] > 0) {
@@ -540,6 +572,9 @@ CBlockPolicyEstimator::CBlockPolicyEstimator()
     feeStats = std::unique_ptr<TxConfirmStats>(new TxConfirmStats(buckets, bucketMap, MED_BLOCK_PERIODS, MED_DECAY, MED_SCALE));
     shortStats = std::unique_ptr<TxConfirmStats>(new TxConfirmStats(buckets, bucketMap, SHORT_BLOCK_PERIODS, SHORT_DECAY, SHORT_SCALE));
     longStats = std::unique_ptr<TxConfirmStats>(new TxConfirmStats(buckets, bucketMap, LONG_BLOCK_PERIODS, LONG_DECAY, LONG_SCALE));
+
+    LOCK(cs_feeEstimator);
+    UpdateEstimateTable();
 }
 
 CBlockPolicyEstimator::~CBlockPolicyEstimator()
@@ -659,6 +694,8 @@ void CBlockPolicyEstimator::processBlock(unsigned int nBlockHeight,
 
     trackedTxs = 0;
     untrackedTxs = 0;
+
+    UpdateEstimateTable();
 }
 
 CFeeRate CBlockPolicyEstimator::estimateFee(int confTarget) const
@@ -810,42 +847,80 @@ double CBlockPolicyEstimator::estimateConservativeFee(unsigned int doubleTarget,
     return estimate;
 }
 
-/** estimateSmartFee returns the max of the feerates calculated with a 60%
- * threshold required at target / 2, an 85% threshold required at target and a
- * 95% threshold required at 2 * target.  Each calculation is performed at the
- * shortest time horizon which tracks the required target.  Conservative
- * estimates, however, required the 95% threshold at 2 * target be met for any
- * longer time horizons also.
- */
 CFeeRate CBlockPolicyEstimator::estimateSmartFee(int confTarget, FeeCalculation *feeCalc, bool conservative) const
 {
-    LOCK(cs_feeEstimator);
+    std::shared_ptr<const FeeEstimateTable> table = GetEstimateTable();
 
     if (feeCalc) {
         feeCalc->desiredTarget = confTarget;
         feeCalc->returnedTarget = confTarget;
     }
 
-    double median = -1;
-    EstimationResult tempResult;
-
     // Return failure if trying to analyze a target we're not tracking
-    if (confTarget <= 0 || (unsigned int)confTarget > longStats->GetMaxConfirms()) {
+    if (confTarget <= 0 || (unsigned int)confTarget > table->nMaxTarget) {
         return CFeeRate(0);  // error condition
     }
 
     // It's not possible to get reasonable estimates for confTarget of 1
     if (confTarget == 1) confTarget = 2;
 
-    unsigned int maxUsableEstimate = MaxUsableEstimate();
-    if ((unsigned int)confTarget > maxUsableEstimate) {
-        confTarget = maxUsableEstimate;
+    if ((unsigned int)confTarget > table->nMaxUsable) {
+        confTarget = table->nMaxUsable;
     }
     if (feeCalc) feeCalc->returnedTarget = confTarget;
 
     if (confTarget <= 1) return CFeeRate(0); // error condition
 
-    assert(confTarget > 0); //estimateCombinedFee and estimateConservativeFee take unsigned ints
+    const FeeEstimateTable::Entry& entry = conservative ? table->vConservative[confTarget] : table->vEconomical[confTarget];
+    if (feeCalc) {
+        feeCalc->est = entry.est;
+        feeCalc->reason = entry.reason;
+    }
+    return entry.feeRate;
+}
+
+std::shared_ptr<const FeeEstimateTable> CBlockPolicyEstimator::GetEstimateTable() const
+{
+    return std::atomic_load(&estimateTable);
+}
+
+void CBlockPolicyEstimator::UpdateEstimateTable()
+{
+    AssertLockHeld(cs_feeEstimator);
+    std::shared_ptr<FeeEstimateTable> table = std::make_shared<FeeEstimateTable>();
+    table->nBestSeenHeight = nBestSeenHeight;
+    table->nMaxTarget = longStats->GetMaxConfirms();
+    table->nMaxUsable = MaxUsableEstimate();
+    table->vEconomical.resize(table->nMaxUsable + 1);
+    table->vConservative.resize(table->nMaxUsable + 1);
+    for (unsigned int target = 2; target <= table->nMaxUsable; target++) {
+        FeeCalculation feeCalc;
+        FeeEstimateTable::Entry& economical = table->vEconomical[target];
+        economical.feeRate = computeSmartFee(target, &feeCalc, false);
+        economical.est = feeCalc.est;
+        economical.reason = feeCalc.reason;
+        feeCalc = FeeCalculation();
+        FeeEstimateTable::Entry& conservative = table->vConservative[target];
+        conservative.feeRate = computeSmartFee(target, &feeCalc, true);
+        conservative.est = feeCalc.est;
+        conservative.reason = feeCalc.reason;
+    }
+    std::atomic_store(&estimateTable, std::shared_ptr<const FeeEstimateTable>(std::move(table)));
+}
+
+/** estimateSmartFee returns the max of the feerates calculated with a 60%
+ * threshold required at target / 2, an 85% threshold required at target and a
+ * 95% threshold required at 2 * target.  Each calculation is performed at the
+ * shortest time horizon which tracks the required target.  Conservative
+ * estimates, however, required the 95% threshold at 2 * target be met for any
+ * longer time horizons also.
+ */
+CFeeRate CBlockPolicyEstimator::computeSmartFee(unsigned int confTarget, FeeCalculation *feeCalc, bool conservative) const
+{
+    AssertLockHeld(cs_feeEstimator);
+    double median = -1;
+    EstimationResult tempResult;
+
     /** true is passed to estimateCombined fee for target/2 and target so
      * that we check the max confirms for shorter time horizons as well.
      * This is necessary to preserve monotonically increasing estimates.
@@ -972,6 +1047,7 @@ bool CBlockPolicyEstimator::Read(CAutoFile& filein)
             nBestSeenHeight = nFileBestSeenHeight;
             historicalFirst = nFileHistoricalFirst;
             historicalBest = nFileHistoricalBest;
+            UpdateEstimateTable();
         }
     }
     catch (const std::exception& e) {
@@ -990,6 +1066,7 @@ void CBlockPolicyEstimator::FlushUnconfirmed() {
         auto mi = mapMemPoolTxs.begin();
         removeTx(mi->first, false); // this calls erase() on mapMemPoolTxs
     }
+    UpdateEstimateTable();
     int64_t endclear = GetTimeMicros();
     LogPrint(BCLog::ESTIMATEFEE, "Recorded %u unconfirmed txs from mempool in %gs\n", num_entries, (endclear - startclear)*0.000001);
 }
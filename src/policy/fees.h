@@ -12,6 +12,7 @@
 #include <sync.h>
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -129,6 +130,28 @@ struct FeeCalculation
     int returnedTarget = 0;
 };
 
+/** estimateSmartFee results for every confirmation target, computed after a
+ * block is processed. A published table is never modified, so readers can
+ * use it without holding cs_feeEstimator. */
+struct FeeEstimateTable
+{
+    struct Entry
+    {
+        CFeeRate feeRate;
+        EstimationResult est;
+        FeeReason reason = FeeReason::NONE;
+    };
+
+    unsigned int nBestSeenHeight = 0;
+    //! Highest target that can be requested at all
+    unsigned int nMaxTarget = 0;
+    //! Highest target there is enough data for; larger targets are clamped to it
+    unsigned int nMaxUsable = 0;
+    //! Indexed by confirmation target, valid from 2 to nMaxUsable
+    std::vector<Entry> vEconomical;
+    std::vector<Entry> vConservative;
+};
+
 /**
  *  We want to be able to estimate feerates that are needed on tx's to be included in
  * a certain number of blocks.  Every time a block is added to the best chain, this class records
@@ -207,9 +230,13 @@ public:
      *  blocks. If no answer can be given at confTarget, return an estimate at
      *  the closest target where one can be given.  'conservative' estimates are
      *  valid over longer time horizons also.
+     *  Served from the table published after the last block, without locking.
      */
     CFeeRate estimateSmartFee(int confTarget, FeeCalculation *feeCalc, bool conservative) const;
 
+    /** Return the most recently published table of smart fee estimates */
+    std::shared_ptr<const FeeEstimateTable> GetEstimateTable() const;
+
     /** Return a specific fee estimate calculation with a given success
      * threshold and time horizon, and optionally return detailed data about
      * calculation
@@ -257,9 +284,16 @@ private:
 
     mutable CCriticalSection cs_feeEstimator;
 
+    /** Only accessed through std::atomic_load and std::atomic_store */
+    std::shared_ptr<const FeeEstimateTable> estimateTable;
+
     /** Process a transaction confirmed in a block*/
     bool processBlockTx(unsigned int nBlockHeight, const CTxMemPoolEntry* entry);
 
+    /** Compute estimateSmartFee for a target already clamped to [2, MaxUsableEstimate()] */
+    CFeeRate computeSmartFee(unsigned int confTarget, FeeCalculation *feeCalc, bool conservative) const;
+    /** Recompute the smart fee estimates for every target and publish them */
+    void UpdateEstimateTable();
     /** Helper for estimateSmartFee */
     double estimateCombinedFee(unsigned int confTarget, double successThreshold, bool checkShorterHorizon, EstimationResult *result) const;
     /** Helper for estimateSmartFee */
@@ -65,9 +65,9 @@ DenialDialog::DenialDialog(const PlatformStyle *_platformStyle, QWidget *parent)
     ui->tableWidgetCoins->horizontalHeader()->setStretchLastSection(false);
     ui->tableWidgetCoins->verticalHeader()->setVisible(false);
 
-    // Check for transactions to broadcast every 60 seconds
+    // Check for broadcast scheduled transactions every 60 seconds
     scheduledTxTimer = new QTimer(this);
-    connect(scheduledTxTimer, SIGNAL(timeout()), this, SLOT(broadcastScheduledTransactions()));
+    connect(scheduledTxTimer, SIGNAL(timeout()), this, SLOT(refreshScheduledTransactions()));
     scheduledTxTimer->start(60 * 1000);
 
     // Setup automatic denial timer
@@ -144,7 +144,8 @@ void DenialDialog::automaticDenial()
     QMessageBox messageBox;
     messageBox.setWindowTitle("Automatic denial failed!");
 
-    // Decide which coin to deny and schedule denial
+    // Collect every checked coin that is below the denial goal
+    std::vector<COutput> vDeny;
     for (size_t i = 0; i < vCoin.size(); i++) {
         // Skip if denial score is already what we wanted
         if (vCoin[i].tx->nDenial >= nDenialGoal)
@@ -153,33 +154,25 @@ void DenialDialog::automaticDenial()
         // Skip if not checked
 
         if ((int) i >= ui->tableWidgetCoins->rowCount())
-            return;
+            break;
 
-        QTableWidgetItem *itemCheck = ui->tableWidgetCoins->item(i, COLUMN_CHECKBOX);
         bool fChecked = ui->tableWidgetCoins->item(i, COLUMN_CHECKBOX)->checkState() == Qt::Checked;
         if (!fChecked)
             continue;
 
-        // Schedule denial of coin
+        vDeny.push_back(vCoin[i]);
+    }
 
-        CWalletTx wtx;
+    // Deny them in one batch, each broadcast at a random time
+    if (!vDeny.empty()) {
+        std::vector<ScheduledTransaction> vScheduled;
         std::string strFail = "";
-        if (!vpwallets[0]->DenyCoin(wtx, strFail, vCoin[i], false /* fBroadcast */)) {
+        if (!vpwallets[0]->CreateDenials(vDeny, nAutoMinutes * 60, vScheduled, strFail)) {
             messageBox.setText(QString::fromStdString(strFail));
             messageBox.exec();
         }
 
-        // Add a random number of seconds to current time
-        QDateTime dateTime = QDateTime::currentDateTime().addSecs(GetRand(nAutoMinutes * 60));
-
-        std::string strTime = dateTime.toString(QString::fromStdString(SCHEDULED_TX_TIME_FORMAT)).toStdString();
-        if (!vpwallets[0]->ScheduleTransaction(wtx.GetHash(), strTime)) {
-            messageBox.setText("Failed to schedule transaction!\n");
-            messageBox.exec();
-        }
-
         updateCoins();
-        break;
     }
 
     // Change automatic timer to new random time
@@ -322,8 +315,7 @@ void DenialDialog::on_pushButtonCreateAmount_clicked()
         QDateTime dateTime = currentDateTime;
 
         // Schedule for later
-        std::string strTime = dateTime.toString(QString::fromStdString(SCHEDULED_TX_TIME_FORMAT)).toStdString();
-        if (!vpwallets[0]->ScheduleTransaction(wtx.GetHash(), strTime)) {
+        if (!vpwallets[0]->ScheduleTransaction(wtx.GetHash(), dateTime.toTime_t())) {
             messageBox.setText("Failed to schedule transaction!\n");
             messageBox.exec();
             return;
@@ -498,42 +490,14 @@ void DenialDialog::on_tableWidgetCoins_doubleClicked(const QModelIndex& i)
     Deny(i);
 }
 
-void DenialDialog::broadcastScheduledTransactions()
+void DenialDialog::refreshScheduledTransactions()
 {
-    if (vpwallets.empty() || vpwallets[0]->IsLocked())
+    if (vpwallets.empty())
         return;
 
-    // Get current time and day of the week
-    QDateTime currentDateTime = QDateTime::currentDateTime();
-    int nCurrentDay = currentDateTime.date().dayOfWeek();
-
-    std::vector<ScheduledTransaction> vScheduled = vpwallets[0]->GetScheduled();
-    std::vector<ScheduledTransaction> vComplete;
-    for (ScheduledTransaction& s : vScheduled) {
-        QDateTime txDateTime = QDateTime::fromString(
-                    QString::fromStdString(s.strTime),
-                    QString::fromStdString(SCHEDULED_TX_TIME_FORMAT));
-
-        if (nCurrentDay != txDateTime.date().dayOfWeek())
-            continue;
-
-        QTime currentTime = currentDateTime.time();
-        QTime txTime = txDateTime.time();
-
-        // Skip if the scheduled time is > 1 minute away from now
-        if (currentTime.secsTo(txTime) > 1 * 60)
-            continue;
-
-        if (!vpwallets[0]->BroadcastScheduled(s.wtxid))
-            continue;
-
-        vComplete.push_back(s);
-    }
-
-    for (ScheduledTransaction& s : vComplete)
-        vpwallets[0]->RemoveScheduledTransaction(s);
-
-    if (vComplete.size())
+    // The wallet broadcasts scheduled transactions itself, so only update the
+    // view once some have gone out
+    if (vpwallets[0]->GetScheduled().size() != (size_t)scheduledModel->rowCount(QModelIndex()))
         updateCoins();
 }
 
@@ -606,8 +570,7 @@ void DenialDialog::Deny(const QModelIndex& index)
     }
 
     QDateTime dateTime = scheduleDialog.GetDateTime();
-    std::string strTime = dateTime.toString(QString::fromStdString(SCHEDULED_TX_TIME_FORMAT)).toStdString();
-    if (!vpwallets[0]->ScheduleTransaction(wtx.GetHash(), strTime)) {
+    if (!vpwallets[0]->ScheduleTransaction(wtx.GetHash(), dateTime.toTime_t())) {
         messageBox.setText("Failed to schedule transaction!\n");
         messageBox.exec();
         return;
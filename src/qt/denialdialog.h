@@ -58,7 +58,7 @@ private Q_SLOTS:
     void on_checkBoxAll_toggled(bool fChecked);
     void updateCoins();
     void on_tableWidgetCoins_doubleClicked(const QModelIndex& i);
-    void broadcastScheduledTransactions();
+    void refreshScheduledTransactions();
     void contextualMenu(const QPoint &);
     void on_denyAction_clicked();
     void automaticDenial();
@@ -4,6 +4,7 @@
 
 #include <qt/scheduledtransactiontablemodel.h>
 
+#include <QDateTime>
 #include <QMetaType>
 #include <QVariant>
 
@@ -109,7 +110,7 @@ void ScheduledTransactionTableModel::UpdateModel()
         ScheduledTableObject object;
 
         object.txid = QString::fromStdString(tx.wtxid.ToString());
-        object.time = QString::fromStdString(tx.strTime);
+        object.time = QDateTime::fromTime_t(tx.nTime).toString(QString::fromStdString(SCHEDULED_TX_TIME_FORMAT));
 
         model.append(QVariant::fromValue(object));
     }
@@ -23,6 +23,7 @@
 #include <univalue.h>
 
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15; //allow a max of 15 outpoints to be queried at once
+static const long MAX_REST_BLOCK_RANGE = 100; //allow a max of 100 blocks to be fetched at once
 
 enum RetFormat {
     RF_UNDEF,
@@ -121,6 +122,31 @@ static bool CheckWarmup(HTTPRequest* req)
     return true;
 }
 
+/**
+ * Open the stored bytes of each block, to send them without deserializing.
+ * Blocks are stored in network serialization, so this is only valid when
+ * RPCSerializationFlags() asks for no other encoding. On failure no files are
+ * left open.
+ */
+static bool OpenRawBlocks(const std::vector<const CBlockIndex*>& vIndex, std::vector<std::pair<FILE*, int64_t>>& vFile)
+{
+    AssertLockHeld(cs_main);
+    for (const CBlockIndex* pindex : vIndex) {
+        unsigned int nSize = 0;
+        FILE* file = nullptr;
+        if (pindex->nStatus & BLOCK_HAVE_DATA)
+            file = OpenRawBlockFromDisk(pindex->GetBlockPos(), Params().MessageStart(), nSize);
+        if (!file) {
+            for (const auto& f : vFile)
+                fclose(f.first);
+            vFile.clear();
+            return false;
+        }
+        vFile.emplace_back(file, nSize);
+    }
+    return true;
+}
+
 static bool rest_headers(HTTPRequest* req,
                          const std::string& strURIPart)
 {
@@ -208,8 +234,9 @@ static bool rest_block(HTTPRequest* req,
     if (!ParseHashStr(hashStr, hash))
         return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
 
-    CBlock block;
+    std::shared_ptr<const CBlock> pblock;
     CBlockIndex* pblockindex = nullptr;
+    std::vector<std::pair<FILE*, int64_t>> vRawBlock;
     {
         LOCK(cs_main);
         if (mapBlockIndex.count(hash) == 0)
@@ -219,12 +246,24 @@ static bool rest_block(HTTPRequest* req,
         if (fHavePruned && !(pblockindex->nStatus & BLOCK_HAVE_DATA) && pblockindex->nTx > 0)
             return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not available (pruned data)");
 
-        if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
+        if (rf == RF_BINARY && RPCSerializationFlags() == 0) {
+            // Send the stored bytes as they are
+            if (!OpenRawBlocks({pblockindex}, vRawBlock))
+                return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+        } else if (!(pblock = ReadBlockFromDiskCached(pblockindex, Params().GetConsensus())))
             return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
     }
 
+    if (!vRawBlock.empty()) {
+        if (!req->AddReplyFiles(vRawBlock))
+            return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, hashStr + " could not be read");
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK);
+        return true;
+    }
+
     CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-    ssBlock << block;
+    ssBlock << *pblock;
 
     switch (rf) {
     case RF_BINARY: {
@@ -245,7 +284,7 @@ static bool rest_block(HTTPRequest* req,
         UniValue objBlock;
         {
             LOCK(cs_main);
-            objBlock = blockToJSON(block, pblockindex, showTxDetails);
+            objBlock = blockToJSON(*pblock, pblockindex, showTxDetails);
         }
         std::string strJSON = objBlock.write() + "\n";
         req->WriteHeader("Content-Type", "application/json");
@@ -269,6 +308,75 @@ static bool rest_block_notxdetails(HTTPRequest* req, const std::string& strURIPa
     return rest_block(req, strURIPart, false);
 }
 
+static bool rest_blocks(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+
+    if (path.size() != 2)
+        return RESTERR(req, HTTP_BAD_REQUEST, "No block count specified. Use /rest/blocks/<count>/<hash>.<ext>.");
+
+    long count = strtol(path[0].c_str(), nullptr, 10);
+    if (count < 1 || count > MAX_REST_BLOCK_RANGE)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Block count out of range: " + path[0]);
+
+    std::string hashStr = path[1];
+    uint256 hash;
+    if (!ParseHashStr(hashStr, hash))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
+
+    if (rf != RF_BINARY)
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: .bin)");
+
+    // The reply is the concatenation of the serialized blocks, starting at
+    // hash and following the active chain
+    std::vector<const CBlockIndex*> blocks;
+    std::vector<std::pair<FILE*, int64_t>> vRawBlock;
+    blocks.reserve(count);
+    {
+        LOCK(cs_main);
+        BlockMap::const_iterator it = mapBlockIndex.find(hash);
+        const CBlockIndex* pindex = (it != mapBlockIndex.end()) ? it->second : nullptr;
+        if (pindex == nullptr || !chainActive.Contains(pindex))
+            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+        while (pindex != nullptr) {
+            if (fHavePruned && !(pindex->nStatus & BLOCK_HAVE_DATA) && pindex->nTx > 0)
+                return RESTERR(req, HTTP_NOT_FOUND, pindex->GetBlockHash().GetHex() + " not available (pruned data)");
+            blocks.push_back(pindex);
+            if (blocks.size() == (unsigned long)count)
+                break;
+            pindex = chainActive.Next(pindex);
+        }
+
+        if (RPCSerializationFlags() == 0 && !OpenRawBlocks(blocks, vRawBlock))
+            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+    }
+
+    if (!vRawBlock.empty()) {
+        if (!req->AddReplyFiles(vRawBlock))
+            return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, hashStr + " could not be read");
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK);
+        return true;
+    }
+
+    CDataStream ssBlocks(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+    for (const CBlockIndex* pindex : blocks) {
+        std::shared_ptr<const CBlock> pblock = ReadBlockFromDiskCached(pindex, Params().GetConsensus());
+        if (!pblock)
+            return RESTERR(req, HTTP_NOT_FOUND, pindex->GetBlockHash().GetHex() + " not found");
+        ssBlocks << *pblock;
+    }
+    std::string binaryBlocks = ssBlocks.str();
+    req->WriteHeader("Content-Type", "application/octet-stream");
+    req->WriteReply(HTTP_OK, binaryBlocks);
+    return true;
+}
+
 // A bit of a hack - dependency on a function defined in rpc/blockchain.cpp
 UniValue getblockchaininfo(const JSONRPCRequest& request);
 
@@ -581,6 +689,7 @@ static const struct {
       {"/rest/mempool/info", rest_mempool_info},
       {"/rest/mempool/contents", rest_mempool_contents},
       {"/rest/headers/", rest_headers},
+      {"/rest/blocks/", rest_blocks},
       {"/rest/getutxos", rest_getutxos},
 };
 
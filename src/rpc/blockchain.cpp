@@ -17,6 +17,8 @@
 #include <policy/policy.h>
 #include <primitives/transaction.h>
 #include <rpc/server.h>
+#include <script/sigcache.h>
+#include <snapshot.h>
 #include <streams.h>
 #include <sync.h>
 #include <txdb.h>
@@ -779,19 +781,20 @@ UniValue getblock(const JSONRPCRequest& request)
     if (mapBlockIndex.count(hash) == 0)
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
 
-    CBlock block;
     CBlockIndex* pblockindex = mapBlockIndex[hash];
 
     if (fHavePruned && !(pblockindex->nStatus & BLOCK_HAVE_DATA) && pblockindex->nTx > 0)
         throw JSONRPCError(RPC_MISC_ERROR, "Block not available (pruned data)");
 
-    if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
+    std::shared_ptr<const CBlock> pblock = ReadBlockFromDiskCached(pblockindex, Params().GetConsensus());
+    if (!pblock)
         // Block not found on disk. This could be because we have the block
         // header in our index but don't have the block (for example if a
         // non-whitelisted node sends us an unrequested long chain of valid
         // blocks, we add the headers to our index, but don't accept the
         // block).
         throw JSONRPCError(RPC_MISC_ERROR, "Block not found on disk");
+    const CBlock& block = *pblock;
 
     if (verbosity <= 0)
     {
@@ -926,11 +929,15 @@ UniValue pruneblockchain(const JSONRPCRequest& request)
 
 UniValue gettxoutsetinfo(const JSONRPCRequest& request)
 {
-    if (request.fHelp || request.params.size() != 0)
+    if (request.fHelp || request.params.size() > 1)
         throw std::runtime_error(
-            "gettxoutsetinfo\n"
+            "gettxoutsetinfo ( \"hash_type\" )\n"
             "\nReturns statistics about the unspent transaction output set.\n"
-            "Note this call may take some time.\n"
+            "Note this call may take some time, unless hash_type is \"rolling\".\n"
+            "\nArguments:\n"
+            "1. \"hash_type\"   (string, optional, default=\"hash_serialized_2\") Which UTXO set hash to return.\n"
+            "                 \"hash_serialized_2\" walks the whole UTXO set. \"rolling\" returns the running\n"
+            "                 statistics kept up to date with every block instead, and omits \"transactions\".\n"
             "\nResult:\n"
             "{\n"
             "  \"height\":n,     (numeric) The current block height (index)\n"
@@ -938,17 +945,57 @@ UniValue gettxoutsetinfo(const JSONRPCRequest& request)
             "  \"transactions\": n,      (numeric) The number of transactions\n"
             "  \"txouts\": n,            (numeric) The number of output transactions\n"
             "  \"bogosize\": n,          (numeric) A meaningless metric for UTXO set size\n"
-            "  \"hash_serialized_2\": \"hash\", (string) The serialized hash\n"
+            "  \"hash_serialized_2\": \"hash\", (string) The serialized hash (hash_type \"hash_serialized_2\" only)\n"
+            "  \"hash_rolling\": \"hash\", (string) The order-independent rolling hash (hash_type \"rolling\" only)\n"
             "  \"disk_size\": n,         (numeric) The estimated size of the chainstate on disk\n"
             "  \"total_amount\": x.xxx          (numeric) The total amount\n"
+            "  \"sidechain_amounts\": [    (array, hash_type \"rolling\" only) Value locked in each sidechain\n"
+            "    {\n"
+            "      \"nsidechain\": n,      (numeric) Sidechain number\n"
+            "      \"amount\": x.xxx       (numeric) Value of its unspent outputs\n"
+            "    }, ...\n"
+            "  ]\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("gettxoutsetinfo", "")
+            + HelpExampleCli("gettxoutsetinfo", "\"rolling\"")
             + HelpExampleRpc("gettxoutsetinfo", "")
         );
 
     UniValue ret(UniValue::VOBJ);
 
+    const std::string hash_type = request.params[0].isNull() ? "hash_serialized_2" : request.params[0].get_str();
+    if (hash_type == "rolling") {
+        CUTXOSetStats stats;
+        if (!GetUTXOSetStats(stats))
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "UTXO set statistics are unavailable");
+        int nHeight = -1;
+        {
+            LOCK(cs_main);
+            BlockMap::const_iterator mi = mapBlockIndex.find(stats.hashBlock);
+            if (mi != mapBlockIndex.end())
+                nHeight = mi->second->nHeight;
+        }
+        UniValue sidechains(UniValue::VARR);
+        for (const auto& item : stats.mapSidechainAmount) {
+            UniValue obj(UniValue::VOBJ);
+            obj.push_back(Pair("nsidechain", (int)item.first));
+            obj.push_back(Pair("amount", ValueFromAmount(item.second)));
+            sidechains.push_back(obj);
+        }
+        ret.push_back(Pair("height", (int64_t)nHeight));
+        ret.push_back(Pair("bestblock", stats.hashBlock.GetHex()));
+        ret.push_back(Pair("txouts", (int64_t)stats.nTransactionOutputs));
+        ret.push_back(Pair("bogosize", (int64_t)stats.nBogoSize));
+        ret.push_back(Pair("hash_rolling", stats.hashRolling.GetHex()));
+        ret.push_back(Pair("disk_size", (uint64_t)pcoinsdbview->EstimateSize()));
+        ret.push_back(Pair("total_amount", ValueFromAmount(stats.nTotalAmount)));
+        ret.push_back(Pair("sidechain_amounts", sidechains));
+        return ret;
+    }
+    if (hash_type != "hash_serialized_2")
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid hash_type parameter");
+
     CCoinsStats stats;
     FlushStateToDisk();
     if (GetUTXOStats(pcoinsdbview.get(), stats)) {
@@ -966,6 +1013,234 @@ UniValue gettxoutsetinfo(const JSONRPCRequest& request)
     return ret;
 }
 
+UniValue scanutxoset(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2)
+        throw std::runtime_error(
+            "scanutxoset [\"scriptpubkey\",...] ( [nsidechain,...] )\n"
+            "\nScans the unspent transaction output set for outputs paying to any of the\n"
+            "given scripts, or locked to any of the given sidechains. The scan is split\n"
+            "across one thread per core.\n"
+            "\nArguments:\n"
+            "1. \"scriptpubkeys\"  (array, required) Hex encoded output scripts to look for\n"
+            "2. \"sidechains\"     (array, optional) Sidechain numbers whose deposit outputs to look for\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"bestblock\": \"hex\",   (string) The block the scanned UTXO set belongs to\n"
+            "  \"unspents\": [\n"
+            "    {\n"
+            "      \"txid\": \"hex\",       (string) The transaction id\n"
+            "      \"vout\": n,           (numeric) The output number\n"
+            "      \"scriptPubKey\": \"hex\", (string) The output script\n"
+            "      \"amount\": x.xxx,     (numeric) The value in " + CURRENCY_UNIT + "\n"
+            "      \"height\": n,         (numeric) The height of the block that created the output\n"
+            "      \"coinbase\": true|false (boolean) Whether the output belongs to a coinbase\n"
+            "    }\n"
+            "    ,...\n"
+            "  ],\n"
+            "  \"total_amount\": x.xxx  (numeric) The sum of the found outputs\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("scanutxoset", "\"[\\\"76a914...88ac\\\"]\"")
+            + HelpExampleCli("scanutxoset", "\"[]\" \"[0]\"")
+            + HelpExampleRpc("scanutxoset", "[], [0]")
+        );
+
+    RPCTypeCheck(request.params, {UniValue::VARR, UniValue::VARR});
+
+    std::set<CScript> setScripts;
+    const UniValue& scripts = request.params[0].get_array();
+    for (unsigned int i = 0; i < scripts.size(); i++) {
+        std::vector<unsigned char> data(ParseHexV(scripts[i], "scriptpubkey"));
+        setScripts.insert(CScript(data.begin(), data.end()));
+    }
+    std::set<uint8_t> setSidechains;
+    if (!request.params[1].isNull()) {
+        const UniValue& sidechains = request.params[1].get_array();
+        for (unsigned int i = 0; i < sidechains.size(); i++) {
+            int nSidechain = sidechains[i].get_int();
+            if (nSidechain < 0 || nSidechain > 255)
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid sidechain number");
+            setSidechains.insert(nSidechain);
+        }
+    }
+
+    // Each shard collects into its own vector, merged once the scan is done
+    const unsigned int nShards = std::max(1, GetNumCores());
+    std::vector<std::vector<std::pair<COutPoint, Coin>>> vShardResults(nShards);
+    auto fn = [&](unsigned int nShard, const COutPoint& outpoint, const Coin& coin) {
+        uint8_t nSidechain;
+        if (setScripts.count(coin.out.scriptPubKey) ||
+                (!setSidechains.empty() && coin.out.scriptPubKey.IsDrivechain(nSidechain) && setSidechains.count(nSidechain))) {
+            vShardResults[nShard].emplace_back(outpoint, coin);
+        }
+        return true;
+    };
+
+    // The scan runs without cs_main, so a flush from another thread can be
+    // half written when it starts; that is reported with a null hashBlock
+    uint256 hashBlock;
+    bool fOk = false;
+    for (int nTry = 0; nTry < 3 && !fOk; nTry++) {
+        FlushStateToDisk();
+        fOk = pcoinsdbview->ForEachCoinSharded(nShards, fn, hashBlock);
+        if (!fOk && !hashBlock.IsNull())
+            break;
+    }
+    if (!fOk)
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
+
+    UniValue unspents(UniValue::VARR);
+    CAmount nTotal = 0;
+    for (const auto& vResults : vShardResults) {
+        for (const auto& result : vResults) {
+            UniValue obj(UniValue::VOBJ);
+            obj.push_back(Pair("txid", result.first.hash.GetHex()));
+            obj.push_back(Pair("vout", (int64_t)result.first.n));
+            obj.push_back(Pair("scriptPubKey", HexStr(result.second.out.scriptPubKey.begin(), result.second.out.scriptPubKey.end())));
+            obj.push_back(Pair("amount", ValueFromAmount(result.second.out.nValue)));
+            obj.push_back(Pair("height", (int64_t)result.second.nHeight));
+            obj.push_back(Pair("coinbase", (bool)result.second.fCoinBase));
+            unspents.push_back(obj);
+            nTotal += result.second.out.nValue;
+        }
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("bestblock", hashBlock.GetHex()));
+    ret.push_back(Pair("unspents", unspents));
+    ret.push_back(Pair("total_amount", ValueFromAmount(nTotal)));
+    return ret;
+}
+
+static UniValue DBStatsToJSON(const CDBProfile& profile, const CDBStats& stats)
+{
+    UniValue objProfile(UniValue::VOBJ);
+    objProfile.push_back(Pair("bloombits", profile.nBloomBits));
+    objProfile.push_back(Pair("maxopenfiles", profile.nMaxOpenFiles));
+    objProfile.push_back(Pair("blocksize", profile.nBlockSize));
+
+    UniValue objCache(UniValue::VOBJ);
+    const uint64_t nLookups = stats.nCacheHits + stats.nCacheMisses;
+    objCache.push_back(Pair("size", (uint64_t)stats.nCacheSize));
+    objCache.push_back(Pair("usage", (uint64_t)stats.nCacheUsage));
+    objCache.push_back(Pair("hits", stats.nCacheHits));
+    objCache.push_back(Pair("misses", stats.nCacheMisses));
+    objCache.push_back(Pair("hit_rate", nLookups ? (double)stats.nCacheHits / nLookups : 0.0));
+
+    UniValue levels(UniValue::VARR);
+    for (const CDBStats::Level& level : stats.vLevels) {
+        UniValue objLevel(UniValue::VOBJ);
+        objLevel.push_back(Pair("level", level.nLevel));
+        objLevel.push_back(Pair("files", level.nFiles));
+        objLevel.push_back(Pair("size_mib", level.dSizeMiB));
+        objLevel.push_back(Pair("compaction_secs", level.dCompactionSecs));
+        objLevel.push_back(Pair("compaction_read_mib", level.dCompactionReadMiB));
+        objLevel.push_back(Pair("compaction_write_mib", level.dCompactionWriteMiB));
+        levels.push_back(objLevel);
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("profile", objProfile));
+    ret.push_back(Pair("memory_usage", stats.nMemoryUsage));
+    ret.push_back(Pair("cache", objCache));
+    ret.push_back(Pair("levels", levels));
+    return ret;
+}
+
+UniValue getdbstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "getdbstats\n"
+            "\nReturns the LevelDB options and internal statistics of each database.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"chainstate\": {              (json object) Also \"index\", \"sidechain\" and \"opreturn\"\n"
+            "    \"profile\": {               (json object) The options set with -dbprofile\n"
+            "      \"bloombits\": n,\n"
+            "      \"maxopenfiles\": n,\n"
+            "      \"blocksize\": n\n"
+            "    },\n"
+            "    \"memory_usage\": n,         (numeric) Bytes used by the block cache and memtables\n"
+            "    \"cache\": {\n"
+            "      \"size\": n,               (numeric) Capacity of the block cache in bytes\n"
+            "      \"usage\": n,              (numeric) Bytes currently cached\n"
+            "      \"hits\": n,               (numeric) Block cache lookups that found the block\n"
+            "      \"misses\": n,             (numeric) Block cache lookups that had to read from disk\n"
+            "      \"hit_rate\": x.xxx        (numeric) hits / (hits + misses)\n"
+            "    },\n"
+            "    \"levels\": [                (array) Non-empty levels and their compactions\n"
+            "      {\n"
+            "        \"level\": n,\n"
+            "        \"files\": n,              (numeric) Number of table files\n"
+            "        \"size_mib\": x.xxx,       (numeric) Size of the level\n"
+            "        \"compaction_secs\": x.xxx, (numeric) Time spent compacting into the level\n"
+            "        \"compaction_read_mib\": x.xxx,\n"
+            "        \"compaction_write_mib\": x.xxx\n"
+            "      }\n"
+            "      ,...\n"
+            "    ]\n"
+            "  },\n"
+            "  ...\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getdbstats", "")
+            + HelpExampleRpc("getdbstats", "")
+        );
+
+    UniValue ret(UniValue::VOBJ);
+    if (pcoinsdbview)
+        ret.push_back(Pair("chainstate", DBStatsToJSON(pcoinsdbview->GetProfile(), pcoinsdbview->GetDBStats())));
+    if (pblocktree)
+        ret.push_back(Pair("index", DBStatsToJSON(pblocktree->GetProfile(), pblocktree->GetStats())));
+    if (psidechaintree)
+        ret.push_back(Pair("sidechain", DBStatsToJSON(psidechaintree->GetProfile(), psidechaintree->GetStats())));
+    if (popreturndb)
+        ret.push_back(Pair("opreturn", DBStatsToJSON(popreturndb->GetProfile(), popreturndb->GetStats())));
+    return ret;
+}
+
+static UniValue CacheStatsToJSON(const CacheStats& stats)
+{
+    const uint64_t nLookups = stats.nHits + stats.nMisses;
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("capacity", (uint64_t)stats.nCapacity));
+    ret.push_back(Pair("hits", stats.nHits));
+    ret.push_back(Pair("misses", stats.nMisses));
+    ret.push_back(Pair("hit_rate", nLookups ? (double)stats.nHits / nLookups : 0.0));
+    return ret;
+}
+
+UniValue getvalidationcachestats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "getvalidationcachestats\n"
+            "\nReturns how often signature and script checks were answered from the validation caches.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"signatures\": {            (json object) Signatures already verified\n"
+            "    \"capacity\": n,           (numeric) Number of entries the cache can hold\n"
+            "    \"hits\": n,               (numeric) Lookups that found the entry\n"
+            "    \"misses\": n,             (numeric) Lookups that did not\n"
+            "    \"hit_rate\": x.xxx        (numeric) hits / (hits + misses)\n"
+            "  },\n"
+            "  \"scripts\": {               (json object) Whole transactions whose scripts passed with the same flags,\n"
+            "    ...                        which blocks skip script checks for. Same fields as \"signatures\"\n"
+            "  }\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getvalidationcachestats", "")
+            + HelpExampleRpc("getvalidationcachestats", "")
+        );
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("signatures", CacheStatsToJSON(GetSignatureCacheStats())));
+    ret.push_back(Pair("scripts", CacheStatsToJSON(GetScriptExecutionCacheStats())));
+    return ret;
+}
+
 UniValue gettxout(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() < 2 || request.params.size() > 3)
@@ -1402,6 +1677,79 @@ UniValue getmempoolinfo(const JSONRPCRequest& request)
     return mempoolInfoToJSON();
 }
 
+UniValue getmempoolstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "getmempoolstats\n"
+            "\nReturns a fee rate histogram of the TX memory pool and its pending activity per sidechain.\n"
+            "The statistics are kept up to date as transactions enter and leave the mempool, so this\n"
+            "is much cheaper than post-processing getrawmempool.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"size\": xxxxx,               (numeric) Current tx count\n"
+            "  \"bytes\": xxxxx,              (numeric) Sum of all virtual transaction sizes\n"
+            "  \"fees\": x.xxx,               (numeric) Sum of all transaction fees in " + CURRENCY_UNIT + "\n"
+            "  \"feehistogram\": [            (array) Non-empty fee rate buckets, by the transactions' own fee rate\n"
+            "    {\n"
+            "      \"feerate\": x.xxx,        (numeric) Lower bound of the bucket in " + CURRENCY_UNIT + "/kB\n"
+            "      \"count\": xxxxx,          (numeric) Number of transactions in the bucket\n"
+            "      \"bytes\": xxxxx,          (numeric) Sum of their virtual sizes\n"
+            "      \"fees\": x.xxx            (numeric) Sum of their fees in " + CURRENCY_UNIT + "\n"
+            "    }, ...\n"
+            "  ],\n"
+            "  \"sidechains\": [              (array) Sidechains with pending deposits or BMM requests\n"
+            "    {\n"
+            "      \"nsidechain\": n,         (numeric) Sidechain number\n"
+            "      \"deposits\": xxxxx,       (numeric) Number of deposits in the mempool\n"
+            "      \"bmmrequests\": xxxxx,    (numeric) Number of BMM requests in the mempool\n"
+            "      \"bmmfees\": x.xxx         (numeric) Sum of the fees the BMM requests pay in " + CURRENCY_UNIT + "\n"
+            "    }, ...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getmempoolstats", "")
+            + HelpExampleRpc("getmempoolstats", "")
+        );
+
+    MempoolStats stats = mempool.GetStats();
+
+    UniValue histogram(UniValue::VARR);
+    uint64_t nCount = 0;
+    uint64_t nSize = 0;
+    for (size_t i = 0; i < MEMPOOL_FEERATE_BUCKET_COUNT; i++) {
+        const MempoolStats::FeeRateBucket& bucket = stats.vFeeRateBuckets[i];
+        nCount += bucket.nCount;
+        nSize += bucket.nSize;
+        if (!bucket.nCount)
+            continue;
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("feerate", ValueFromAmount(MEMPOOL_FEERATE_BUCKETS[i])));
+        obj.push_back(Pair("count", bucket.nCount));
+        obj.push_back(Pair("bytes", bucket.nSize));
+        obj.push_back(Pair("fees", ValueFromAmount(bucket.nFees)));
+        histogram.push_back(obj);
+    }
+
+    UniValue sidechains(UniValue::VARR);
+    for (const auto& item : stats.mapSidechain) {
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("nsidechain", (int)item.first));
+        obj.push_back(Pair("deposits", item.second.nDeposits));
+        obj.push_back(Pair("bmmrequests", item.second.nBMMRequests));
+        obj.push_back(Pair("bmmfees", ValueFromAmount(item.second.nBMMFees)));
+        sidechains.push_back(obj);
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("size", nCount));
+    ret.push_back(Pair("bytes", nSize));
+    ret.push_back(Pair("fees", ValueFromAmount(stats.nTotalFees)));
+    ret.push_back(Pair("feehistogram", histogram));
+    ret.push_back(Pair("sidechains", sidechains));
+    return ret;
+}
+
 UniValue preciousblock(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 1)
@@ -1615,6 +1963,53 @@ UniValue savemempool(const JSONRPCRequest& request)
     return NullUniValue;
 }
 
+UniValue dumptxoutset(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 1) {
+        throw std::runtime_error(
+            "dumptxoutset \"path\"\n"
+            "\nWrite a snapshot of the chainstate at the current tip to a file. It holds the\n"
+            "UTXO set, the sidechain state and the block headers, and can be loaded by a new\n"
+            "node with -loadtxoutset. That node also needs -loadtxoutsethash set to the\n"
+            "snapshot_hash returned here, obtained from a source it trusts rather than along\n"
+            "with the file.\n"
+            "\nArguments:\n"
+            "1. \"path\"    (string, required) Path to the output file. If relative, will be prefixed by datadir.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"coins_written\": n,         (numeric) The number of coins written\n"
+            "  \"base_hash\": \"hash\",        (string) The hash of the block the snapshot was taken at\n"
+            "  \"base_height\": n,           (numeric) The height of that block\n"
+            "  \"path\": \"path\",             (string) The absolute path of the snapshot\n"
+            "  \"hash_rolling\": \"hash\",     (string) The rolling hash of the UTXO set, see gettxoutsetinfo\n"
+            "  \"hash_scdb\": \"hash\",        (string) The hash of the sidechain state\n"
+            "  \"snapshot_hash\": \"hash\"     (string) The hash to pass with -loadtxoutsethash\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("dumptxoutset", "\"utxo.dat\"")
+            + HelpExampleRpc("dumptxoutset", "\"utxo.dat\"")
+        );
+    }
+
+    fs::path path = fs::absolute(request.params[0].get_str(), GetDataDir());
+    if (fs::exists(path))
+        throw JSONRPCError(RPC_INVALID_PARAMETER, path.string() + " already exists");
+
+    CSnapshotMetadata metadata;
+    if (!DumpChainstateSnapshot(path, metadata))
+        throw JSONRPCError(RPC_MISC_ERROR, "Unable to write chainstate snapshot");
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("coins_written", (int64_t)metadata.stats.nTransactionOutputs));
+    ret.push_back(Pair("base_hash", metadata.hashBase.GetHex()));
+    ret.push_back(Pair("base_height", metadata.nHeight));
+    ret.push_back(Pair("path", path.string()));
+    ret.push_back(Pair("hash_rolling", metadata.stats.hashRolling.GetHex()));
+    ret.push_back(Pair("hash_scdb", metadata.hashSCDB.GetHex()));
+    ret.push_back(Pair("snapshot_hash", metadata.GetSnapshotHash().GetHex()));
+    return ret;
+}
+
 static const CRPCCommand commands[] =
 { //  category              name                      actor (function)         argNames
   //  --------------------- ------------------------  -----------------------  ----------
@@ -1626,16 +2021,21 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getblockhash",           &getblockhash,           {"height"} },
     { "blockchain",         "getblockheader",         &getblockheader,         {"blockhash","verbose"} },
     { "blockchain",         "getchaintips",           &getchaintips,           {} },
+    { "blockchain",         "getdbstats",             &getdbstats,             {} },
     { "blockchain",         "getdifficulty",          &getdifficulty,          {} },
     { "blockchain",         "getmempoolancestors",    &getmempoolancestors,    {"txid","verbose"} },
     { "blockchain",         "getmempooldescendants",  &getmempooldescendants,  {"txid","verbose"} },
     { "blockchain",         "getmempoolentry",        &getmempoolentry,        {"txid"} },
     { "blockchain",         "getmempoolinfo",         &getmempoolinfo,         {} },
+    { "blockchain",         "getmempoolstats",        &getmempoolstats,        {} },
     { "blockchain",         "getrawmempool",          &getrawmempool,          {"verbose"} },
     { "blockchain",         "gettxout",               &gettxout,               {"txid","n","include_mempool"} },
-    { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        {} },
+    { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        {"hash_type"} },
+    { "blockchain",         "getvalidationcachestats", &getvalidationcachestats, {} },
     { "blockchain",         "pruneblockchain",        &pruneblockchain,        {"height"} },
     { "blockchain",         "savemempool",            &savemempool,            {} },
+    { "blockchain",         "scanutxoset",            &scanutxoset,            {"scriptpubkeys","sidechains"} },
+    { "blockchain",         "dumptxoutset",           &dumptxoutset,           {"path"} },
     { "blockchain",         "verifychain",            &verifychain,            {"checklevel","nblocks"} },
 
     { "blockchain",         "preciousblock",          &preciousblock,          {"blockhash"} },
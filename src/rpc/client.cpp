@@ -102,6 +102,8 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "fundrawtransaction", 2, "iswitness" },
     { "gettxout", 1, "n" },
     { "gettxout", 2, "include_mempool" },
+    { "scanutxoset", 0, "scriptpubkeys" },
+    { "scanutxoset", 1, "sidechains" },
     { "gettxoutproof", 0, "txids" },
     { "lockunspent", 0, "unlock" },
     { "lockunspent", 1, "transactions" },
@@ -150,6 +152,15 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "createsidechaindeposit", 0, "nsidechain" },
     { "createsidechaindeposit", 2, "amount" },
     { "createsidechaindeposit", 3, "fee" },
+    { "queuesidechaindeposit", 0, "nsidechain" },
+    { "queuesidechaindeposit", 2, "amount" },
+    { "queuesidechaindeposit", 3, "fee" },
+    { "sendqueuedsidechaindeposits", 0, "nsidechain" },
+    { "clearqueuedsidechaindeposits", 0, "nsidechain" },
+    { "scheduletransaction", 1, "time" },
+    { "denycoins", 0, "goal" },
+    { "denycoins", 1, "count" },
+    { "denycoins", 2, "maxdelay" },
     { "getaveragefee", 0, "blockcount" },
     { "getaveragefee", 1, "startheight" },
     { "getworkscore", 0, "nsidechain" },
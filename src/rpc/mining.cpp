@@ -839,6 +839,60 @@ UniValue estimatesmartfee(const JSONRPCRequest& request)
     return result;
 }
 
+UniValue estimatesmartfeecurve(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 1)
+        throw std::runtime_error(
+            "estimatesmartfeecurve (\"estimate_mode\")\n"
+            "\nReturns the estimatesmartfee result for every confirmation target in one call.\n"
+            "Estimates are recomputed after each block, so all entries are consistent with each other.\n"
+            "\nArguments:\n"
+            "1. \"estimate_mode\" (string, optional, default=CONSERVATIVE) The fee estimate mode, as in estimatesmartfee.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"height\" : n,        (numeric) block height the estimates were computed at\n"
+            "  \"maxtarget\" : n,     (numeric) highest target estimates can currently be given for\n"
+            "  \"estimates\" : [      (json array) one entry per target from 2 to maxtarget\n"
+            "    {\n"
+            "      \"blocks\" : n,      (numeric) confirmation target\n"
+            "      \"feerate\" : x.x,   (numeric, optional) estimate fee rate in " + CURRENCY_UNIT + "/kB, omitted if none was found\n"
+            "    }\n"
+            "    ,...\n"
+            "  ]\n"
+            "}\n"
+            "\nExample:\n"
+            + HelpExampleCli("estimatesmartfeecurve", "\"ECONOMICAL\"")
+            );
+
+    RPCTypeCheck(request.params, {UniValue::VSTR});
+    bool conservative = true;
+    if (!request.params[0].isNull()) {
+        FeeEstimateMode fee_mode;
+        if (!FeeModeFromString(request.params[0].get_str(), fee_mode)) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid estimate_mode parameter");
+        }
+        if (fee_mode == FeeEstimateMode::ECONOMICAL) conservative = false;
+    }
+
+    std::shared_ptr<const FeeEstimateTable> table = ::feeEstimator.GetEstimateTable();
+    const std::vector<FeeEstimateTable::Entry>& entries = conservative ? table->vConservative : table->vEconomical;
+    UniValue estimates(UniValue::VARR);
+    for (unsigned int target = 2; target <= table->nMaxUsable; target++) {
+        UniValue estimate(UniValue::VOBJ);
+        estimate.push_back(Pair("blocks", (int)target));
+        if (entries[target].feeRate != CFeeRate(0)) {
+            estimate.push_back(Pair("feerate", ValueFromAmount(entries[target].feeRate.GetFeePerK())));
+        }
+        estimates.push_back(estimate);
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.push_back(Pair("height", (int)table->nBestSeenHeight));
+    result.push_back(Pair("maxtarget", (int)table->nMaxUsable));
+    result.push_back(Pair("estimates", estimates));
+    return result;
+}
+
 UniValue estimaterawfee(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() < 1 || request.params.size() > 2)
@@ -956,6 +1010,7 @@ static const CRPCCommand commands[] =
 
     { "hidden",             "estimatefee",            &estimatefee,            {} },
     { "util",               "estimatesmartfee",       &estimatesmartfee,       {"conf_target", "estimate_mode"} },
+    { "util",               "estimatesmartfeecurve",  &estimatesmartfeecurve,  {"estimate_mode"} },
 
     { "hidden",             "estimaterawfee",         &estimaterawfee,         {"conf_target", "threshold"} },
 };
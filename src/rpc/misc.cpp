@@ -833,13 +833,13 @@ UniValue listsidechaindeposits(const JSONRPCRequest& request)
         obj.push_back(Pair("hashblock", d.hashBlock.ToString()));
 
         arr.push_back(obj);
-#endif
         if (fLimit) {
             count--;
             if (count <= 0)
                 break;
         }
     }
+#endif
 
     return arr;
 }
@@ -935,6 +935,7 @@ UniValue receivewithdrawalbundle(const JSONRPCRequest& request)
      );
 
 #ifndef ENABLE_WALLET
+    std::string strError;
     strError = "Error: Wallet disabled";
     LogPrintf("%s: %s\n", __func__, strError);
     throw JSONRPCError(RPC_WALLET_ERROR, strError);
@@ -979,7 +980,6 @@ UniValue receivewithdrawalbundle(const JSONRPCRequest& request)
     // Reject the withdrawal if it spends more than the sidechain's CTIP as it won't
     // be accepted anyway
     CAmount amount = withdrawal.GetValueOut();
-    std::vector<COutput> vSidechainCoin;
     CScript scriptPubKey;
     if (!scdb.GetSidechainScript(nSidechain, scriptPubKey)) {
         strError = "Cannot get script for sidechain!";
@@ -1085,13 +1085,14 @@ UniValue verifybmm(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_MISC_ERROR, strError);
     }
 
-    CBlock block;
-    if(!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
+    std::shared_ptr<const CBlock> pblock = ReadBlockFromDiskCached(pblockindex, Params().GetConsensus());
+    if (!pblock)
     {
         std::string strError = "Failed to read block from disk";
         LogPrintf("%s: %s\n", __func__, strError);
         throw JSONRPCError(RPC_MISC_ERROR, strError);
     }
+    const CBlock& block = *pblock;
 
     if (!block.vtx.size()) {
         std::string strError = "No txns in block";
@@ -1186,13 +1187,14 @@ UniValue verifydeposit(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_INTERNAL_ERROR, strError);
     }
 
-    CBlock block;
-    if(!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
+    std::shared_ptr<const CBlock> pblock = ReadBlockFromDiskCached(pblockindex, Params().GetConsensus());
+    if (!pblock)
     {
         std::string strError = "Failed to read block from disk";
         LogPrintf("%s: %s\n", __func__, strError);
         throw JSONRPCError(RPC_INTERNAL_ERROR, strError);
     }
+    const CBlock& block = *pblock;
 
     if (!block.vtx.size()) {
         std::string strError = "No txns in block";
@@ -1605,13 +1607,14 @@ UniValue getaveragefee(const JSONRPCRequest& request)
         if (mapBlockIndex.count(hashBlock) == 0)
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
 
-        CBlock block;
         CBlockIndex* pblockindex = mapBlockIndex[hashBlock];
         if (fHavePruned && !(pblockindex->nStatus & BLOCK_HAVE_DATA) && pblockindex->nTx > 0)
             throw JSONRPCError(RPC_MISC_ERROR, "Block not available (pruned data)");
 
-        if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
+        std::shared_ptr<const CBlock> pblock = ReadBlockFromDiskCached(pblockindex, Params().GetConsensus());
+        if (!pblock)
             throw JSONRPCError(RPC_MISC_ERROR, "Block not found on disk");
+        const CBlock& block = *pblock;
 
         // We don't have the coins (they are spent) to look up the transaction
         // input amounts for calculation of fees. Instead, get the block subsidy
@@ -101,6 +101,9 @@ UniValue getpeerinfo(const JSONRPCRequest& request)
             "       n,                        (numeric) The heights of blocks we're currently asking from this peer\n"
             "       ...\n"
             "    ],\n"
+            "    \"blockwindow\": n,          (numeric) The number of blocks we keep requested from this peer\n"
+            "    \"blocklatency\": n,         (numeric) Average time in seconds from requesting a block to receiving it\n"
+            "    \"blockinterval\": n,        (numeric) Average time in seconds between blocks received from this peer\n"
             "    \"whitelisted\": true|false, (boolean) Whether the peer is whitelisted\n"
             "    \"bytessent_per_msg\": {\n"
             "       \"addr\": n,              (numeric) The total bytes sent aggregated by message type\n"
@@ -167,6 +170,9 @@ UniValue getpeerinfo(const JSONRPCRequest& request)
                 heights.push_back(height);
             }
             obj.push_back(Pair("inflight", heights));
+            obj.push_back(Pair("blockwindow", statestats.nBlockWindow));
+            obj.push_back(Pair("blocklatency", statestats.nBlockLatency / 1e6));
+            obj.push_back(Pair("blockinterval", statestats.nBlockInterval / 1e6));
         }
         obj.push_back(Pair("whitelisted", stats.fWhitelisted));
 
@@ -392,6 +398,39 @@ UniValue getnettotals(const JSONRPCRequest& request)
     return obj;
 }
 
+UniValue getcompactblockstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 0)
+        throw std::runtime_error(
+            "getcompactblockstats\n"
+            "\nReturns how well compact blocks (BIP 152) were reconstructed since startup.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"received\": n,            (numeric) Compact blocks we tried to reconstruct\n"
+            "  \"reconstructed\": n,       (numeric) Blocks reconstructed without requesting transactions\n"
+            "  \"reconstruction_rate\": x, (numeric) Fraction of blocks reconstructed without a round trip\n"
+            "  \"round_trips\": n,         (numeric) Number of getblocktxn requests sent\n"
+            "  \"tx_requested\": n,        (numeric) Number of transactions requested with getblocktxn\n"
+            "  \"tx_from_extra\": n        (numeric) Transactions found outside the mempool, including\n"
+            "                                withdrawal payouts and evicted BMM requests\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getcompactblockstats", "")
+            + HelpExampleRpc("getcompactblockstats", "")
+       );
+
+    CompactBlockStats stats = GetCompactBlockStats();
+
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("received", stats.nReceived));
+    obj.push_back(Pair("reconstructed", stats.nReconstructed));
+    obj.push_back(Pair("reconstruction_rate", stats.nReceived ? (double)stats.nReconstructed / stats.nReceived : 0.0));
+    obj.push_back(Pair("round_trips", stats.nRoundTrips));
+    obj.push_back(Pair("tx_requested", stats.nTxRequested));
+    obj.push_back(Pair("tx_from_extra", stats.nTxFromExtra));
+    return obj;
+}
+
 static UniValue GetNetworksInfo()
 {
     UniValue networks(UniValue::VARR);
@@ -633,6 +672,7 @@ static const CRPCCommand commands[] =
     { "network",            "addnode",                &addnode,                {"node","command"} },
     { "network",            "disconnectnode",         &disconnectnode,         {"address", "nodeid"} },
     { "network",            "getaddednodeinfo",       &getaddednodeinfo,       {"node"} },
+    { "network",            "getcompactblockstats",   &getcompactblockstats,   {} },
     { "network",            "getnettotals",           &getnettotals,           {} },
     { "network",            "getnetworkinfo",         &getnetworkinfo,         {} },
     { "network",            "setban",                 &setban,                 {"subnet", "command", "bantime", "absolute"} },
@@ -7,6 +7,7 @@
 #define BITCOIN_RPCPROTOCOL_H
 
 #include <fs.h>
+#include <serialize.h>
 
 #include <list>
 #include <map>
@@ -101,4 +102,161 @@ void DeleteAuthCookie();
 /** Parse JSON-RPC batch reply into a vector */
 std::vector<UniValue> JSONRPCProcessBatchReply(const UniValue &in, size_t num);
 
+/**
+ * Binary RPC protocol. A request is a serialized vector of BinaryRPCCall and
+ * the reply a serialized vector of BinaryRPCReply in the same order, so many
+ * calls can be pipelined in a single round trip without any JSON parsing or
+ * formatting. Parameters and results use the same values as JSON-RPC.
+ */
+
+/** Maximum nesting depth of values in the binary RPC protocol */
+static const unsigned int MAX_BINARY_RPC_DEPTH = 64;
+
+/** Serialization wrapper for UniValue in the binary RPC protocol.
+ * A value is its UniValue::VType as one byte, followed by a byte for bools,
+ * the text for numbers and strings (UniValue keeps numbers as text, so no
+ * conversion happens), or a compact size count followed by the elements of
+ * an array or the (key, value) pairs of an object.
+ */
+class BinaryRPCValue
+{
+private:
+    UniValue& value;
+
+    template<typename Stream>
+    static void SerializeValue(Stream& s, const UniValue& v)
+    {
+        ser_writedata8(s, v.getType());
+        switch (v.getType()) {
+        case UniValue::VNULL:
+            break;
+        case UniValue::VBOOL:
+            ser_writedata8(s, v.isTrue());
+            break;
+        case UniValue::VNUM:
+        case UniValue::VSTR:
+            ::Serialize(s, v.getValStr());
+            break;
+        case UniValue::VARR:
+        case UniValue::VOBJ:
+            WriteCompactSize(s, v.size());
+            for (size_t i = 0; i < v.size(); i++) {
+                if (v.isObject())
+                    ::Serialize(s, v.getKeys()[i]);
+                SerializeValue(s, v[i]);
+            }
+            break;
+        }
+    }
+
+    template<typename Stream>
+    static void UnserializeValue(Stream& s, UniValue& v, unsigned int nDepth)
+    {
+        if (nDepth > MAX_BINARY_RPC_DEPTH)
+            throw std::ios_base::failure("Binary RPC value nested too deeply");
+
+        uint8_t nType = ser_readdata8(s);
+        switch (nType) {
+        case UniValue::VNULL:
+            v.setNull();
+            break;
+        case UniValue::VBOOL:
+            v.setBool(ser_readdata8(s) != 0);
+            break;
+        case UniValue::VNUM: {
+            std::string str;
+            ::Unserialize(s, str);
+            // setNumStr only checks the leading token, so require it to span the whole string
+            std::string strToken;
+            unsigned int nConsumed = 0;
+            if (getJsonToken(strToken, nConsumed, str.data(), str.data() + str.size()) != JTOK_NUMBER ||
+                nConsumed != str.size() || !v.setNumStr(str))
+                throw std::ios_base::failure("Invalid binary RPC number");
+            break;
+        }
+        case UniValue::VSTR: {
+            std::string str;
+            ::Unserialize(s, str);
+            v.setStr(str);
+            break;
+        }
+        case UniValue::VARR:
+        case UniValue::VOBJ: {
+            uint64_t nSize = ReadCompactSize(s);
+            if (nType == UniValue::VARR)
+                v.setArray();
+            else
+                v.setObject();
+            for (uint64_t i = 0; i < nSize; i++) {
+                std::string strKey;
+                if (nType == UniValue::VOBJ)
+                    ::Unserialize(s, strKey);
+                UniValue elem;
+                UnserializeValue(s, elem, nDepth + 1);
+                if (nType == UniValue::VOBJ)
+                    v.__pushKV(strKey, elem);
+                else
+                    v.push_back(elem);
+            }
+            break;
+        }
+        default:
+            throw std::ios_base::failure("Unknown binary RPC value type");
+        }
+    }
+
+public:
+    explicit BinaryRPCValue(UniValue& valueIn) : value(valueIn) {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        SerializeValue(s, value);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        UnserializeValue(s, value, 0);
+    }
+};
+
+#define BINARYRPCVALUE(obj) REF(BinaryRPCValue(REF(obj)))
+
+/** A single call of a binary RPC request */
+struct BinaryRPCCall
+{
+    std::string strMethod;
+    UniValue params;
+
+    BinaryRPCCall() : params(UniValue::VARR) {}
+    BinaryRPCCall(const std::string& strMethodIn, const UniValue& paramsIn) : strMethod(strMethodIn), params(paramsIn) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(strMethod);
+        READWRITE(BINARYRPCVALUE(params));
+    }
+};
+
+/** Outcome of a single binary RPC call: the result, or the JSON-RPC error object */
+struct BinaryRPCReply
+{
+    bool fError;
+    UniValue value;
+
+    BinaryRPCReply() : fError(false) {}
+    BinaryRPCReply(bool fErrorIn, const UniValue& valueIn) : fError(fErrorIn), value(valueIn) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(fError);
+        READWRITE(BINARYRPCVALUE(value));
+    }
+};
+
 #endif // BITCOIN_RPCPROTOCOL_H
@@ -7,6 +7,7 @@
 
 #include <base58.h>
 #include <fs.h>
+#include <httpserver.h>
 #include <init.h>
 #include <random.h>
 #include <sync.h>
@@ -32,6 +33,55 @@ static RPCTimerInterface* timerInterface = nullptr;
 /* Map of name to timer. */
 static std::map<std::string, std::unique_ptr<RPCTimerBase> > deadlineTimers;
 
+/** Execution statistics of a single RPC method */
+struct RPCMethodStats
+{
+    uint64_t nCalls = 0;
+    uint64_t nErrors = 0;
+    int nActive = 0;
+    //! Total time (in microseconds) requests spent waiting before execution
+    int64_t nTotalWait = 0;
+    //! Total and maximum execution time (in microseconds)
+    int64_t nTotalTime = 0;
+    int64_t nMaxTime = 0;
+};
+static CCriticalSection cs_rpcStats;
+static std::map<std::string, RPCMethodStats> mapRPCStats;
+
+/** Records one RPC call in mapRPCStats for the duration of its execution */
+class RPCCallTracker
+{
+private:
+    const std::string& strMethod;
+    int64_t nTimeStart;
+    bool fSuccess;
+
+public:
+    explicit RPCCallTracker(const JSONRPCRequest& request) : strMethod(request.strMethod), nTimeStart(GetTimeMicros()), fSuccess(false)
+    {
+        LOCK(cs_rpcStats);
+        RPCMethodStats& stats = mapRPCStats[strMethod];
+        stats.nActive++;
+        if (request.nTimeReceived)
+            stats.nTotalWait += std::max<int64_t>(nTimeStart - request.nTimeReceived, 0);
+    }
+
+    ~RPCCallTracker()
+    {
+        int64_t nTime = GetTimeMicros() - nTimeStart;
+        LOCK(cs_rpcStats);
+        RPCMethodStats& stats = mapRPCStats[strMethod];
+        stats.nActive--;
+        stats.nCalls++;
+        if (!fSuccess)
+            stats.nErrors++;
+        stats.nTotalTime += nTime;
+        stats.nMaxTime = std::max(stats.nMaxTime, nTime);
+    }
+
+    void Success() { fSuccess = true; }
+};
+
 static struct CRPCSignals
 {
     boost::signals2::signal<void ()> Started;
@@ -256,6 +306,70 @@ UniValue uptime(const JSONRPCRequest& jsonRequest)
     return GetTime() - GetStartupTime();
 }
 
+UniValue getrpcstats(const JSONRPCRequest& jsonRequest)
+{
+    if (jsonRequest.fHelp || jsonRequest.params.size() > 0)
+        throw std::runtime_error(
+                "getrpcstats\n"
+                        "\nReturns per-method RPC call statistics and the load of the HTTP work queues.\n"
+                        "\nResult:\n"
+                        "{\n"
+                        "  \"methods\": {\n"
+                        "    \"method\": {             (json object) Statistics of a method that has been called\n"
+                        "      \"calls\": n,           (numeric) Number of completed calls\n"
+                        "      \"errors\": n,          (numeric) Number of calls that returned an error\n"
+                        "      \"active\": n,          (numeric) Number of calls currently executing\n"
+                        "      \"avg_wait_ms\": x.xxx, (numeric) Average time between receiving and executing a call\n"
+                        "      \"avg_time_ms\": x.xxx, (numeric) Average execution time\n"
+                        "      \"max_time_ms\": x.xxx  (numeric) Maximum execution time\n"
+                        "    }, ...\n"
+                        "  },\n"
+                        "  \"work_queues\": [        (json array) HTTP work queues\n"
+                        "    {\n"
+                        "      \"name\": \"xxxx\",       (string) Queue name\n"
+                        "      \"depth\": n,           (numeric) Number of requests waiting for a worker\n"
+                        "      \"max_depth\": n,       (numeric) Maximum number of waiting requests\n"
+                        "      \"threads\": n          (numeric) Number of worker threads\n"
+                        "    }, ...\n"
+                        "  ]\n"
+                        "}\n"
+                        "\nExamples:\n"
+                + HelpExampleCli("getrpcstats", "")
+                + HelpExampleRpc("getrpcstats", "")
+        );
+
+    UniValue methods(UniValue::VOBJ);
+    {
+        LOCK(cs_rpcStats);
+        for (const auto& entry : mapRPCStats) {
+            const RPCMethodStats& stats = entry.second;
+            UniValue obj(UniValue::VOBJ);
+            obj.push_back(Pair("calls", stats.nCalls));
+            obj.push_back(Pair("errors", stats.nErrors));
+            obj.push_back(Pair("active", stats.nActive));
+            obj.push_back(Pair("avg_wait_ms", stats.nCalls ? stats.nTotalWait * 0.001 / stats.nCalls : 0.0));
+            obj.push_back(Pair("avg_time_ms", stats.nCalls ? stats.nTotalTime * 0.001 / stats.nCalls : 0.0));
+            obj.push_back(Pair("max_time_ms", stats.nMaxTime * 0.001));
+            methods.push_back(Pair(entry.first, obj));
+        }
+    }
+
+    UniValue queues(UniValue::VARR);
+    for (const HTTPWorkQueueInfo& info : GetHTTPWorkQueueInfo()) {
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("name", info.name));
+        obj.push_back(Pair("depth", (uint64_t)info.depth));
+        obj.push_back(Pair("max_depth", (uint64_t)info.maxDepth));
+        obj.push_back(Pair("threads", info.threads));
+        queues.push_back(obj);
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("methods", methods));
+    ret.push_back(Pair("work_queues", queues));
+    return ret;
+}
+
 /**
  * Call Table
  */
@@ -266,6 +380,7 @@ static const CRPCCommand vRPCCommands[] =
     { "control",            "help",                   &help,                   {"command"}  },
     { "control",            "stop",                   &stop,                   {}  },
     { "control",            "uptime",                 &uptime,                 {}  },
+    { "control",            "getrpcstats",            &getrpcstats,            {}  },
 };
 
 CRPCTable::CRPCTable()
@@ -413,8 +528,11 @@ static UniValue JSONRPCExecOne(JSONRPCRequest jreq, const UniValue& req)
 std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq)
 {
     UniValue ret(UniValue::VARR);
-    for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
-        ret.push_back(JSONRPCExecOne(jreq, vReq[reqIdx]));
+    JSONRPCRequest jreqCall = jreq;
+    for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++) {
+        ret.push_back(JSONRPCExecOne(jreqCall, vReq[reqIdx]));
+        jreqCall.nTimeReceived = GetTimeMicros();
+    }
 
     return ret.write() + "\n";
 }
@@ -485,14 +603,18 @@ UniValue CRPCTable::execute(const JSONRPCRequest &request) const
 
     g_rpcSignals.PreCommand(*pcmd);
 
+    RPCCallTracker tracker(request);
     try
     {
         // Execute, convert arguments to array if necessary
+        UniValue result;
         if (request.params.isObject()) {
-            return pcmd->actor(transformNamedArguments(request, pcmd->argNames));
+            result = pcmd->actor(transformNamedArguments(request, pcmd->argNames));
         } else {
-            return pcmd->actor(request);
+            result = pcmd->actor(request);
         }
+        tracker.Success();
+        return result;
     }
     catch (const std::exception& e)
     {
@@ -45,8 +45,14 @@ public:
     bool fHelp;
     std::string URI;
     std::string authUser;
+    /**
+     * Time the request was received by the transport (in microseconds), 0 if
+     * unknown. Only the first call of a batch waits for a worker; the others
+     * are stamped when the call before them returns.
+     */
+    int64_t nTimeReceived;
 
-    JSONRPCRequest() : id(NullUniValue), params(NullUniValue), fHelp(false) {}
+    JSONRPCRequest() : id(NullUniValue), params(NullUniValue), fHelp(false), nTimeReceived(0) {}
     void parse(const UniValue& valRequest);
 };
 
@@ -10,8 +10,11 @@
 #include <crypto/sha256.h>
 #include <pubkey.h>
 #include <script/script.h>
+#include <streams.h>
 #include <uint256.h>
 
+#include <algorithm>
+
 typedef std::vector<unsigned char> valtype;
 
 namespace {
@@ -1153,6 +1156,51 @@ public:
     }
 };
 
+/** Serialization stream that writes into a SHA256 state */
+class CSHA256Writer
+{
+private:
+    CSHA256& sha;
+
+public:
+    explicit CSHA256Writer(CSHA256& shaIn) : sha(shaIn) {}
+
+    int GetType() const { return SER_GETHASH; }
+    int GetVersion() const { return 0; }
+
+    void write(const char *pch, size_t size) {
+        sha.Write((const unsigned char*)pch, size);
+    }
+
+    template<typename T>
+    CSHA256Writer& operator<<(const T& obj) {
+        ::Serialize(*this, obj);
+        return *this;
+    }
+};
+
+//! Prevout, empty script and nSequence
+static const size_t LEGACY_BLANK_INPUT_SIZE = 36 + 1 + 4;
+
+/** Same as the legacy path of SignatureHash for SIGHASH_ALL, resuming from the precomputed state before nIn */
+uint256 LegacySignatureHashAll(const CScript& scriptCode, const CTransaction& txTo, unsigned int nIn, int nHashType, const PrecomputedTransactionData& cache)
+{
+    CSHA256 sha(cache.legacyPrefix[nIn]);
+    CSHA256Writer ss(sha);
+    ss << txTo.vin[nIn].prevout;
+    CTransactionSignatureSerializer(txTo, scriptCode, nIn, nHashType).SerializeScriptCode(ss);
+    ss << txTo.vin[nIn].nSequence;
+    const size_t nNextPos = (nIn + 1) * LEGACY_BLANK_INPUT_SIZE;
+    sha.Write(cache.legacyInputs.data() + nNextPos, cache.legacyInputs.size() - nNextPos);
+    sha.Write(cache.legacySuffix.data(), cache.legacySuffix.size());
+    ss << nHashType;
+
+    uint256 hash;
+    sha.Finalize(hash.begin());
+    CSHA256().Write(hash.begin(), CSHA256::OUTPUT_SIZE).Finalize(hash.begin());
+    return hash;
+}
+
 uint256 GetPrevoutHash(const CTransaction& txTo) {
     CHashWriter ss(SER_GETHASH, 0);
     for (const auto& txin : txTo.vin) {
@@ -1188,6 +1236,31 @@ PrecomputedTransactionData::PrecomputedTransactionData(const CTransaction& txTo)
         hashOutputs = GetOutputsHash(txTo);
         ready = true;
     }
+
+    // Signing n legacy inputs would otherwise serialize and hash the whole
+    // transaction n times
+    const bool fLegacyInputs = std::any_of(txTo.vin.begin(), txTo.vin.end(), [](const CTxIn& txin) { return txin.scriptWitness.IsNull(); });
+    if (txTo.vin.size() > 1 && fLegacyInputs) {
+        legacyInputs.reserve(txTo.vin.size() * LEGACY_BLANK_INPUT_SIZE);
+        CVectorWriter inputs(SER_GETHASH, 0, legacyInputs, 0);
+        for (const auto& txin : txTo.vin)
+            inputs << txin.prevout << CScript() << txin.nSequence;
+        assert(legacyInputs.size() == txTo.vin.size() * LEGACY_BLANK_INPUT_SIZE);
+
+        CVectorWriter suffix(SER_GETHASH, 0, legacySuffix, 0);
+        suffix << txTo.vout << txTo.nLockTime;
+
+        CSHA256 sha;
+        CSHA256Writer prefix(sha);
+        prefix << txTo.nVersion;
+        WriteCompactSize(prefix, txTo.vin.size());
+        legacyPrefix.reserve(txTo.vin.size());
+        for (size_t i = 0; i < txTo.vin.size(); i++) {
+            legacyPrefix.push_back(sha);
+            sha.Write(legacyInputs.data() + i * LEGACY_BLANK_INPUT_SIZE, LEGACY_BLANK_INPUT_SIZE);
+        }
+        legacyReady = true;
+    }
 }
 
 uint256 SignatureHash(const CScript& scriptCode, const CTransaction& txTo, unsigned int nIn, int nHashType, const CAmount& amount, SigVersion sigversion, const PrecomputedTransactionData* cache)
@@ -1250,6 +1323,11 @@ uint256 SignatureHash(const CScript& scriptCode, const CTransaction& txTo, unsig
         }
     }
 
+    if (cache && cache->legacyReady && !(nHashType & SIGHASH_ANYONECANPAY) &&
+            (nHashType & 0x1f) != SIGHASH_SINGLE && (nHashType & 0x1f) != SIGHASH_NONE) {
+        return LegacySignatureHashAll(scriptCode, txTo, nIn, nHashType, *cache);
+    }
+
     // Wrapper to serialize only the necessary parts of the transaction being signed
     CTransactionSignatureSerializer txTmp(txTo, scriptCode, nIn, nHashType);
 
@@ -6,6 +6,7 @@
 #ifndef BITCOIN_SCRIPT_INTERPRETER_H
 #define BITCOIN_SCRIPT_INTERPRETER_H
 
+#include <crypto/sha256.h>
 #include <script/script_error.h>
 #include <primitives/transaction.h>
 
@@ -120,6 +121,19 @@ struct PrecomputedTransactionData
     uint256 hashPrevouts, hashSequence, hashOutputs;
     bool ready = false;
 
+    /**
+     * Legacy SIGHASH_ALL digests of one transaction only differ in the script
+     * of the input being signed. Kept for transactions with several inputs and
+     * at least one without witness.
+     */
+    //! SHA256 state after the version, the input count and the blanked inputs before each input
+    std::vector<CSHA256> legacyPrefix;
+    //! Every input serialized with an empty script, LEGACY_BLANK_INPUT_SIZE bytes each
+    std::vector<unsigned char> legacyInputs;
+    //! The serialized outputs and nLockTime
+    std::vector<unsigned char> legacySuffix;
+    bool legacyReady = false;
+
     explicit PrecomputedTransactionData(const CTransaction& tx);
 };
 
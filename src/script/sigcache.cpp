@@ -12,6 +12,9 @@
 #include <util.h>
 
 #include <cuckoocache.h>
+
+#include <atomic>
+
 #include <boost/thread.hpp>
 
 namespace {
@@ -23,14 +26,31 @@ namespace {
 class CSignatureCache
 {
 private:
+    //! Independent caches, so that script check threads storing signatures
+    //! mostly take different locks
+    static const unsigned int SHARDS = 16;
+
+    struct Shard
+    {
+        CuckooCache::cache<uint256, SignatureCacheHasher> setValid;
+        boost::shared_mutex cs_shard;
+    };
+
      //! Entries are SHA256(nonce || signature hash || public key || signature):
     uint256 nonce;
-    typedef CuckooCache::cache<uint256, SignatureCacheHasher> map_type;
-    map_type setValid;
-    boost::shared_mutex cs_sigcache;
+    Shard shards[SHARDS];
+    size_t nCapacity;
+    std::atomic<uint64_t> nHits;
+    std::atomic<uint64_t> nMisses;
+
+    Shard& GetShard(const uint256& entry)
+    {
+        // The low bits of the first byte barely move an entry within its cuckoo table
+        return shards[entry.begin()[0] % SHARDS];
+    }
 
 public:
-    CSignatureCache()
+    CSignatureCache() : nCapacity(0), nHits(0), nMisses(0)
     {
         GetRandBytes(nonce.begin(), 32);
     }
@@ -44,18 +64,39 @@ public:
     bool
     Get(const uint256& entry, const bool erase)
     {
-        boost::shared_lock<boost::shared_mutex> lock(cs_sigcache);
-        return setValid.contains(entry, erase);
+        Shard& shard = GetShard(entry);
+        boost::shared_lock<boost::shared_mutex> lock(shard.cs_shard);
+        if (shard.setValid.contains(entry, erase)) {
+            nHits++;
+            return true;
+        }
+        nMisses++;
+        return false;
     }
 
     void Set(uint256& entry)
     {
-        boost::unique_lock<boost::shared_mutex> lock(cs_sigcache);
-        setValid.insert(entry);
+        Shard& shard = GetShard(entry);
+        boost::unique_lock<boost::shared_mutex> lock(shard.cs_shard);
+        shard.setValid.insert(entry);
     }
+
     uint32_t setup_bytes(size_t n)
     {
-        return setValid.setup_bytes(n);
+        uint32_t nElems = 0;
+        for (Shard& shard : shards)
+            nElems += shard.setValid.setup_bytes(n / SHARDS);
+        nCapacity = nElems;
+        return nElems;
+    }
+
+    CacheStats GetStats() const
+    {
+        CacheStats stats;
+        stats.nHits = nHits;
+        stats.nMisses = nMisses;
+        stats.nCapacity = nCapacity;
+        return stats;
     }
 };
 
@@ -80,6 +121,11 @@ void InitSignatureCache()
             (nElems*sizeof(uint256)) >>20, (nMaxCacheSize*2)>>20, nElems);
 }
 
+CacheStats GetSignatureCacheStats()
+{
+    return signatureCache.GetStats();
+}
+
 bool CachingTransactionSignatureChecker::VerifySignature(const std::vector<unsigned char>& vchSig, const CPubKey& pubkey, const uint256& sighash) const
 {
     uint256 entry;
@@ -20,6 +20,14 @@ static const int64_t MAX_MAX_SIG_CACHE_SIZE = 16384;
 
 class CPubKey;
 
+/** Lookups and capacity, in entries, of a validation cache */
+struct CacheStats
+{
+    uint64_t nHits = 0;
+    uint64_t nMisses = 0;
+    size_t nCapacity = 0;
+};
+
 /**
  * We're hashing a nonce into the entries themselves, so we don't need extra
  * blinding in the set hash computation.
@@ -54,4 +62,6 @@ public:
 
 void InitSignatureCache();
 
+CacheStats GetSignatureCacheStats();
+
 #endif // BITCOIN_SCRIPT_SIGCACHE_H
@@ -325,6 +325,67 @@ bool SidechainDB::GetCachedWithdrawalTx(const uint256& hash, CMutableTransaction
     return false;
 }
 
+bool SidechainDB::GetWithdrawalPayout(uint8_t nSidechain, const uint256& hash, CMutableTransaction& mtx, CAmount& nFees) const
+{
+    mtx = CMutableTransaction();
+    mtx.nVersion = 2;
+
+    // Copy outputs from withdrawal tx
+    for (const std::pair<uint8_t, CMutableTransaction>& pair : vWithdrawalTxCache) {
+        if (pair.first == nSidechain && pair.second.GetHash() == hash) {
+            mtx.vout = pair.second.vout;
+            break;
+        }
+    }
+    // Withdrawal should have at least the encoded dest output, encoded fee
+    // output, and change return output.
+    if (mtx.vout.size() < 3)
+        return false;
+
+    // Get the mainchain fee amount from the second Withdrawal output which
+    // encodes the sum of withdrawal fees.
+    if (!DecodeWithdrawalFees(mtx.vout[1].scriptPubKey, nFees))
+        return false;
+
+    // Calculate the amount to be withdrawn by Withdrawal
+    CAmount amountWithdrawn = nFees;
+    for (const CTxOut& out : mtx.vout) {
+        uint8_t n;
+        if (!out.scriptPubKey.IsDrivechain(n))
+            amountWithdrawn += out.nValue;
+    }
+
+    // Pay the change left over from this Withdrawal back to the sidechain.
+    // Note: Withdrawal change return must be the final output
+    CScript sidechainScript;
+    if (!GetSidechainScript(nSidechain, sidechainScript))
+        return false;
+
+    SidechainCTIP ctip;
+    if (!GetCTIP(nSidechain, ctip))
+        return false;
+
+    if (ctip.amount - amountWithdrawn < 0)
+        return false;
+
+    mtx.vout.push_back(CTxOut(ctip.amount - amountWithdrawn, sidechainScript));
+    mtx.vin.push_back(CTxIn(ctip.out));
+
+    return true;
+}
+
+std::vector<CTransactionRef> SidechainDB::GetWithdrawalPayoutCandidates() const
+{
+    std::vector<CTransactionRef> vPayout;
+    for (const std::pair<uint8_t, CMutableTransaction>& pair : vWithdrawalTxCache) {
+        CMutableTransaction mtx;
+        CAmount nFees = 0;
+        if (GetWithdrawalPayout(pair.first, pair.second.GetHash(), mtx, nFees))
+            vPayout.push_back(MakeTransactionRef(std::move(mtx)));
+    }
+    return vPayout;
+}
+
 std::map<uint8_t, SidechainCTIP> SidechainDB::GetCTIP() const
 {
     return mapCTIP;
@@ -110,6 +110,15 @@ public:
 
     bool GetCachedWithdrawalTx(const uint256& hash, CMutableTransaction& mtx) const;
 
+    /** Build the payout transaction that spends nSidechain's CTIP and pays
+     * out the cached withdrawal with the given hash. nFees is set to the
+     * mainchain fees the withdrawal encodes. */
+    bool GetWithdrawalPayout(uint8_t nSidechain, const uint256& hash, CMutableTransaction& mtx, CAmount& nFees) const;
+
+    /** Return the payout for every cached withdrawal that could currently be
+     * built. Used to reconstruct compact blocks that include a payout. */
+    std::vector<CTransactionRef> GetWithdrawalPayoutCandidates() const;
+
     /** Return vector of cached custom withdrawal votes */
     std::vector<std::string> GetVotes() const;
 
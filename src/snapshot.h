@@ -0,0 +1,101 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_SNAPSHOT_H
+#define BITCOIN_SNAPSHOT_H
+
+#include <coins.h>
+#include <hash.h>
+#include <primitives/transaction.h>
+#include <protocol.h>
+#include <serialize.h>
+#include <sidechain.h>
+#include <uint256.h>
+#include <version.h>
+
+#include <string.h>
+#include <utility>
+#include <vector>
+
+static const uint32_t SNAPSHOT_VERSION = 1;
+
+/**
+ * Sidechain state at the snapshot block: what SCDB keeps in its per-block
+ * database entry, plus the caches that are otherwise rebuilt from the blocks.
+ * CTIPs are derived from the deposits.
+ */
+class CSnapshotSCDB
+{
+public:
+    SidechainBlockData data;
+    std::vector<SidechainDeposit> vDeposit;
+    std::vector<SidechainSpentWithdrawal> vSpent;
+    std::vector<SidechainFailedWithdrawal> vFailed;
+    std::vector<std::pair<uint8_t, CMutableTransaction>> vWithdrawalTx;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(data);
+        READWRITE(vDeposit);
+        READWRITE(vSpent);
+        READWRITE(vFailed);
+        READWRITE(vWithdrawalTx);
+    }
+
+    uint256 GetHash() const { return SerializeHash(*this, SER_GETHASH, PROTOCOL_VERSION); }
+};
+
+/**
+ * Leads a chainstate snapshot file written by dumptxoutset. It is followed by
+ * the headers of blocks 1 to nHeight, each with its transaction count, then
+ * the CSnapshotSCDB and finally stats.nTransactionOutputs coins.
+ *
+ * stats commits to every coin through its rolling hash, and hashSCDB to the
+ * sidechain state, so a snapshot is checked against both while it is loaded.
+ * Those hashes come from the same file and only catch damage to it: a
+ * snapshot is trusted because its GetSnapshotHash() matches one the user got
+ * from a node they trust.
+ */
+class CSnapshotMetadata
+{
+public:
+    uint32_t nVersion;
+    CMessageHeader::MessageStartChars messageStart;
+    uint256 hashBase;
+    int nHeight;
+    CUTXOSetStats stats;
+    uint256 hashSCDB;
+
+    CSnapshotMetadata() : nVersion(SNAPSHOT_VERSION), nHeight(0)
+    {
+        memset(messageStart, 0, sizeof(messageStart));
+    }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(nVersion);
+        READWRITE(FLATDATA(messageStart));
+        READWRITE(hashBase);
+        READWRITE(nHeight);
+        READWRITE(stats);
+        READWRITE(hashSCDB);
+    }
+
+    /**
+     * Commits to the base block, the UTXO set and the sidechain state. Any
+     * node with the same chainstate at the same block computes the same hash.
+     */
+    uint256 GetSnapshotHash() const
+    {
+        CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
+        ss << hashBase << nHeight << stats.hashRolling << hashSCDB;
+        return ss.GetHash();
+    }
+};
+
+#endif // BITCOIN_SNAPSHOT_H
@@ -0,0 +1,97 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockcache.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <clientversion.h>
+#include <primitives/block.h>
+#include <streams.h>
+#include <validation.h>
+#include <test/test_drivechain.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(blockcache_tests, BasicTestingSetup)
+
+static std::shared_ptr<const CBlock> MakeBlock(uint32_t nNonce)
+{
+    std::shared_ptr<CBlock> block = std::make_shared<CBlock>();
+    block->nNonce = nNonce;
+    return block;
+}
+
+BOOST_AUTO_TEST_CASE(blockcache_lru)
+{
+    CBlockReadCache cache(300);
+    std::shared_ptr<const CBlock> block1 = MakeBlock(1);
+    std::shared_ptr<const CBlock> block2 = MakeBlock(2);
+    std::shared_ptr<const CBlock> block3 = MakeBlock(3);
+
+    BOOST_CHECK(!cache.Get(block1->GetHash()));
+    cache.Insert(block1, 100);
+    cache.Insert(block2, 100);
+    BOOST_CHECK_EQUAL(cache.GetCount(), 2U);
+    BOOST_CHECK_EQUAL(cache.GetTotalSize(), 200U);
+    BOOST_CHECK(cache.Get(block1->GetHash()) == block1);
+
+    // block2 is now least recently used, so it is evicted first
+    cache.Insert(block3, 150);
+    BOOST_CHECK_EQUAL(cache.GetTotalSize(), 250U);
+    BOOST_CHECK(!cache.Get(block2->GetHash()));
+    BOOST_CHECK(cache.Get(block1->GetHash()) == block1);
+    BOOST_CHECK(cache.Get(block3->GetHash()) == block3);
+    BOOST_CHECK_EQUAL(cache.GetHits(), 3U);
+    BOOST_CHECK_EQUAL(cache.GetMisses(), 2U);
+
+    // Inserting a cached block again does not count it twice
+    cache.Insert(block3, 150);
+    BOOST_CHECK_EQUAL(cache.GetTotalSize(), 250U);
+
+    // Blocks larger than the cache are not kept
+    cache.Insert(block2, 301);
+    BOOST_CHECK(!cache.Get(block2->GetHash()));
+    BOOST_CHECK_EQUAL(cache.GetCount(), 2U);
+
+    cache.SetMaxSize(150);
+    BOOST_CHECK_EQUAL(cache.GetCount(), 1U);
+    BOOST_CHECK(cache.Get(block3->GetHash()) == block3);
+
+    cache.SetMaxSize(0);
+    BOOST_CHECK_EQUAL(cache.GetCount(), 0U);
+    BOOST_CHECK_EQUAL(cache.GetTotalSize(), 0U);
+    cache.Insert(block1, 100);
+    BOOST_CHECK(!cache.Get(block1->GetHash()));
+}
+
+BOOST_FIXTURE_TEST_CASE(blockcache_read_from_disk, TestChain100Setup)
+{
+    blockReadCache.Clear();
+    const CBlockIndex* pindex;
+    {
+        LOCK(cs_main);
+        pindex = chainActive[50];
+    }
+
+    CBlock block;
+    BOOST_CHECK(ReadBlockFromDisk(block, pindex, Params().GetConsensus()));
+    BOOST_CHECK(block.GetHash() == pindex->GetBlockHash());
+
+    std::shared_ptr<const CBlock> pblock = ReadBlockFromDiskCached(pindex, Params().GetConsensus());
+    BOOST_REQUIRE(pblock);
+    CDataStream ssBlock(SER_DISK, CLIENT_VERSION);
+    CDataStream ssCached(SER_DISK, CLIENT_VERSION);
+    ssBlock << block;
+    ssCached << *pblock;
+    BOOST_CHECK(ssBlock.str() == ssCached.str());
+
+    // The second read is served from the cache
+    BOOST_CHECK(ReadBlockFromDiskCached(pindex, Params().GetConsensus()) == pblock);
+    BOOST_CHECK_EQUAL(blockReadCache.GetCount(), 1U);
+    BOOST_CHECK_EQUAL(blockReadCache.GetTotalSize(), ssBlock.size());
+    blockReadCache.Clear();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
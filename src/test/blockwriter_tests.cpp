@@ -0,0 +1,152 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <blockwriter.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <clientversion.h>
+#include <consensus/merkle.h>
+#include <fs.h>
+#include <primitives/block.h>
+#include <script/script.h>
+#include <streams.h>
+#include <validation.h>
+#include <test/test_drivechain.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(blockwriter_tests, TestingSetup)
+
+// Block files far beyond the ones used by the test chain
+static const int TEST_BLOCK_FILE = 1000;
+static const unsigned int BLOCK_HEADER_SIZE = CMessageHeader::MESSAGE_START_SIZE + sizeof(unsigned int);
+
+static std::shared_ptr<const CBlock> MakeBlock(uint32_t nNonce)
+{
+    std::shared_ptr<CBlock> block = std::make_shared<CBlock>();
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vin[0].scriptSig = CScript() << (int64_t)nNonce << OP_0;
+    coinbase.vout.resize(1);
+    coinbase.vout[0].nValue = 50 * COIN;
+    block->vtx.push_back(MakeTransactionRef(std::move(coinbase)));
+    block->hashMerkleRoot = BlockMerkleRoot(*block);
+    block->nNonce = nNonce;
+    return block;
+}
+
+static unsigned int BlockSize(const CBlock& block)
+{
+    return ::GetSerializeSize(block, SER_DISK, CLIENT_VERSION);
+}
+
+// Read a block back without going through the pending blocks of blockFileWriter
+static uint256 ReadBlockHash(const CDiskBlockPos& pos)
+{
+    unsigned int nSize = 0;
+    CAutoFile filein(OpenRawBlockFromDisk(pos, Params().MessageStart(), nSize), SER_DISK, CLIENT_VERSION);
+    BOOST_REQUIRE(!filein.IsNull());
+    CBlock block;
+    filein >> block;
+    BOOST_CHECK_EQUAL(nSize, BlockSize(block));
+    return block.GetHash();
+}
+
+BOOST_AUTO_TEST_CASE(blockwriter_out_of_order)
+{
+    CBlockFileWriter writer(1 << 20);
+    writer.Start();
+    BOOST_CHECK(writer.IsRunning());
+
+    // Reserve positions for three blocks, then hand them over in another order
+    std::vector<std::shared_ptr<const CBlock>> vBlocks{MakeBlock(1), MakeBlock(2), MakeBlock(3)};
+    std::vector<CDiskBlockPos> vPos;
+    unsigned int nFileSize = 0;
+    for (const auto& block : vBlocks) {
+        vPos.emplace_back(TEST_BLOCK_FILE, nFileSize + BLOCK_HEADER_SIZE);
+        nFileSize += BLOCK_HEADER_SIZE + BlockSize(*block);
+    }
+    for (int i : {2, 0, 1}) {
+        BOOST_CHECK(writer.Write(vBlocks[i], vPos[i], BlockSize(*vBlocks[i]), Params().MessageStart()));
+        std::shared_ptr<const CBlock> pblock = writer.Get(vPos[i]);
+        BOOST_CHECK(!pblock || pblock == vBlocks[i]);
+    }
+    // Preallocated space past the last block is cut off
+    writer.Finalize(TEST_BLOCK_FILE, nFileSize);
+    BOOST_CHECK(writer.Flush());
+    BOOST_CHECK_EQUAL(writer.GetPendingCount(), 0U);
+    BOOST_CHECK_EQUAL(writer.GetPendingSize(), 0U);
+    BOOST_CHECK(!writer.Get(vPos[0]));
+
+    for (size_t i = 0; i < vBlocks.size(); i++)
+        BOOST_CHECK(ReadBlockHash(vPos[i]) == vBlocks[i]->GetHash());
+    BOOST_CHECK_EQUAL(fs::file_size(GetBlockPosFilename(vPos[0], "blk")), nFileSize);
+
+    writer.Stop();
+    BOOST_CHECK(!writer.IsRunning());
+}
+
+BOOST_AUTO_TEST_CASE(blockwriter_synchronous)
+{
+    // Without a thread, blocks are on disk as soon as Write returns
+    CBlockFileWriter writer(1 << 20);
+    std::shared_ptr<const CBlock> block = MakeBlock(4);
+    CDiskBlockPos pos(TEST_BLOCK_FILE + 1, BLOCK_HEADER_SIZE);
+    BOOST_CHECK(writer.Write(block, pos, BlockSize(*block), Params().MessageStart()));
+    BOOST_CHECK_EQUAL(writer.GetPendingCount(), 0U);
+    BOOST_CHECK(ReadBlockHash(pos) == block->GetHash());
+    BOOST_CHECK(writer.Flush());
+}
+
+BOOST_AUTO_TEST_CASE(blockwriter_size_limit)
+{
+    // With room for a single block the writer catches up before taking the next
+    std::vector<std::shared_ptr<const CBlock>> vBlocks;
+    for (uint32_t i = 0; i < 20; i++)
+        vBlocks.push_back(MakeBlock(10 + i));
+    CBlockFileWriter writer(BlockSize(*vBlocks[0]));
+    writer.Start();
+    unsigned int nFileSize = 0;
+    std::vector<CDiskBlockPos> vPos;
+    for (const auto& block : vBlocks) {
+        vPos.emplace_back(TEST_BLOCK_FILE + 2, nFileSize + BLOCK_HEADER_SIZE);
+        nFileSize += BLOCK_HEADER_SIZE + BlockSize(*block);
+        BOOST_CHECK(writer.Write(block, vPos.back(), BlockSize(*block), Params().MessageStart()));
+        BOOST_CHECK(writer.GetPendingCount() <= 1U);
+    }
+    writer.Stop();
+    BOOST_CHECK_EQUAL(writer.GetPendingCount(), 0U);
+    for (size_t i = 0; i < vBlocks.size(); i++)
+        BOOST_CHECK(ReadBlockHash(vPos[i]) == vBlocks[i]->GetHash());
+}
+
+BOOST_FIXTURE_TEST_CASE(blockwriter_chain, TestChain100Setup)
+{
+    blockFileWriter.Start();
+    CScript scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    std::vector<CBlock> vBlocks;
+    for (int i = 0; i < 5; i++)
+        vBlocks.push_back(CreateAndProcessBlock({}, scriptPubKey));
+
+    // Connected blocks can be read back whether or not they have been written yet
+    for (const CBlock& block : vBlocks) {
+        const CBlockIndex* pindex;
+        {
+            LOCK(cs_main);
+            pindex = mapBlockIndex.at(block.GetHash());
+            BOOST_CHECK(chainActive.Contains(pindex));
+        }
+        CBlock blockRead;
+        BOOST_CHECK(ReadBlockFromDisk(blockRead, pindex, Params().GetConsensus()));
+        BOOST_CHECK(blockRead.GetHash() == block.GetHash());
+    }
+
+    FlushStateToDisk();
+    BOOST_CHECK_EQUAL(blockFileWriter.GetPendingCount(), 0U);
+    blockFileWriter.Stop();
+    BOOST_CHECK(ReadBlockHash(mapBlockIndex.at(vBlocks.back().GetHash())->GetBlockPos()) == vBlocks.back().GetHash());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
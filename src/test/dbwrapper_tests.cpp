@@ -315,6 +315,54 @@ BOOST_AUTO_TEST_CASE(iterator_string_ordering)
     }
 }
 
+BOOST_AUTO_TEST_CASE(dbwrapper_profile)
+{
+    std::string strName, strOption;
+    int nValue;
+    BOOST_CHECK(ParseDBProfileArg("chainstate:bloombits=16", strName, strOption, nValue));
+    BOOST_CHECK_EQUAL(strName, "chainstate");
+    BOOST_CHECK_EQUAL(strOption, "bloombits");
+    BOOST_CHECK_EQUAL(nValue, 16);
+    BOOST_CHECK(ParseDBProfileArg("opreturn:bloombits=0", strName, strOption, nValue));
+    BOOST_CHECK(!ParseDBProfileArg("wallet:bloombits=10", strName, strOption, nValue));
+    BOOST_CHECK(!ParseDBProfileArg("index:cachesize=1", strName, strOption, nValue));
+    BOOST_CHECK(!ParseDBProfileArg("index:compression=1", strName, strOption, nValue));
+    BOOST_CHECK(!ParseDBProfileArg("index:bloombits=65", strName, strOption, nValue));
+    BOOST_CHECK(!ParseDBProfileArg("index:maxopenfiles=ten", strName, strOption, nValue));
+    BOOST_CHECK(!ParseDBProfileArg("index=bloombits:10", strName, strOption, nValue));
+
+    gArgs.ForceSetArg("-dbprofile", "chainstate:maxopenfiles=1000");
+    BOOST_CHECK_EQUAL(GetDBProfile("chainstate").nMaxOpenFiles, 1000);
+    BOOST_CHECK_EQUAL(GetDBProfile("index").nMaxOpenFiles, CDBProfile().nMaxOpenFiles);
+    gArgs.ForceSetArg("-dbprofile", "");
+}
+
+BOOST_AUTO_TEST_CASE(dbwrapper_stats)
+{
+    fs::path ph = fs::temp_directory_path() / fs::unique_path();
+    CDBProfile profile;
+    profile.nBloomBits = 0;
+    CDBWrapper dbw(ph, (1 << 20), true, false, false, profile);
+    BOOST_CHECK_EQUAL(dbw.GetProfile().nBloomBits, 0);
 
+    for (uint32_t i = 0; i < 1000; i++)
+        BOOST_CHECK(dbw.Write(i, InsecureRand256()));
+    // Move everything out of the memtable so reads go through the block cache
+    dbw.CompactRange(uint32_t(0), uint32_t(1000));
+
+    CDBStats stats = dbw.GetStats();
+    BOOST_CHECK(!stats.vLevels.empty());
+    BOOST_CHECK_EQUAL(stats.nCacheSize, (1U << 20) / 2);
+    BOOST_CHECK_EQUAL(stats.nCacheHits + stats.nCacheMisses, 0U);
+
+    uint256 res;
+    BOOST_CHECK(dbw.Read(uint32_t(7), res));
+    BOOST_CHECK(dbw.Read(uint32_t(7), res));
+    // Memory mapped table files are read in place and never enter the cache,
+    // but every lookup is still counted
+    stats = dbw.GetStats();
+    BOOST_CHECK(stats.nCacheHits + stats.nCacheMisses >= 2);
+    BOOST_CHECK(stats.nMemoryUsage >= stats.nCacheUsage);
+}
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -571,4 +571,151 @@ BOOST_AUTO_TEST_CASE(MempoolSizeLimitTest)
     SetMockTime(0);
 }
 
+static CMutableTransaction MakeClusterTx(const std::vector<COutPoint>& vPrevout, int nOutputs)
+{
+    CMutableTransaction tx;
+    tx.vin.resize(vPrevout.size());
+    for (size_t i = 0; i < vPrevout.size(); i++) {
+        tx.vin[i].prevout = vPrevout[i];
+        tx.vin[i].scriptSig = CScript() << OP_11;
+    }
+    tx.vout.resize(nOutputs);
+    for (int i = 0; i < nOutputs; i++) {
+        tx.vout[i].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        tx.vout[i].nValue = 10 * COIN;
+    }
+    return tx;
+}
+
+BOOST_AUTO_TEST_CASE(MempoolClusterTest)
+{
+    CTxMemPool pool;
+    TestMemPoolEntryHelper entry;
+    LOCK(pool.cs);
+
+    // a -> b -> c, and d, later joined to a by e spending both
+    CMutableTransaction txA = MakeClusterTx({COutPoint(InsecureRand256(), 0)}, 2);
+    CMutableTransaction txB = MakeClusterTx({COutPoint(txA.GetHash(), 0)}, 1);
+    CMutableTransaction txC = MakeClusterTx({COutPoint(txB.GetHash(), 0)}, 1);
+    CMutableTransaction txD = MakeClusterTx({COutPoint(InsecureRand256(), 0)}, 1);
+    CMutableTransaction txE = MakeClusterTx({COutPoint(txA.GetHash(), 1), COutPoint(txD.GetHash(), 0)}, 1);
+
+    pool.addUnchecked(txA.GetHash(), entry.Fee(1000).FromTx(txA));
+    pool.addUnchecked(txB.GetHash(), entry.Fee(2000).FromTx(txB));
+    pool.addUnchecked(txC.GetHash(), entry.Fee(3000).FromTx(txC));
+    pool.addUnchecked(txD.GetHash(), entry.Fee(4000).FromTx(txD));
+
+    uint64_t nCount, nSize;
+    CAmount nFees;
+    CTxMemPool::txiter itC = pool.mapTx.find(txC.GetHash());
+    CTxMemPool::txiter itD = pool.mapTx.find(txD.GetHash());
+    pool.GetClusterStats(itC, nCount, nSize, nFees);
+    BOOST_CHECK_EQUAL(nCount, 3U);
+    BOOST_CHECK_EQUAL(nSize, itC->GetSizeWithAncestors());
+    BOOST_CHECK_EQUAL(nFees, 6000);
+    pool.GetClusterStats(itD, nCount, nSize, nFees);
+    BOOST_CHECK_EQUAL(nCount, 1U);
+    BOOST_CHECK_EQUAL(nFees, 4000);
+
+    pool.addUnchecked(txE.GetHash(), entry.Fee(5000).FromTx(txE));
+    pool.GetClusterStats(itD, nCount, nSize, nFees);
+    BOOST_CHECK_EQUAL(nCount, 5U);
+    BOOST_CHECK_EQUAL(nFees, 15000);
+
+    // The cluster bounds the ancestor limits without changing the result
+    CTxMemPool::setEntries setAncestors;
+    std::string strError;
+    BOOST_CHECK(pool.CalculateMemPoolAncestors(*pool.mapTx.find(txE.GetHash()), setAncestors, 5, 1000000, 5, 1000000, strError, false));
+    BOOST_CHECK_EQUAL(setAncestors.size(), 2U);
+    setAncestors.clear();
+    BOOST_CHECK(!pool.CalculateMemPoolAncestors(*pool.mapTx.find(txE.GetHash()), setAncestors, 5, 1000000, 3, 1000000, strError, false));
+
+    pool.PrioritiseTransaction(txC.GetHash(), 500);
+    pool.GetClusterStats(itD, nCount, nSize, nFees);
+    BOOST_CHECK_EQUAL(nFees, 15500);
+
+    // Confirming a splits the rest into b -> c and d -> e
+    pool.removeForBlock({MakeTransactionRef(txA)}, 1);
+    BOOST_CHECK_EQUAL(pool.size(), 4U);
+    pool.GetClusterStats(itC, nCount, nSize, nFees);
+    BOOST_CHECK_EQUAL(nCount, 2U);
+    BOOST_CHECK_EQUAL(nFees, 5500);
+    pool.GetClusterStats(itD, nCount, nSize, nFees);
+    BOOST_CHECK_EQUAL(nCount, 2U);
+    BOOST_CHECK_EQUAL(nFees, 9000);
+
+    // A cluster confirmed in full is removed, and the other is untouched
+    pool.removeForBlock({MakeTransactionRef(txD), MakeTransactionRef(txE)}, 2);
+    BOOST_CHECK_EQUAL(pool.size(), 2U);
+    BOOST_CHECK(pool.exists(txB.GetHash()));
+    pool.GetClusterStats(itC, nCount, nSize, nFees);
+    BOOST_CHECK_EQUAL(nCount, 2U);
+    BOOST_CHECK_EQUAL(itC->GetCountWithAncestors(), 2U);
+
+    pool.removeRecursive(txB);
+    BOOST_CHECK_EQUAL(pool.size(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(MempoolStatsTest)
+{
+    CTxMemPool pool;
+    TestMemPoolEntryHelper entry;
+    LOCK(pool.cs);
+
+    // A plain tx, a BMM request and a deposit for sidechain 3
+    CMutableTransaction txPlain = MakeClusterTx({COutPoint(InsecureRand256(), 0)}, 1);
+    CMutableTransaction txBMM = MakeClusterTx({COutPoint(InsecureRand256(), 0)}, 1);
+    txBMM.criticalData.hashCritical = InsecureRand256();
+    txBMM.criticalData.vBytes = {0x00, 0xbf, 0x00, 0x03, 0x01, 0x02, 0x03, 0x04};
+    CMutableTransaction txDeposit = MakeClusterTx({COutPoint(InsecureRand256(), 0)}, 1);
+
+    CTxMemPoolEntry entryPlain = entry.Fee(1000).FromTx(txPlain);
+    CTxMemPoolEntry entryBMM = entry.Fee(50000).FromTx(txBMM);
+    CTxMemPoolEntry entryDeposit(MakeTransactionRef(txDeposit), 2000, 0, 1, false, true /* fSidechainDeposit */, 3, 4, LockPoints());
+    pool.addUnchecked(txPlain.GetHash(), entryPlain);
+    pool.addUnchecked(txBMM.GetHash(), entryBMM);
+    pool.addUnchecked(txDeposit.GetHash(), entryDeposit);
+
+    MempoolStats stats = pool.GetStats();
+    BOOST_CHECK_EQUAL(stats.nTotalFees, 53000);
+    uint64_t nCount = 0;
+    uint64_t nSize = 0;
+    for (size_t i = 0; i < MEMPOOL_FEERATE_BUCKET_COUNT; i++) {
+        nCount += stats.vFeeRateBuckets[i].nCount;
+        nSize += stats.vFeeRateBuckets[i].nSize;
+    }
+    BOOST_CHECK_EQUAL(nCount, 3U);
+    BOOST_CHECK_EQUAL(nSize, pool.GetTotalTxSize());
+
+    // Each tx lands in the bucket containing its own fee rate
+    for (const CTxMemPoolEntry& e : {entryPlain, entryBMM, entryDeposit}) {
+        CAmount nFeeRate = CFeeRate(e.GetFee(), e.GetTxSize()).GetFeePerK();
+        size_t i = MEMPOOL_FEERATE_BUCKET_COUNT - 1;
+        while (MEMPOOL_FEERATE_BUCKETS[i] > nFeeRate) i--;
+        BOOST_CHECK(stats.vFeeRateBuckets[i].nCount > 0);
+        BOOST_CHECK(stats.vFeeRateBuckets[i].nFees >= e.GetFee());
+    }
+
+    BOOST_CHECK_EQUAL(stats.mapSidechain.size(), 1U);
+    BOOST_CHECK_EQUAL(stats.mapSidechain[3].nDeposits, 1U);
+    BOOST_CHECK_EQUAL(stats.mapSidechain[3].nBMMRequests, 1U);
+    BOOST_CHECK_EQUAL(stats.mapSidechain[3].nBMMFees, 50000);
+
+    pool.removeRecursive(txBMM);
+    stats = pool.GetStats();
+    BOOST_CHECK_EQUAL(stats.mapSidechain[3].nDeposits, 1U);
+    BOOST_CHECK_EQUAL(stats.mapSidechain[3].nBMMRequests, 0U);
+
+    // Sidechains without pending activity are dropped
+    pool.removeRecursive(txDeposit);
+    pool.removeRecursive(txPlain);
+    stats = pool.GetStats();
+    BOOST_CHECK(stats.mapSidechain.empty());
+    BOOST_CHECK_EQUAL(stats.nTotalFees, 0);
+    for (const MempoolStats::FeeRateBucket& bucket : stats.vFeeRateBuckets) {
+        BOOST_CHECK_EQUAL(bucket.nCount, 0U);
+        BOOST_CHECK_EQUAL(bucket.nSize, 0U);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -177,6 +177,35 @@ BOOST_AUTO_TEST_CASE(BlockPolicyEstimates)
     for (int i = 2; i < 9; i++) { // At 9, the original estimate was already at the bottom (b/c scale = 2)
         BOOST_CHECK(feeEst.estimateFee(i).GetFeePerK() < origFeeEst[i-1] - deltaFee);
     }
+
+    // Smart fee estimates are looked up in the table published with the last block
+    std::shared_ptr<const FeeEstimateTable> table = feeEst.GetEstimateTable();
+    BOOST_CHECK_EQUAL(table->nBestSeenHeight, (unsigned int)blocknum);
+    BOOST_CHECK(table->nMaxUsable > 2 && table->nMaxUsable <= table->nMaxTarget);
+    for (unsigned int i = 2; i <= table->nMaxUsable; i++) {
+        FeeCalculation feeCalc;
+        BOOST_CHECK(feeEst.estimateSmartFee(i, &feeCalc, true) == table->vConservative[i].feeRate);
+        BOOST_CHECK(feeCalc.reason == table->vConservative[i].reason);
+        BOOST_CHECK_EQUAL(feeCalc.returnedTarget, (int)i);
+        BOOST_CHECK(feeEst.estimateSmartFee(i, nullptr, false) == table->vEconomical[i].feeRate);
+        BOOST_CHECK(table->vEconomical[i].feeRate <= table->vConservative[i].feeRate);
+    }
+    FeeCalculation feeCalc;
+    BOOST_CHECK(feeEst.estimateSmartFee(1, &feeCalc, true) == table->vConservative[2].feeRate);
+    BOOST_CHECK_EQUAL(feeCalc.returnedTarget, 2);
+    BOOST_CHECK(feeEst.estimateSmartFee(table->nMaxTarget, &feeCalc, true) == table->vConservative[table->nMaxUsable].feeRate);
+    BOOST_CHECK_EQUAL(feeCalc.returnedTarget, (int)table->nMaxUsable);
+    BOOST_CHECK(feeEst.estimateSmartFee(table->nMaxTarget + 1, &feeCalc, true) == CFeeRate(0));
+
+    // New mempool transactions only show up in the table after the next block
+    for (int k = 0; k < 4; k++) {
+        tx.vin[0].prevout.n = 10000*blocknum+k;
+        mpool.addUnchecked(tx.GetHash(), entry.Fee(feeV[0]).Time(GetTime()).Height(blocknum).FromTx(tx));
+    }
+    BOOST_CHECK(feeEst.GetEstimateTable() == table);
+    mpool.removeForBlock(block, ++blocknum);
+    BOOST_CHECK(feeEst.GetEstimateTable() != table);
+    BOOST_CHECK_EQUAL(feeEst.GetEstimateTable()->nBestSeenHeight, (unsigned int)blocknum);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
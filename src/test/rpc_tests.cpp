@@ -8,6 +8,8 @@
 #include <base58.h>
 #include <core_io.h>
 #include <netbase.h>
+#include <streams.h>
+#include <version.h>
 
 #include <test/test_drivechain.h>
 
@@ -345,4 +347,101 @@ BOOST_AUTO_TEST_CASE(rpc_convert_values_generatetoaddress)
     BOOST_CHECK_EQUAL(result[2].get_int(), 9);
 }
 
+BOOST_AUTO_TEST_CASE(rpc_getrpcstats)
+{
+    SetRPCWarmupFinished();
+
+    JSONRPCRequest request;
+    request.strMethod = "uptime";
+    request.params = UniValue(UniValue::VARR);
+    BOOST_CHECK_NO_THROW(tableRPC.execute(request));
+    request.strMethod = "getrpcstats";
+    UniValue result;
+    BOOST_CHECK_NO_THROW(result = tableRPC.execute(request));
+
+    const UniValue& uptime = find_value(find_value(result.get_obj(), "methods").get_obj(), "uptime");
+    BOOST_CHECK(uptime.isObject());
+    BOOST_CHECK(find_value(uptime.get_obj(), "calls").get_int64() >= 1);
+    BOOST_CHECK_EQUAL(find_value(uptime.get_obj(), "errors").get_int64(), 0);
+    BOOST_CHECK_EQUAL(find_value(uptime.get_obj(), "active").get_int(), 0);
+
+    // getrpcstats is still executing while it collects the statistics
+    const UniValue& self = find_value(find_value(result.get_obj(), "methods").get_obj(), "getrpcstats");
+    BOOST_CHECK_EQUAL(find_value(self.get_obj(), "active").get_int(), 1);
+
+    // No HTTP server is running in the tests
+    BOOST_CHECK(find_value(result.get_obj(), "work_queues").get_array().empty());
+
+    // Only the first call of a batch is charged the time the batch waited
+    auto echo_wait = [&](int64_t& nCalls) {
+        const UniValue stats = find_value(find_value(tableRPC.execute(request).get_obj(), "methods").get_obj(), "echo");
+        nCalls = stats.isObject() ? find_value(stats.get_obj(), "calls").get_int64() : 0;
+        return stats.isObject() ? find_value(stats.get_obj(), "avg_wait_ms").get_real() * nCalls : 0.0;
+    };
+    int64_t nCallsBefore, nCallsAfter;
+    double nWaitBefore = echo_wait(nCallsBefore);
+    UniValue batch;
+    BOOST_CHECK(batch.read("[{\"method\":\"echo\",\"params\":[]},{\"method\":\"echo\",\"params\":[]},{\"method\":\"echo\",\"params\":[]},{\"method\":\"echo\",\"params\":[]}]"));
+    JSONRPCRequest batchRequest;
+    batchRequest.nTimeReceived = GetTimeMicros() - 4000000;
+    JSONRPCExecBatch(batchRequest, batch);
+    double nWait = echo_wait(nCallsAfter) - nWaitBefore;
+    BOOST_CHECK_EQUAL(nCallsAfter - nCallsBefore, 4);
+    BOOST_CHECK(nWait >= 4000 && nWait < 5000);
+}
+
+BOOST_AUTO_TEST_CASE(rpc_binary_serialization)
+{
+    UniValue params;
+    BOOST_CHECK(params.read("[{\"a\":[1,-2.5e3,\"x\",true,false,null,{}],\"b\":{\"c\":\"\\u00e9\"}},21000000.00000001,\"\"]"));
+
+    std::vector<BinaryRPCCall> vCall;
+    vCall.emplace_back("getblockhash", params);
+    vCall.emplace_back("getblockcount", UniValue(UniValue::VARR));
+
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << vCall;
+    std::vector<BinaryRPCCall> vDecoded;
+    ss >> vDecoded;
+    BOOST_CHECK(ss.empty());
+    BOOST_CHECK_EQUAL(vDecoded.size(), 2U);
+    BOOST_CHECK_EQUAL(vDecoded[0].strMethod, "getblockhash");
+    BOOST_CHECK_EQUAL(vDecoded[0].params.write(), params.write());
+    BOOST_CHECK_EQUAL(vDecoded[1].strMethod, "getblockcount");
+    BOOST_CHECK(vDecoded[1].params.isArray() && vDecoded[1].params.empty());
+
+    std::vector<BinaryRPCReply> vReply;
+    vReply.emplace_back(false, UniValue("00"));
+    vReply.emplace_back(true, JSONRPCError(RPC_MISC_ERROR, "error"));
+    ss << vReply;
+    std::vector<BinaryRPCReply> vReplyDecoded;
+    ss >> vReplyDecoded;
+    BOOST_CHECK_EQUAL(vReplyDecoded.size(), 2U);
+    BOOST_CHECK(!vReplyDecoded[0].fError);
+    BOOST_CHECK_EQUAL(vReplyDecoded[0].value.get_str(), "00");
+    BOOST_CHECK(vReplyDecoded[1].fError);
+    BOOST_CHECK_EQUAL(vReplyDecoded[1].value.write(), JSONRPCError(RPC_MISC_ERROR, "error").write());
+
+    // Excessive nesting is rejected
+    UniValue nested(UniValue::VARR);
+    for (unsigned int i = 0; i <= MAX_BINARY_RPC_DEPTH; i++) {
+        UniValue outer(UniValue::VARR);
+        outer.push_back(nested);
+        nested = outer;
+    }
+    ss << BinaryRPCCall("getblockcount", nested);
+    BinaryRPCCall call;
+    BOOST_CHECK_THROW(ss >> call, std::ios_base::failure);
+
+    // Numbers must be valid JSON numbers
+    ss.clear();
+    ss << std::string("getblockhash") << (uint8_t)UniValue::VNUM << std::string("0x10");
+    BOOST_CHECK_THROW(ss >> call, std::ios_base::failure);
+
+    // Unknown value types are rejected
+    ss.clear();
+    ss << std::string("getblockhash") << (uint8_t)0xff;
+    BOOST_CHECK_THROW(ss >> call, std::ios_base::failure);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
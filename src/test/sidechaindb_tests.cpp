@@ -2,6 +2,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include "blockencodings.h"
 #include "chainparams.h"
 #include "consensus/validation.h"
 #include "core_io.h"
@@ -592,4 +593,87 @@ BOOST_AUTO_TEST_CASE(txn_to_deposit)
     BOOST_CHECK(scdbTest.TxnToDeposit(mtx, 0, {}, deposit));
 }
 
+
+BOOST_AUTO_TEST_CASE(withdrawal_payout_compact_block)
+{
+    // A block that pays out a withdrawal can be reconstructed from a compact
+    // block using the payout SCDB builds from its withdrawal cache
+
+    SidechainDB scdbTest;
+
+    BOOST_CHECK(ActivateTestSidechain(scdbTest));
+
+    CScript sidechainScript;
+    BOOST_CHECK(scdbTest.GetSidechainScript(0, sidechainScript));
+
+    // Create deposit / CTIP for sidechain
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    mtx.vin[0].prevout.SetNull();
+    mtx.vout.push_back(CTxOut(CAmount(0), CScript() << OP_RETURN << ParseHex("00")));
+    mtx.vout.push_back(CTxOut(50 * CENT, sidechainScript));
+
+    SidechainDeposit deposit;
+    deposit.nSidechain = 0;
+    deposit.strDest = "";
+    deposit.tx = mtx;
+    deposit.nBurnIndex = 1;
+    deposit.nTx = 1;
+    scdbTest.AddDeposits(std::vector<SidechainDeposit>{ deposit });
+
+    SidechainCTIP ctip;
+    BOOST_CHECK(scdbTest.GetCTIP(0, ctip));
+
+    // Cache a withdrawal paying 25 CENT with 1 CENT of mainchain fees
+    CKey key;
+    key.MakeNewKey(true);
+    CMutableTransaction wmtx;
+    wmtx.nVersion = 2;
+    wmtx.vout.push_back(CTxOut(CAmount(0), CScript() << OP_RETURN << ParseHex(HexStr(SIDECHAIN_WITHDRAWAL_RETURN_DEST))));
+    wmtx.vout.push_back(CTxOut(CAmount(0), EncodeWithdrawalFees(1 * CENT)));
+    wmtx.vout.push_back(CTxOut(25 * CENT, GetScriptForDestination(key.GetPubKey().GetID())));
+    BOOST_CHECK(scdbTest.CacheWithdrawalTx(wmtx, 0));
+
+    CMutableTransaction payout;
+    CAmount nFees = 0;
+    BOOST_CHECK(!scdbTest.GetWithdrawalPayout(0, GetRandHash(), payout, nFees));
+    BOOST_CHECK(!scdbTest.GetWithdrawalPayout(1, wmtx.GetHash(), payout, nFees));
+    BOOST_CHECK(scdbTest.GetWithdrawalPayout(0, wmtx.GetHash(), payout, nFees));
+    BOOST_CHECK(nFees == 1 * CENT);
+    BOOST_CHECK(payout.vin.size() == 1 && payout.vin[0].prevout == ctip.out);
+    BOOST_CHECK(payout.vout.size() == 4);
+    BOOST_CHECK(payout.vout.back() == CTxOut(24 * CENT, sidechainScript));
+
+    std::vector<CTransactionRef> vPayout = scdbTest.GetWithdrawalPayoutCandidates();
+    BOOST_CHECK(vPayout.size() == 1 && vPayout[0]->GetHash() == payout.GetHash());
+
+    // A block with the payout, which was never relayed on its own
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vin[0].prevout.SetNull();
+    coinbase.vin[0].scriptSig = CScript() << 1 << OP_0;
+    coinbase.vout.push_back(CTxOut(50 * COIN, CScript() << OP_TRUE));
+
+    CBlock block;
+    block.nBits = 0x207fffff;
+    block.vtx.push_back(MakeTransactionRef(coinbase));
+    block.vtx.push_back(MakeTransactionRef(payout));
+
+    CBlockHeaderAndShortTxIDs cmpctblock(block, true);
+
+    PartiallyDownloadedBlock partialMissing(&mempool);
+    BOOST_CHECK(partialMissing.InitData(cmpctblock, {}) == READ_STATUS_OK);
+    BOOST_CHECK(!partialMissing.IsTxAvailable(1));
+
+    std::vector<std::pair<uint256, CTransactionRef>> vExtraTxn;
+    for (const CTransactionRef& tx : vPayout)
+        vExtraTxn.emplace_back(tx->GetWitnessHash(), tx);
+
+    PartiallyDownloadedBlock partialBlock(&mempool);
+    BOOST_CHECK(partialBlock.InitData(cmpctblock, vExtraTxn) == READ_STATUS_OK);
+    BOOST_CHECK(partialBlock.IsTxAvailable(0));
+    BOOST_CHECK(partialBlock.IsTxAvailable(1));
+    BOOST_CHECK_EQUAL(partialBlock.GetExtraCount(), 1U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
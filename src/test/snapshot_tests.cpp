@@ -0,0 +1,203 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <snapshot.h>
+
+#include <chain.h>
+#include <chainparams.h>
+#include <clientversion.h>
+#include <coins.h>
+#include <consensus/validation.h>
+#include <fs.h>
+#include <key.h>
+#include <script/interpreter.h>
+#include <sidechaindb.h>
+#include <streams.h>
+#include <txdb.h>
+#include <validation.h>
+#include <test/test_drivechain.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(snapshot_tests, TestChain100Setup)
+
+// Throw away the chainstate and block index, leaving only the genesis block
+static void ResetChainstate()
+{
+    UnloadBlockIndex();
+    pcoinsTip.reset();
+    pcoinsdbview.reset(new CCoinsViewDB(1 << 23, true));
+    pcoinsTip.reset(new CCoinsViewCache(pcoinsdbview.get()));
+    pblocktree.reset(new CBlockTreeDB(1 << 20, true));
+    psidechaintree.reset(new CSidechainTreeDB(1 << 20, true));
+    popreturndb.reset(new OPReturnDB(1 << 20, true));
+    scdb.Reset();
+    BOOST_REQUIRE(LoadGenesisBlock(Params()));
+    CValidationState state;
+    BOOST_REQUIRE(ActivateBestChain(state, Params()));
+}
+
+static CMutableTransaction SpendCoinbase(const CTransaction& coinbase, const CKey& key)
+{
+    CScript scriptPubKey = CScript() << ToByteVector(key.GetPubKey()) << OP_CHECKSIG;
+    CMutableTransaction spend;
+    spend.nVersion = 1;
+    spend.vin.resize(1);
+    spend.vin[0].prevout = COutPoint(coinbase.GetHash(), 0);
+    spend.vout.resize(2);
+    spend.vout[0].nValue = 11 * CENT;
+    spend.vout[0].scriptPubKey = scriptPubKey;
+    spend.vout[1].nValue = 12 * CENT;
+    spend.vout[1].scriptPubKey = scriptPubKey;
+    std::vector<unsigned char> vchSig;
+    uint256 hash = SignatureHash(scriptPubKey, spend, 0, SIGHASH_ALL, 0, SIGVERSION_BASE);
+    BOOST_CHECK(key.Sign(hash, vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    spend.vin[0].scriptSig << vchSig;
+    return spend;
+}
+
+/**
+ * Copy the snapshot at path to pathOut with the value of its last coin raised
+ * by nDelta, and its UTXO set hash recomputed to match.
+ */
+static void WriteTamperedSnapshot(const fs::path& path, const fs::path& pathOut, CAmount nDelta)
+{
+    CAutoFile filein(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+    CAutoFile fileout(fsbridge::fopen(pathOut, "wb"), SER_DISK, CLIENT_VERSION);
+    BOOST_REQUIRE(!filein.IsNull() && !fileout.IsNull());
+    CSnapshotMetadata metadata;
+    filein >> metadata;
+    std::vector<std::pair<CBlockHeader, unsigned int>> vHeader(metadata.nHeight);
+    for (auto& header : vHeader)
+        filein >> header.first >> VARINT(header.second);
+    CSnapshotSCDB scdbSnapshot;
+    filein >> scdbSnapshot;
+    std::vector<std::pair<COutPoint, Coin>> vCoin(metadata.stats.nTransactionOutputs);
+    for (auto& coin : vCoin)
+        filein >> coin.first >> coin.second;
+
+    vCoin.back().second.out.nValue += nDelta;
+    CUTXOSetStats stats;
+    for (const auto& coin : vCoin)
+        stats.AddCoin(coin.first, coin.second);
+    stats.hashBlock = metadata.hashBase;
+    metadata.stats = stats;
+
+    fileout << metadata;
+    for (const auto& header : vHeader)
+        fileout << header.first << VARINT(header.second);
+    fileout << scdbSnapshot;
+    for (const auto& coin : vCoin)
+        fileout << coin.first << coin.second;
+}
+
+BOOST_AUTO_TEST_CASE(snapshot_dump_and_load)
+{
+    CScript scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    CBlock blockBase = CreateAndProcessBlock({SpendCoinbase(coinbaseTxns[0], coinbaseKey)}, scriptPubKey);
+    CUTXOSetStats stats;
+    BOOST_REQUIRE(GetUTXOSetStats(stats));
+
+    fs::path path = pathTemp / "snapshot.dat";
+    CSnapshotMetadata metadata;
+    BOOST_REQUIRE(DumpChainstateSnapshot(path, metadata));
+    BOOST_CHECK(metadata.hashBase == blockBase.GetHash());
+    BOOST_CHECK_EQUAL(metadata.nHeight, 101);
+    BOOST_CHECK(metadata.stats == stats);
+    BOOST_CHECK(!fs::exists(path.string() + ".incomplete"));
+
+    // The file holds the headers of the active chain and every coin
+    {
+        CAutoFile filein(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+        BOOST_REQUIRE(!filein.IsNull());
+        CSnapshotMetadata metadataRead;
+        filein >> metadataRead;
+        BOOST_CHECK(metadataRead.hashBase == metadata.hashBase);
+        uint256 hashPrev = Params().GenesisBlock().GetHash();
+        for (int nHeight = 1; nHeight <= metadataRead.nHeight; nHeight++) {
+            CBlockHeader header;
+            unsigned int nTx;
+            filein >> header >> VARINT(nTx);
+            BOOST_CHECK(header.hashPrevBlock == hashPrev);
+            BOOST_CHECK_EQUAL(nTx, nHeight == 101 ? 2U : 1U);
+            hashPrev = header.GetHash();
+        }
+        BOOST_CHECK(hashPrev == metadata.hashBase);
+        CSnapshotSCDB scdbSnapshot;
+        filein >> scdbSnapshot;
+        BOOST_CHECK(scdbSnapshot.GetHash() == metadataRead.hashSCDB);
+        CUTXOSetStats statsRead;
+        for (uint64_t i = 0; i < metadataRead.stats.nTransactionOutputs; i++) {
+            COutPoint outpoint;
+            Coin coin;
+            filein >> outpoint >> coin;
+            statsRead.AddCoin(outpoint, coin);
+        }
+        statsRead.hashBlock = metadataRead.hashBase;
+        BOOST_CHECK(statsRead == metadata.stats);
+    }
+
+    // Only an empty chainstate can be replaced
+    const uint256 hashSnapshot = metadata.GetSnapshotHash();
+    BOOST_CHECK(!LoadChainstateSnapshot(path, hashSnapshot, Params()));
+    BOOST_CHECK(chainActive.Tip()->GetBlockHash() == blockBase.GetHash());
+
+    // A damaged snapshot no longer matches its own UTXO set hash. This only
+    // detects corruption: anyone can write a file that matches.
+    fs::path pathCorrupt = pathTemp / "snapshot_corrupt.dat";
+    {
+        CAutoFile filein(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+        std::vector<char> vData(fs::file_size(path));
+        filein.read(vData.data(), vData.size());
+        vData[vData.size() - 10] ^= 1;
+        CAutoFile fileout(fsbridge::fopen(pathCorrupt, "wb"), SER_DISK, CLIENT_VERSION);
+        fileout.write(vData.data(), vData.size());
+    }
+    ResetChainstate();
+    BOOST_CHECK(!LoadChainstateSnapshot(pathCorrupt, hashSnapshot, Params()));
+    BOOST_CHECK_EQUAL(chainActive.Height(), 0);
+
+    // A snapshot that was altered consistently passes its own checks, and is
+    // only rejected because it does not match the snapshot hash given
+    fs::path pathTampered = pathTemp / "snapshot_tampered.dat";
+    WriteTamperedSnapshot(path, pathTampered, COIN);
+    BOOST_CHECK(!LoadChainstateSnapshot(pathTampered, hashSnapshot, Params()));
+    BOOST_CHECK_EQUAL(chainActive.Height(), 0);
+    BOOST_CHECK(!LoadChainstateSnapshot(path, uint256(), Params()));
+    BOOST_CHECK_EQUAL(chainActive.Height(), 0);
+    CSnapshotMetadata metadataTampered;
+    {
+        CAutoFile filein(fsbridge::fopen(pathTampered, "rb"), SER_DISK, CLIENT_VERSION);
+        filein >> metadataTampered;
+    }
+    BOOST_CHECK(metadataTampered.GetSnapshotHash() != hashSnapshot);
+    BOOST_CHECK(LoadChainstateSnapshot(pathTampered, metadataTampered.GetSnapshotHash(), Params()));
+    ResetChainstate();
+
+    BOOST_REQUIRE(LoadChainstateSnapshot(path, hashSnapshot, Params()));
+    BOOST_CHECK(chainActive.Tip()->GetBlockHash() == blockBase.GetHash());
+    BOOST_CHECK(pcoinsdbview->GetBestBlock() == blockBase.GetHash());
+    CUTXOSetStats statsLoaded;
+    BOOST_REQUIRE(GetUTXOSetStats(statsLoaded));
+    BOOST_CHECK(statsLoaded == stats);
+    BOOST_CHECK(pcoinsdbview->ReadUTXOSetStats(statsLoaded));
+    BOOST_CHECK(statsLoaded == stats);
+    BOOST_CHECK(scdb.GetHashBlockLastSeen() == blockBase.GetHash());
+
+    // Blocks below the snapshot are known, but their data is not
+    BOOST_CHECK(fHavePruned);
+    BOOST_CHECK_EQUAL(chainActive.Tip()->nChainTx, 103U);
+    BOOST_CHECK(!(chainActive.Tip()->nStatus & BLOCK_HAVE_DATA));
+    CBlock block;
+    BOOST_CHECK(!ReadBlockFromDisk(block, chainActive.Tip(), Params().GetConsensus()));
+
+    // New blocks connect on top of the snapshot
+    CBlock blockNext = CreateAndProcessBlock({SpendCoinbase(coinbaseTxns[1], coinbaseKey)}, scriptPubKey);
+    BOOST_CHECK(chainActive.Tip()->GetBlockHash() == blockNext.GetHash());
+    BOOST_CHECK_EQUAL(chainActive.Height(), 102);
+    BOOST_CHECK_EQUAL(chainActive.Tip()->nChainTx, 105U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
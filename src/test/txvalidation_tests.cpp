@@ -5,14 +5,24 @@
 #include <validation.h>
 #include <txmempool.h>
 #include <amount.h>
+#include <clientversion.h>
 #include <consensus/validation.h>
+#include <fs.h>
+#include <hash.h>
+#include <key.h>
 #include <primitives/transaction.h>
+#include <script/interpreter.h>
 #include <script/script.h>
+#include <streams.h>
 #include <test/test_drivechain.h>
+#include <uint256.h>
+#include <util.h>
 
 #include <boost/test/unit_test.hpp>
 
 
+bool CheckInputs(const CTransaction& tx, CValidationState &state, const CCoinsViewCache &inputs, bool fScriptChecks, unsigned int flags, bool cacheSigStore, bool cacheFullScriptStore, PrecomputedTransactionData& txdata, std::vector<CScriptCheck> *pvChecks);
+
 BOOST_AUTO_TEST_SUITE(txvalidation_tests)
 
 /**
@@ -58,4 +68,149 @@ BOOST_FIXTURE_TEST_CASE(tx_mempool_reject_coinbase, TestChain100Setup)
     BOOST_CHECK_EQUAL(nDoS, 100);
 }
 
+/** Spend prevout, which pays to key, back to key. If fSign is false the signature is invalid. */
+static CTransactionRef SpendToKey(const CKey& key, const COutPoint& prevout, CAmount nValue, bool fSign)
+{
+    CScript scriptPubKey = CScript() << ToByteVector(key.GetPubKey()) << OP_CHECKSIG;
+    CMutableTransaction tx;
+    tx.nVersion = 1;
+    tx.vin.resize(1);
+    tx.vin[0].prevout = prevout;
+    tx.vout.resize(1);
+    tx.vout[0].nValue = nValue;
+    tx.vout[0].scriptPubKey = scriptPubKey;
+    std::vector<unsigned char> vchSig;
+    uint256 hash = SignatureHash(scriptPubKey, tx, 0, SIGHASH_ALL, 0, SIGVERSION_BASE);
+    BOOST_CHECK(key.Sign(hash, vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    if (!fSign)
+        vchSig[10] ^= 1;
+    tx.vin[0].scriptSig << vchSig;
+    return MakeTransactionRef(tx);
+}
+
+/**
+ * Ensure that a batch is accepted in order, parents before children, and
+ * that each transaction gets its own result.
+ */
+BOOST_FIXTURE_TEST_CASE(tx_mempool_accept_batch, TestChain100Setup)
+{
+    auto spend = [&](const COutPoint& prevout, CAmount nValue, bool fSign) {
+        return SpendToKey(coinbaseKey, prevout, nValue, fSign);
+    };
+
+    CTransactionRef txParent = spend(COutPoint(coinbaseTxns[0].GetHash(), 0), 11 * CENT, true);
+    CTransactionRef txChild = spend(COutPoint(txParent->GetHash(), 0), 10 * CENT, true);
+    CTransactionRef txBadSig = spend(COutPoint(coinbaseTxns[1].GetHash(), 0), 11 * CENT, false);
+    CTransactionRef txOrphan = spend(COutPoint(uint256S("01"), 0), 1 * CENT, true);
+
+    unsigned int initialPoolSize = mempool.size();
+    std::vector<CValidationState> vState;
+    AcceptToMemoryPoolBatch(mempool, {txParent, txChild, txBadSig, txOrphan}, {}, true /* bypass_limits */, vState);
+
+    BOOST_REQUIRE_EQUAL(vState.size(), 4U);
+    BOOST_CHECK(vState[0].IsValid());
+    BOOST_CHECK(vState[1].IsValid());
+    BOOST_CHECK(vState[2].IsInvalid());
+    BOOST_CHECK(vState[3].IsInvalid());
+    BOOST_CHECK_EQUAL(mempool.size(), initialPoolSize + 2);
+    BOOST_CHECK(mempool.exists(txChild->GetHash()));
+
+    // A snapshot taken at this tip is loaded back in full
+    BOOST_CHECK(DumpMempool());
+    mempool.clear();
+    BOOST_CHECK(LoadMempool());
+    BOOST_CHECK_EQUAL(mempool.size(), initialPoolSize + 2);
+    BOOST_CHECK(mempool.exists(txParent->GetHash()));
+    BOOST_CHECK(mempool.exists(txChild->GetHash()));
+    mempool.clear();
+}
+
+/** Write a version 2 mempool.dat holding vtx, as DumpMempool would */
+static void WriteMempoolSnapshot(const uint256& hashTip, unsigned int nStandardFlags, unsigned int nBlockFlags,
+                                 const std::vector<CTransactionRef>& vtx, bool fCorrupt)
+{
+    CAutoFile file(fsbridge::fopen(GetDataDir() / "mempool.dat", "wb"), SER_DISK, CLIENT_VERSION);
+    BOOST_REQUIRE(!file.IsNull());
+    file << (uint64_t)2;
+    CHashedWriter<CAutoFile> writer(&file);
+    writer << hashTip << nStandardFlags << nBlockFlags;
+    writer << (uint64_t)vtx.size();
+    for (const CTransactionRef& tx : vtx)
+        writer << *tx << (int64_t)GetTime() << (int64_t)0;
+    writer << std::map<uint256, CAmount>();
+    uint256 hash = writer.GetHash();
+    if (fCorrupt)
+        *hash.begin() ^= 1;
+    file << hash;
+}
+
+/**
+ * Ensure that a mempool snapshot taken at the current tip with the current
+ * script flags has its scripts checked after loading, leaving them cached for
+ * block validation, and that a corrupted snapshot is not loaded.
+ */
+BOOST_FIXTURE_TEST_CASE(tx_mempool_snapshot, TestChain100Setup)
+{
+    // Mature a second coinbase output
+    CreateAndProcessBlock({}, CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG);
+
+    // Take the tip and flags from a snapshot of the empty mempool
+    mempool.clear();
+    BOOST_REQUIRE(DumpMempool());
+    uint256 hashTip;
+    unsigned int nStandardFlags;
+    unsigned int nBlockFlags;
+    {
+        CAutoFile file(fsbridge::fopen(GetDataDir() / "mempool.dat", "rb"), SER_DISK, CLIENT_VERSION);
+        uint64_t version;
+        file >> version >> hashTip >> nStandardFlags >> nBlockFlags;
+        BOOST_CHECK_EQUAL(version, 2U);
+    }
+    BOOST_CHECK(hashTip == chainActive.Tip()->GetBlockHash());
+
+    // Only the script of txBadSig is invalid, so it must never stay loaded
+    CTransactionRef txGood = SpendToKey(coinbaseKey, COutPoint(coinbaseTxns[0].GetHash(), 0), 11 * CENT, true);
+    CTransactionRef txBadSig = SpendToKey(coinbaseKey, COutPoint(coinbaseTxns[1].GetHash(), 0), 11 * CENT, false);
+
+    WriteMempoolSnapshot(hashTip, nStandardFlags, nBlockFlags, {txGood, txBadSig}, false);
+    BOOST_CHECK(LoadMempool());
+    BOOST_CHECK(mempool.exists(txGood->GetHash()));
+    BOOST_CHECK(!mempool.exists(txBadSig->GetHash()));
+    {
+        // A block spending txGood's inputs would need no script checks
+        LOCK(cs_main);
+        PrecomputedTransactionData txdata(*txGood);
+        CValidationState state;
+        std::vector<CScriptCheck> vChecks;
+        BOOST_CHECK(CheckInputs(*txGood, state, *pcoinsTip, true, nBlockFlags, true, true, txdata, &vChecks));
+        BOOST_CHECK(vChecks.empty());
+    }
+    mempool.clear();
+
+    // Another tip, or other flags, mean full validation
+    WriteMempoolSnapshot(uint256S("01"), nStandardFlags, nBlockFlags, {txGood, txBadSig}, false);
+    BOOST_CHECK(LoadMempool());
+    BOOST_CHECK(mempool.exists(txGood->GetHash()));
+    BOOST_CHECK(!mempool.exists(txBadSig->GetHash()));
+    mempool.clear();
+
+    WriteMempoolSnapshot(hashTip, nStandardFlags ^ SCRIPT_VERIFY_NULLFAIL, nBlockFlags, {txGood, txBadSig}, false);
+    BOOST_CHECK(LoadMempool());
+    BOOST_CHECK(mempool.exists(txGood->GetHash()));
+    BOOST_CHECK(!mempool.exists(txBadSig->GetHash()));
+    mempool.clear();
+
+    WriteMempoolSnapshot(hashTip, nStandardFlags, nBlockFlags ^ SCRIPT_VERIFY_DERSIG, {txGood, txBadSig}, false);
+    BOOST_CHECK(LoadMempool());
+    BOOST_CHECK(mempool.exists(txGood->GetHash()));
+    BOOST_CHECK(!mempool.exists(txBadSig->GetHash()));
+    mempool.clear();
+
+    // Nothing of a snapshot that fails its checksum is loaded
+    WriteMempoolSnapshot(hashTip, nStandardFlags, nBlockFlags, {txGood, txBadSig}, true);
+    BOOST_CHECK(!LoadMempool());
+    BOOST_CHECK_EQUAL(mempool.size(), 0U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -11,6 +11,7 @@
 #include <random.h>
 #include <script/standard.h>
 #include <script/sign.h>
+#include <script/sigcache.h>
 #include <test/test_drivechain.h>
 #include <utiltime.h>
 #include <core_io.h>
@@ -91,6 +92,40 @@ BOOST_FIXTURE_TEST_CASE(tx_mempool_block_doublespend, TestChain100Setup)
     BOOST_CHECK_EQUAL(mempool.size(), 0);
 }
 
+BOOST_FIXTURE_TEST_CASE(validation_cache_stats, TestChain100Setup)
+{
+    CScript scriptPubKey = CScript() <<  ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    CMutableTransaction spend;
+    spend.nVersion = 1;
+    spend.vin.resize(1);
+    spend.vin[0].prevout.hash = coinbaseTxns[0].GetHash();
+    spend.vin[0].prevout.n = 0;
+    spend.vout.resize(1);
+    spend.vout[0].nValue = 11*CENT;
+    spend.vout[0].scriptPubKey = scriptPubKey;
+    std::vector<unsigned char> vchSig;
+    uint256 hash = SignatureHash(scriptPubKey, spend, 0, SIGHASH_ALL, 0, SIGVERSION_BASE);
+    BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    spend.vin[0].scriptSig << vchSig;
+
+    BOOST_CHECK(GetSignatureCacheStats().nCapacity > 0);
+    BOOST_CHECK(GetScriptExecutionCacheStats().nCapacity > 0);
+
+    // The mempool verifies the signature and stores the result
+    CacheStats sigStats = GetSignatureCacheStats();
+    BOOST_CHECK(ToMemPool(spend));
+    BOOST_CHECK(GetSignatureCacheStats().nMisses > sigStats.nMisses);
+
+    // The block then skips the transaction's scripts entirely
+    CacheStats scriptStats = GetScriptExecutionCacheStats();
+    sigStats = GetSignatureCacheStats();
+    CBlock block = CreateAndProcessBlock({spend}, scriptPubKey);
+    BOOST_CHECK(chainActive.Tip()->GetBlockHash() == block.GetHash());
+    BOOST_CHECK(GetScriptExecutionCacheStats().nHits > scriptStats.nHits);
+    BOOST_CHECK_EQUAL(GetSignatureCacheStats().nMisses, sigStats.nMisses);
+}
+
 // Run CheckInputs (using pcoinsTip) on the given transaction, for all script
 // flags.  Test that CheckInputs passes for all flags that don't overlap with
 // the failing_flags argument, but otherwise fails.
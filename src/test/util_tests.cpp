@@ -603,4 +603,30 @@ BOOST_AUTO_TEST_CASE(test_ParseFixedPoint)
     BOOST_CHECK(!ParseFixedPoint("1.", 8, &amount));
 }
 
+BOOST_AUTO_TEST_CASE(test_ParallelForRanges)
+{
+    for (int nThreads : {0, 1, 3, 8}) {
+        for (size_t nSize : {0, 1, 2, 7, 100}) {
+            std::vector<int> vCount(nSize, 0);
+            BOOST_CHECK(ParallelForRanges(nSize, nThreads, [&](size_t nBegin, size_t nEnd) {
+                for (size_t i = nBegin; i < nEnd; i++)
+                    vCount[i]++;
+                return true;
+            }));
+            for (int n : vCount)
+                BOOST_CHECK_EQUAL(n, 1);
+        }
+    }
+
+    // Failures and exceptions in any chunk are reported
+    BOOST_CHECK(!ParallelForRanges(100, 4, [](size_t nBegin, size_t nEnd) {
+        return !(nBegin <= 60 && 60 < nEnd);
+    }));
+    BOOST_CHECK(!ParallelForRanges(100, 4, [](size_t nBegin, size_t nEnd) -> bool {
+        if (nBegin <= 99 && 99 < nEnd)
+            throw std::runtime_error("fail");
+        return true;
+    }));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
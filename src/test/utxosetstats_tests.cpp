@@ -0,0 +1,179 @@
+// Copyright (c) 2022 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chain.h>
+#include <chainparams.h>
+#include <coins.h>
+#include <consensus/validation.h>
+#include <key.h>
+#include <script/interpreter.h>
+#include <txdb.h>
+#include <validation.h>
+#include <test/test_drivechain.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(utxosetstats_tests, BasicTestingSetup)
+
+// Recompute the statistics by walking the coins database
+static CUTXOSetStats ComputeUTXOSetStats()
+{
+    FlushStateToDisk();
+    CUTXOSetStats stats;
+    std::unique_ptr<CCoinsViewCursor> pcursor(pcoinsdbview->Cursor());
+    while (pcursor->Valid()) {
+        COutPoint key;
+        Coin coin;
+        BOOST_REQUIRE(pcursor->GetKey(key) && pcursor->GetValue(coin));
+        stats.AddCoin(key, coin);
+        pcursor->Next();
+    }
+    stats.hashBlock = pcoinsdbview->GetBestBlock();
+    return stats;
+}
+
+BOOST_AUTO_TEST_CASE(utxosetstats_rolling)
+{
+    COutPoint outpointA(InsecureRand256(), 0);
+    COutPoint outpointB(InsecureRand256(), 3);
+    CScript scriptSidechain;
+    scriptSidechain.resize(2);
+    scriptSidechain[0] = OP_DRIVECHAIN;
+    scriptSidechain[1] = 2;
+    Coin coinA(CTxOut(5 * COIN, CScript() << OP_TRUE), 10, false);
+    Coin coinB(CTxOut(7 * COIN, scriptSidechain), 11, false);
+
+    // Insertion order does not matter
+    CUTXOSetStats statsAB;
+    statsAB.AddCoin(outpointA, coinA);
+    statsAB.AddCoin(outpointB, coinB);
+    CUTXOSetStats statsBA;
+    statsBA.AddCoin(outpointB, coinB);
+    statsBA.AddCoin(outpointA, coinA);
+    BOOST_CHECK(statsAB == statsBA);
+    BOOST_CHECK(!statsAB.hashRolling.IsNull());
+    BOOST_CHECK_EQUAL(statsAB.nTransactionOutputs, 2U);
+    BOOST_CHECK_EQUAL(statsAB.nTotalAmount, 12 * COIN);
+
+    // Only outputs locked to a sidechain count towards it
+    uint8_t nSidechain;
+    BOOST_REQUIRE(coinB.out.scriptPubKey.IsDrivechain(nSidechain));
+    BOOST_CHECK_EQUAL(statsAB.mapSidechainAmount.size(), 1U);
+    BOOST_CHECK_EQUAL(statsAB.mapSidechainAmount[nSidechain], 7 * COIN);
+
+    // Any change to a coin changes the hash
+    CUTXOSetStats statsHeight;
+    statsHeight.AddCoin(outpointA, Coin(coinA.out, 12, false));
+    statsHeight.AddCoin(outpointB, coinB);
+    BOOST_CHECK(statsHeight.hashRolling != statsAB.hashRolling);
+
+    // Removing every coin again gives the empty set
+    statsAB.RemoveCoin(outpointA, coinA);
+    statsAB.RemoveCoin(outpointB, coinB);
+    BOOST_CHECK(statsAB == CUTXOSetStats());
+}
+
+BOOST_FIXTURE_TEST_CASE(utxosetstats_chain, TestChain100Setup)
+{
+    CUTXOSetStats stats;
+    BOOST_REQUIRE(GetUTXOSetStats(stats));
+    BOOST_CHECK(stats.hashBlock == chainActive.Tip()->GetBlockHash());
+    BOOST_CHECK(stats == ComputeUTXOSetStats());
+
+    // The statistics are stored with the best block
+    CUTXOSetStats statsStored;
+    BOOST_CHECK(pcoinsdbview->ReadUTXOSetStats(statsStored));
+    BOOST_CHECK(statsStored == stats);
+
+    // Spend a coinbase output
+    CScript scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    CMutableTransaction spend;
+    spend.nVersion = 1;
+    spend.vin.resize(1);
+    spend.vin[0].prevout = COutPoint(coinbaseTxns[0].GetHash(), 0);
+    spend.vout.resize(2);
+    spend.vout[0].nValue = 11 * CENT;
+    spend.vout[0].scriptPubKey = scriptPubKey;
+    spend.vout[1].nValue = 12 * CENT;
+    spend.vout[1].scriptPubKey = scriptPubKey;
+    std::vector<unsigned char> vchSig;
+    uint256 hash = SignatureHash(scriptPubKey, spend, 0, SIGHASH_ALL, 0, SIGVERSION_BASE);
+    BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    spend.vin[0].scriptSig << vchSig;
+
+    CBlock block = CreateAndProcessBlock({spend}, scriptPubKey);
+    BOOST_REQUIRE(chainActive.Tip()->GetBlockHash() == block.GetHash());
+    CUTXOSetStats statsSpent;
+    BOOST_REQUIRE(GetUTXOSetStats(statsSpent));
+    BOOST_CHECK(statsSpent.hashBlock == block.GetHash());
+    BOOST_CHECK(statsSpent.hashRolling != stats.hashRolling);
+    BOOST_CHECK(statsSpent == ComputeUTXOSetStats());
+
+    // Disconnecting the block restores the previous statistics
+    CValidationState state;
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(InvalidateBlock(state, Params(), chainActive.Tip()));
+    }
+    CUTXOSetStats statsReverted;
+    BOOST_REQUIRE(GetUTXOSetStats(statsReverted));
+    BOOST_CHECK(statsReverted == stats);
+    BOOST_CHECK(statsReverted == ComputeUTXOSetStats());
+}
+
+BOOST_FIXTURE_TEST_CASE(utxosetstats_sharded_cursor, TestingSetup)
+{
+    CCoinsViewDB db(1 << 23, true, true);
+    std::map<COutPoint, Coin> mapExpected;
+    {
+        CCoinsViewCache cache(&db);
+        for (int i = 0; i < 1000; i++) {
+            COutPoint outpoint(InsecureRand256(), InsecureRandRange(4));
+            Coin coin(CTxOut(InsecureRandRange(1000) + 1, CScript() << OP_TRUE), 1 + InsecureRandRange(500), InsecureRandBool());
+            cache.AddCoin(outpoint, Coin(coin), false);
+            mapExpected.emplace(outpoint, std::move(coin));
+        }
+        cache.SetBestBlock(InsecureRand256());
+        BOOST_REQUIRE(cache.Flush());
+    }
+
+    for (unsigned int nShards : {1, 3, 16, 256, 1000}) {
+        // Shards run concurrently, so only collect results inside the callback
+        std::vector<std::vector<std::pair<COutPoint, Coin>>> vShards(std::min(nShards, 256U));
+        uint256 hashBlock;
+        BOOST_CHECK(db.ForEachCoinSharded(nShards, [&](unsigned int nShard, const COutPoint& outpoint, const Coin& coin) {
+            vShards.at(nShard).emplace_back(outpoint, coin);
+            return true;
+        }, hashBlock));
+        BOOST_CHECK(hashBlock == db.GetBestBlock());
+
+        // Shards cover disjoint ranges that together give the whole set
+        size_t nFound = 0;
+        for (const auto& shard : vShards) {
+            for (const auto& item : shard) {
+                auto it = mapExpected.find(item.first);
+                BOOST_REQUIRE(it != mapExpected.end());
+                BOOST_CHECK(it->second.out == item.second.out);
+                BOOST_CHECK_EQUAL((int)it->second.nHeight, (int)item.second.nHeight);
+                BOOST_CHECK_EQUAL((bool)it->second.fCoinBase, (bool)item.second.fCoinBase);
+                nFound++;
+            }
+        }
+        BOOST_CHECK_EQUAL(nFound, mapExpected.size());
+    }
+
+    // The scan stops when the callback asks for it
+    uint256 hashBlock;
+    BOOST_CHECK(!db.ForEachCoinSharded(4, [](unsigned int, const COutPoint&, const Coin&) { return false; }, hashBlock));
+
+    // A database without a best block, as while a flush is being written, is not scanned
+    CCoinsViewDB dbEmpty(1 << 20, true, true);
+    bool fCalled = false;
+    BOOST_CHECK(!dbEmpty.ForEachCoinSharded(4, [&](unsigned int, const COutPoint&, const Coin&) { fCalled = true; return true; }, hashBlock));
+    BOOST_CHECK(hashBlock.IsNull());
+    BOOST_CHECK(!fCalled);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -21,6 +21,9 @@
 
 #include <stdint.h>
 
+#include <atomic>
+#include <thread>
+
 #include <boost/thread.hpp>
 
 static const char DB_COIN = 'C';
@@ -31,6 +34,7 @@ static const char DB_BLOCK_INDEX = 'b';
 
 static const char DB_BEST_BLOCK = 'B';
 static const char DB_HEAD_BLOCKS = 'H';
+static const char DB_UTXO_STATS = 'S';
 static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
@@ -62,7 +66,7 @@ struct CoinEntry {
 
 }
 
-CCoinsViewDB::CCoinsViewDB(size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / "chainstate", nCacheSize / 2, fMemory, fWipe, true)
+CCoinsViewDB::CCoinsViewDB(size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / "chainstate", nCacheSize / 2, fMemory, fWipe, true, GetDBProfile("chainstate"))
 {
 }
 
@@ -95,6 +99,14 @@ std::vector<uint256> CCoinsViewDB::GetHeadBlocks() const {
     return vhashHeadBlocks;
 }
 
+bool CCoinsViewDB::ReadUTXOSetStats(CUTXOSetStats& stats) const {
+    return db.Read(DB_UTXO_STATS, stats);
+}
+
+void CCoinsViewDB::SetUTXOSetStats(const CUTXOSetStats& stats) {
+    pendingStats = stats;
+}
+
 bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
     CDBBatch batch(db);
     size_t count = 0;
@@ -149,6 +161,10 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
     // In the last batch, mark the database as consistent with hashBlock again.
     batch.Erase(DB_HEAD_BLOCKS);
     batch.Write(DB_BEST_BLOCK, hashBlock);
+    if (pendingStats.hashBlock == hashBlock)
+        batch.Write(DB_UTXO_STATS, pendingStats);
+    else
+        batch.Erase(DB_UTXO_STATS);
 
     LogPrint(BCLog::COINDB, "Writing final batch of %.2f MiB\n", batch.SizeEstimate() * (1.0 / 1048576.0));
     bool ret = db.WriteBatch(batch);
@@ -156,12 +172,17 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
     return ret;
 }
 
+CDBStats CCoinsViewDB::GetDBStats() const
+{
+    return db.GetStats();
+}
+
 size_t CCoinsViewDB::EstimateSize() const
 {
     return db.EstimateSize(DB_COIN, (char)(DB_COIN+1));
 }
 
-CBlockTreeDB::CBlockTreeDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "blocks" / "index", nCacheSize, fMemory, fWipe) {
+CBlockTreeDB::CBlockTreeDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "blocks" / "index", nCacheSize, fMemory, fWipe, false, GetDBProfile("index")) {
 }
 
 bool CBlockTreeDB::ReadBlockFileInfo(int nFile, CBlockFileInfo &info) {
@@ -202,6 +223,62 @@ CCoinsViewCursor *CCoinsViewDB::Cursor() const
     return i;
 }
 
+bool CCoinsViewDB::ForEachCoinSharded(unsigned int nShards, const std::function<bool(unsigned int nShard, const COutPoint&, const Coin&)>& fn, uint256& hashBlock) const
+{
+    // Shards are split on the first byte of the txid, which follows DB_COIN in every key
+    nShards = std::max(1U, std::min(nShards, 256U));
+    CDBWrapper& dbMutable = const_cast<CDBWrapper&>(db);
+    const leveldb::Snapshot* snapshot = dbMutable.GetSnapshot();
+
+    hashBlock.SetNull();
+    {
+        std::unique_ptr<CDBIterator> pcursor(dbMutable.NewIterator(snapshot));
+        pcursor->Seek(DB_BEST_BLOCK);
+        char chKey;
+        if (pcursor->Valid() && pcursor->GetKey(chKey) && chKey == DB_BEST_BLOCK)
+            pcursor->GetValue(hashBlock);
+    }
+    // BatchWrite erases the best block in its first batch and writes it back
+    // in its last, so without one the snapshot caught a partly written flush
+    if (hashBlock.IsNull()) {
+        dbMutable.ReleaseSnapshot(snapshot);
+        return false;
+    }
+
+    std::atomic<bool> fOk(true);
+    auto scan = [&](unsigned int nShard) {
+        const unsigned int nBegin = 256 * nShard / nShards;
+        const unsigned int nEnd = 256 * (nShard + 1) / nShards;
+        std::unique_ptr<CDBIterator> pcursor(dbMutable.NewIterator(snapshot));
+        COutPoint start(uint256(), 0);
+        *start.hash.begin() = nBegin;
+        pcursor->Seek(CoinEntry(&start));
+
+        COutPoint key;
+        CoinEntry entry(&key);
+        Coin coin;
+        for (; fOk && pcursor->Valid(); pcursor->Next()) {
+            if (!pcursor->GetKey(entry) || entry.key != DB_COIN || *key.hash.begin() >= nEnd)
+                break;
+            if (!pcursor->GetValue(coin) || !fn(nShard, key, coin)) {
+                fOk = false;
+                break;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(nShards - 1);
+    for (unsigned int i = 1; i < nShards; i++)
+        threads.emplace_back(scan, i);
+    scan(0);
+    for (std::thread& thread : threads)
+        thread.join();
+
+    dbMutable.ReleaseSnapshot(snapshot);
+    return fOk;
+}
+
 bool CCoinsViewDBCursor::GetKey(COutPoint &key) const
 {
     // Return cached key
@@ -275,49 +352,83 @@ bool CBlockTreeDB::ReadFlag(const std::string &name, bool &fValue) {
 
 bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex)
 {
-    std::unique_ptr<CDBIterator> pcursor(NewIterator());
-
-    pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, uint256()));
-
-    // Load mapBlockIndex
-    while (pcursor->Valid()) {
-        boost::this_thread::interruption_point();
-        std::pair<char, uint256> key;
-        if (pcursor->GetKey(key) && key.first == DB_BLOCK_INDEX) {
-            CDiskBlockIndex diskindex;
-            if (pcursor->GetValue(diskindex)) {
-                // Construct block index object
-                CBlockIndex* pindexNew = insertBlockIndex(diskindex.GetBlockHash());
-                pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
-                pindexNew->nHeight        = diskindex.nHeight;
-                pindexNew->nFile          = diskindex.nFile;
-                pindexNew->nDataPos       = diskindex.nDataPos;
-                pindexNew->nUndoPos       = diskindex.nUndoPos;
-                pindexNew->nVersion       = diskindex.nVersion;
-                pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
-                pindexNew->nTime          = diskindex.nTime;
-                pindexNew->nBits          = diskindex.nBits;
-                pindexNew->nNonce         = diskindex.nNonce;
-                pindexNew->nStatus        = diskindex.nStatus;
-                pindexNew->nTx            = diskindex.nTx;
-
-                if (!CheckProofOfWork(pindexNew->GetBlockHash(), pindexNew->nBits, consensusParams))
-                    return error("%s: CheckProofOfWork failed: %s", __func__, pindexNew->ToString());
-
+    int64_t nTimeStart = GetTimeMicros();
+
+    // Stage 1: drain the cursor. LevelDB iteration is sequential, so only
+    // decode here and leave the expensive work for the parallel stage.
+    std::vector<CDiskBlockIndex> vDiskIndex;
+    {
+        std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+        pcursor->Seek(std::make_pair(DB_BLOCK_INDEX, uint256()));
+
+        while (pcursor->Valid()) {
+            boost::this_thread::interruption_point();
+            std::pair<char, uint256> key;
+            if (pcursor->GetKey(key) && key.first == DB_BLOCK_INDEX) {
+                vDiskIndex.emplace_back();
+                if (!pcursor->GetValue(vDiskIndex.back()))
+                    return error("%s: failed to read value", __func__);
                 pcursor->Next();
             } else {
-                return error("%s: failed to read value", __func__);
+                break;
+            }
+        }
+    }
+    int64_t nTimeRead = GetTimeMicros();
+
+    boost::this_thread::interruption_point();
+
+    // Stage 2: hash the headers and check proof of work on all cores
+    std::vector<uint256> vHash(vDiskIndex.size());
+    std::atomic<size_t> nInvalid(vDiskIndex.size());
+    bool fValid = ParallelForRanges(vDiskIndex.size(), GetNumCores(), [&](size_t nBegin, size_t nEnd) {
+        for (size_t i = nBegin; i < nEnd; i++) {
+            vHash[i] = vDiskIndex[i].GetBlockHash();
+            if (!CheckProofOfWork(vHash[i], vDiskIndex[i].nBits, consensusParams)) {
+                nInvalid = i;
+                return false;
             }
-        } else {
-            break;
         }
+        return true;
+    });
+    if (!fValid) {
+        if (nInvalid < vDiskIndex.size())
+            return error("%s: CheckProofOfWork failed: %s", __func__, vDiskIndex[nInvalid].ToString());
+        return error("%s: failed to check block index", __func__);
     }
+    int64_t nTimeCheck = GetTimeMicros();
+
+    boost::this_thread::interruption_point();
+
+    // Stage 3: construct block index objects and link them up
+    for (size_t i = 0; i < vDiskIndex.size(); i++) {
+        const CDiskBlockIndex& diskindex = vDiskIndex[i];
+        CBlockIndex* pindexNew = insertBlockIndex(vHash[i]);
+        pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
+        pindexNew->nHeight        = diskindex.nHeight;
+        pindexNew->nFile          = diskindex.nFile;
+        pindexNew->nDataPos       = diskindex.nDataPos;
+        pindexNew->nUndoPos       = diskindex.nUndoPos;
+        pindexNew->nVersion       = diskindex.nVersion;
+        pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
+        pindexNew->nTime          = diskindex.nTime;
+        pindexNew->nBits          = diskindex.nBits;
+        pindexNew->nNonce         = diskindex.nNonce;
+        pindexNew->nStatus        = diskindex.nStatus;
+        pindexNew->nTx            = diskindex.nTx;
+    }
+    int64_t nTimeLink = GetTimeMicros();
+
+    LogPrint(BCLog::BENCH, "%s: %u entries, read %.2fms, check %.2fms, link %.2fms\n", __func__,
+            vDiskIndex.size(), (nTimeRead - nTimeStart) * 0.001, (nTimeCheck - nTimeRead) * 0.001,
+            (nTimeLink - nTimeCheck) * 0.001);
 
     return true;
 }
 
 CSidechainTreeDB::CSidechainTreeDB(size_t nCacheSize, bool fMemory, bool fWipe)
-    : CDBWrapper(GetDataDir() / "blocks" / "sidechain", nCacheSize, fMemory, fWipe) { }
+    : CDBWrapper(GetDataDir() / "blocks" / "sidechain", nCacheSize, fMemory, fWipe, false, GetDBProfile("sidechain")) { }
 
 bool CSidechainTreeDB::WriteSidechainIndex(const std::vector<std::pair<uint256, const SidechainObj *> > &list)
 {
@@ -360,7 +471,7 @@ bool CSidechainTreeDB::HaveBlockData(const uint256& hashBlock) const
 }
 
 OPReturnDB::OPReturnDB(size_t nCacheSize, bool fMemory, bool fWipe)
-    : CDBWrapper(GetDataDir() / "blocks" / "opreturn", nCacheSize, fMemory, fWipe) { }
+    : CDBWrapper(GetDataDir() / "blocks" / "opreturn", nCacheSize, fMemory, fWipe, false, GetDBProfile("opreturn")) { }
 
 bool OPReturnDB::WriteBlockData(const std::pair<uint256, const std::vector<OPReturnData>>& data)
 {
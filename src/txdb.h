@@ -11,6 +11,7 @@
 #include <dbwrapper.h>
 #include <sidechain.h>
 
+#include <functional>
 #include <map>
 #include <string>
 #include <utility>
@@ -71,6 +72,8 @@ class CCoinsViewDB final : public CCoinsView
 {
 protected:
     CDBWrapper db;
+    //! Written with the final batch of the next flush of its block
+    CUTXOSetStats pendingStats;
 public:
     explicit CCoinsViewDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
 
@@ -81,9 +84,28 @@ public:
     bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
     CCoinsViewCursor *Cursor() const override;
 
+    /**
+     * Visit every coin with nShards threads, each walking its own range of
+     * txid prefixes with a separate iterator over one database snapshot.
+     * fn is called concurrently from different shards, with the index of the
+     * calling shard so results can be collected without locking. Stops early
+     * and returns false on a read error or when fn returns false. hashBlock
+     * is set to the best block of the snapshot. Returns false without calling
+     * fn, leaving hashBlock null, if the snapshot was taken while a flush was
+     * being written.
+     */
+    bool ForEachCoinSharded(unsigned int nShards, const std::function<bool(unsigned int nShard, const COutPoint&, const Coin&)>& fn, uint256& hashBlock) const;
+
     //! Attempt to update from an older database format. Returns whether an error occurred.
     bool Upgrade();
     size_t EstimateSize() const override;
+    CDBStats GetDBStats() const;
+    const CDBProfile& GetProfile() const { return db.GetProfile(); }
+
+    //! Read the UTXO set statistics stored with the best block
+    bool ReadUTXOSetStats(CUTXOSetStats& stats) const;
+    //! Store stats along with the best block once a flush makes stats.hashBlock the best block
+    void SetUTXOSetStats(const CUTXOSetStats& stats);
 };
 
 /** Specialization of CCoinsViewCursor to iterate over a CCoinsViewDB */
@@ -181,6 +181,27 @@ bool CTxMemPool::CalculateMemPoolAncestors(const CTxMemPoolEntry &entry, setEntr
         parentHashes = GetMemPoolParents(it);
     }
 
+    // Every ancestor, and every descendant of an ancestor, is in the cluster of
+    // one of the parents. If those clusters together are within all limits,
+    // no limit can be hit while walking them.
+    if (!parentHashes.empty()) {
+        std::set<uint64_t> setClusters;
+        uint64_t nClusterCount = 1;
+        uint64_t nClusterSize = entry.GetTxSize();
+        for (txiter piter : parentHashes) {
+            const uint64_t cluster = mapLinks.find(piter)->second.cluster;
+            if (setClusters.insert(cluster).second) {
+                const TxCluster& stats = mapClusters.find(cluster)->second;
+                nClusterCount += stats.nCount;
+                nClusterSize += stats.nSize;
+            }
+        }
+        if (nClusterCount <= limitAncestorCount && nClusterCount <= limitDescendantCount &&
+                nClusterSize <= limitAncestorSize && nClusterSize <= limitDescendantSize) {
+            limitAncestorCount = limitAncestorSize = limitDescendantCount = limitDescendantSize = std::numeric_limits<uint64_t>::max();
+        }
+    }
+
     size_t totalSizeWithAncestors = entry.GetTxSize();
 
     while (!parentHashes.empty()) {
@@ -394,6 +415,9 @@ bool CTxMemPool::addUnchecked(const uint256& hash, const CTxMemPoolEntry &entry,
     // further updated.)
     cachedInnerUsage += entry.DynamicMemoryUsage();
 
+    // Start out alone; linking to in-mempool parents below merges clusters.
+    AddToNewCluster(newit);
+
     const CTransaction& tx = newit->GetTx();
     std::set<uint256> setParentTransactions;
     for (unsigned int i = 0; i < tx.vin.size(); i++) {
@@ -420,6 +444,7 @@ bool CTxMemPool::addUnchecked(const uint256& hash, const CTxMemPoolEntry &entry,
 
     nTransactionsUpdated++;
     totalTxSize += entry.GetTxSize();
+    UpdateStats(entry, true);
     if (minerPolicyEstimator) {minerPolicyEstimator->processTransaction(entry, validFeeEstimate);}
 
     vTxHashes.emplace_back(tx.GetWitnessHash(), newit);
@@ -448,8 +473,10 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
         vTxHashes.clear();
 
     totalTxSize -= it->GetTxSize();
+    UpdateStats(*it, false);
     cachedInnerUsage -= it->DynamicMemoryUsage();
     cachedInnerUsage -= memusage::DynamicUsage(mapLinks[it].parents) + memusage::DynamicUsage(mapLinks[it].children);
+    RemoveFromCluster(it);
     mapLinks.erase(it);
     mapTx.erase(it);
     nTransactionsUpdated++;
@@ -589,6 +616,19 @@ void CTxMemPool::removeForBlock(const std::vector<CTransactionRef>& vtx, unsigne
     }
     // Before the txs in the new block have been removed from the mempool, update policy estimates
     if (minerPolicyEstimator) {minerPolicyEstimator->processBlock(nBlockHeight, entries);}
+
+    // Clusters confirmed in full, such as chains of deposits, have no entries
+    // left to update, so drop them without walking their descendants for every
+    // transaction removed.
+    std::map<uint64_t, uint64_t> mapBlockClusterCount;
+    for (const CTxMemPoolEntry* entry : entries) {
+        mapBlockClusterCount[mapLinks.find(mapTx.iterator_to(*entry))->second.cluster]++;
+    }
+    for (const auto& item : mapBlockClusterCount) {
+        if (item.second == mapClusters.find(item.first)->second.nCount)
+            RemoveConfirmedCluster(item.first);
+    }
+
     for (const auto& tx : vtx)
     {
         txiter it = mapTx.find(tx->GetHash());
@@ -600,6 +640,7 @@ void CTxMemPool::removeForBlock(const std::vector<CTransactionRef>& vtx, unsigne
         removeConflicts(*tx);
         ClearPrioritisation(tx->GetHash());
     }
+    SplitDirtyClusters();
     lastRollingFeeUpdate = GetTime();
     blockSinceLastRollingFeeBump = true;
 }
@@ -607,6 +648,10 @@ void CTxMemPool::removeForBlock(const std::vector<CTransactionRef>& vtx, unsigne
 void CTxMemPool::_clear()
 {
     mapLinks.clear();
+    mapClusters.clear();
+    nNextClusterId = 1;
+    stats = MempoolStats();
+    vEvictedBMM.clear();
     mapTx.clear();
     mapNextTx.clear();
     totalTxSize = 0;
@@ -660,6 +705,15 @@ void CTxMemPool::check(const CCoinsViewCache *pcoins) const
         assert(linksiter != mapLinks.end());
         const TxLinks &links = linksiter->second;
         innerUsage += memusage::DynamicUsage(links.parents) + memusage::DynamicUsage(links.children);
+        // Check that linked entries share a cluster that knows about them.
+        auto clusteriter = mapClusters.find(links.cluster);
+        assert(clusteriter != mapClusters.end());
+        assert(clusteriter->second.members.count(it));
+        for (const setEntries* neighbours : {&links.parents, &links.children}) {
+            for (txiter next : *neighbours) {
+                assert(mapLinks.find(next)->second.cluster == links.cluster);
+            }
+        }
         bool fDependsWait = false;
         setEntries setParentCheck;
         int64_t parentSizes = 0;
@@ -753,6 +807,62 @@ void CTxMemPool::check(const CCoinsViewCache *pcoins) const
 
     assert(totalTxSize == checkTotal);
     assert(innerUsage == cachedInnerUsage);
+
+    // Check the incrementally maintained histogram and sidechain counters.
+    uint64_t nStatsCount = 0;
+    uint64_t nStatsSize = 0;
+    CAmount nStatsFees = 0;
+    for (const MempoolStats::FeeRateBucket& bucket : stats.vFeeRateBuckets) {
+        nStatsCount += bucket.nCount;
+        nStatsSize += bucket.nSize;
+        nStatsFees += bucket.nFees;
+    }
+    assert(nStatsCount == mapTx.size());
+    assert(nStatsSize == totalTxSize);
+    assert(nStatsFees == stats.nTotalFees);
+    uint64_t nDepositsCheck = 0;
+    for (const CTxMemPoolEntry& entry : mapTx) {
+        if (entry.IsSidechainDeposit()) nDepositsCheck++;
+    }
+    uint64_t nDeposits = 0;
+    for (const auto& item : stats.mapSidechain) {
+        assert(item.second.nDeposits || item.second.nBMMRequests);
+        nDeposits += item.second.nDeposits;
+    }
+    assert(nDeposits == nDepositsCheck);
+
+    // Check cluster totals, and that clean clusters are connected.
+    uint64_t nClusterMembers = 0;
+    for (const auto& item : mapClusters) {
+        const TxCluster& cluster = item.second;
+        assert(!cluster.members.empty());
+        assert(cluster.nCount == cluster.members.size());
+        uint64_t nSizeCheck = 0;
+        CAmount nFeesCheck = 0;
+        for (txiter member : cluster.members) {
+            nSizeCheck += member->GetTxSize();
+            nFeesCheck += member->GetModifiedFee();
+        }
+        assert(cluster.nSize == nSizeCheck);
+        assert(cluster.nModFees == nFeesCheck);
+        nClusterMembers += cluster.nCount;
+        if (cluster.fDirty)
+            continue;
+        setEntries setReached{*cluster.members.begin()};
+        std::vector<txiter> vStage{*cluster.members.begin()};
+        while (!vStage.empty()) {
+            txiter next = vStage.back();
+            vStage.pop_back();
+            for (txiter parent : GetMemPoolParents(next)) {
+                if (setReached.insert(parent).second) vStage.push_back(parent);
+            }
+            for (txiter child : GetMemPoolChildren(next)) {
+                if (setReached.insert(child).second) vStage.push_back(child);
+            }
+        }
+        assert(setReached.size() == cluster.members.size());
+    }
+    assert(nClusterMembers == mapTx.size());
 }
 
 bool CTxMemPool::CompareDepthAndScore(const uint256& hasha, const uint256& hashb)
@@ -910,6 +1020,7 @@ void CTxMemPool::PrioritiseTransaction(const uint256& hash, const CAmount& nFeeD
         txiter it = mapTx.find(hash);
         if (it != mapTx.end()) {
             mapTx.modify(it, update_fee_delta(delta));
+            mapClusters[mapLinks[it].cluster].nModFees += nFeeDelta;
             // Now update all ancestors' modified fees with descendants
             setEntries setAncestors;
             uint64_t nNoLimit = std::numeric_limits<uint64_t>::max();
@@ -976,7 +1087,7 @@ bool CCoinsViewMemPool::GetCoin(const COutPoint &outpoint, Coin &coin) const {
 size_t CTxMemPool::DynamicMemoryUsage() const {
     LOCK(cs);
     // Estimate the overhead of mapTx to be 12 pointers + an allocation, as no exact formula for boost::multi_index_contained is implemented.
-    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 12 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(mapLinks) + memusage::DynamicUsage(vTxHashes) + cachedInnerUsage;
+    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 12 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(mapLinks) + memusage::DynamicUsage(mapClusters) + memusage::DynamicUsage(stats.mapSidechain) + memusage::IncrementalDynamicUsage(setEntries()) * mapTx.size() + memusage::DynamicUsage(vTxHashes) + cachedInnerUsage;
 }
 
 void CTxMemPool::RemoveStaged(setEntries &stage, bool updateDescendants, MemPoolRemovalReason reason) {
@@ -985,6 +1096,11 @@ void CTxMemPool::RemoveStaged(setEntries &stage, bool updateDescendants, MemPool
     for (const txiter& it : stage) {
         removeUnchecked(it, reason);
     }
+    // Entries confirmed in a block are removed one at a time, and the caller
+    // splits the clusters once it is done.
+    if (!updateDescendants) {
+        SplitDirtyClusters();
+    }
 }
 
 int CTxMemPool::Expire(int64_t time) {
@@ -1028,11 +1144,160 @@ void CTxMemPool::UpdateParent(txiter entry, txiter parent, bool add)
     setEntries s;
     if (add && mapLinks[entry].parents.insert(parent).second) {
         cachedInnerUsage += memusage::IncrementalDynamicUsage(s);
+        MergeClusters(mapLinks[entry].cluster, mapLinks[parent].cluster);
     } else if (!add && mapLinks[entry].parents.erase(parent)) {
         cachedInnerUsage -= memusage::IncrementalDynamicUsage(s);
     }
 }
 
+void CTxMemPool::AddToNewCluster(txiter entry)
+{
+    const uint64_t id = nNextClusterId++;
+    TxCluster& cluster = mapClusters[id];
+    cluster.members.insert(entry);
+    cluster.nCount = 1;
+    cluster.nSize = entry->GetTxSize();
+    cluster.nModFees = entry->GetModifiedFee();
+    mapLinks[entry].cluster = id;
+}
+
+void CTxMemPool::MergeClusters(uint64_t a, uint64_t b)
+{
+    if (a == b)
+        return;
+    // Move the members of the smaller cluster, so building a cluster of N
+    // entries relabels each of them at most log(N) times.
+    if (mapClusters[a].members.size() < mapClusters[b].members.size())
+        std::swap(a, b);
+    TxCluster& into = mapClusters[a];
+    TxCluster& from = mapClusters[b];
+    for (txiter member : from.members) {
+        mapLinks[member].cluster = a;
+        into.members.insert(member);
+    }
+    into.nCount += from.nCount;
+    into.nSize += from.nSize;
+    into.nModFees += from.nModFees;
+    into.fDirty |= from.fDirty;
+    mapClusters.erase(b);
+}
+
+void CTxMemPool::RemoveFromCluster(txiter entry)
+{
+    const TxLinks& links = mapLinks[entry];
+    std::map<uint64_t, TxCluster>::iterator it = mapClusters.find(links.cluster);
+    assert(it != mapClusters.end());
+    TxCluster& cluster = it->second;
+    cluster.members.erase(entry);
+    if (cluster.members.empty()) {
+        mapClusters.erase(it);
+        return;
+    }
+    cluster.nCount--;
+    cluster.nSize -= entry->GetTxSize();
+    cluster.nModFees -= entry->GetModifiedFee();
+    // Removing an entry with a single neighbour can't disconnect the rest.
+    // The links of entry are still intact here, so this may be conservative.
+    if (links.parents.size() + links.children.size() > 1)
+        cluster.fDirty = true;
+}
+
+void CTxMemPool::SplitDirtyClusters()
+{
+    for (std::map<uint64_t, TxCluster>::iterator it = mapClusters.begin(); it != mapClusters.end(); ) {
+        if (!it->second.fDirty) {
+            ++it;
+            continue;
+        }
+        setEntries setRemaining = std::move(it->second.members);
+        it = mapClusters.erase(it);
+        // The new clusters get higher ids than any being iterated, and aren't dirty
+        while (!setRemaining.empty()) {
+            txiter root = *setRemaining.begin();
+            setRemaining.erase(setRemaining.begin());
+            AddToNewCluster(root);
+            const uint64_t id = mapLinks[root].cluster;
+            std::vector<txiter> vStage{root};
+            while (!vStage.empty()) {
+                const TxLinks& links = mapLinks[vStage.back()];
+                vStage.pop_back();
+                for (const setEntries* neighbours : {&links.parents, &links.children}) {
+                    for (txiter next : *neighbours) {
+                        if (!setRemaining.erase(next))
+                            continue;
+                        TxCluster& cluster = mapClusters[id];
+                        cluster.members.insert(next);
+                        cluster.nCount++;
+                        cluster.nSize += next->GetTxSize();
+                        cluster.nModFees += next->GetModifiedFee();
+                        mapLinks[next].cluster = id;
+                        vStage.push_back(next);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void CTxMemPool::RemoveConfirmedCluster(uint64_t cluster)
+{
+    // No entry outside the cluster links to its members, so there is no
+    // ancestor or descendant state left to update.
+    const setEntries members = mapClusters[cluster].members;
+    for (txiter it : members) {
+        removeUnchecked(it, MemPoolRemovalReason::BLOCK);
+    }
+    assert(!mapClusters.count(cluster));
+}
+
+void CTxMemPool::UpdateStats(const CTxMemPoolEntry& entry, bool fAdd)
+{
+    const int64_t nSign = fAdd ? 1 : -1;
+    const CAmount nFee = entry.GetFee();
+    stats.nTotalFees += nSign * nFee;
+
+    const CAmount nFeeRate = CFeeRate(nFee, entry.GetTxSize()).GetFeePerK();
+    const size_t nBucket = std::upper_bound(MEMPOOL_FEERATE_BUCKETS, MEMPOOL_FEERATE_BUCKETS + MEMPOOL_FEERATE_BUCKET_COUNT, nFeeRate) - MEMPOOL_FEERATE_BUCKETS;
+    MempoolStats::FeeRateBucket& bucket = stats.vFeeRateBuckets[nBucket ? nBucket - 1 : 0];
+    bucket.nCount += nSign;
+    bucket.nSize += nSign * entry.GetTxSize();
+    bucket.nFees += nSign * nFee;
+
+    if (entry.IsSidechainDeposit()) {
+        MempoolStats::SidechainActivity& activity = stats.mapSidechain[entry.GetSidechainNumber()];
+        activity.nDeposits += nSign;
+        if (!activity.nDeposits && !activity.nBMMRequests)
+            stats.mapSidechain.erase(entry.GetSidechainNumber());
+    }
+
+    uint8_t nSidechain;
+    std::string strPrevBlock;
+    if (entry.HasCriticalData() && entry.GetTx().criticalData.IsBMMRequest(nSidechain, strPrevBlock)) {
+        MempoolStats::SidechainActivity& activity = stats.mapSidechain[nSidechain];
+        activity.nBMMRequests += nSign;
+        activity.nBMMFees += nSign * nFee;
+        if (!activity.nDeposits && !activity.nBMMRequests)
+            stats.mapSidechain.erase(nSidechain);
+    }
+}
+
+MempoolStats CTxMemPool::GetStats() const
+{
+    LOCK(cs);
+    return stats;
+}
+
+void CTxMemPool::GetClusterStats(txiter it, uint64_t& nCount, uint64_t& nSize, CAmount& nModFees) const
+{
+    AssertLockHeld(cs);
+    txlinksMap::const_iterator linksiter = mapLinks.find(it);
+    assert(linksiter != mapLinks.end());
+    const TxCluster& cluster = mapClusters.find(linksiter->second.cluster)->second;
+    nCount = cluster.nCount;
+    nSize = cluster.nSize;
+    nModFees = cluster.nModFees;
+}
+
 const CTxMemPool::setEntries & CTxMemPool::GetMemPoolParents(txiter entry) const
 {
     assert (entry != mapTx.end());
@@ -1111,17 +1376,35 @@ void CTxMemPool::SelectBMMRequests(std::vector<uint256>& vHashRemoved)
                     // We already have a BMM request selected for this sidechain
                     // so remove any extras
                     vTxRemove.push_back(it->GetTx());
+                    vEvictedBMM.emplace_back(it->GetSharedTx(), GetTime());
                 }
             }
         }
     }
 
+    // Forget evicted BMM requests that are too old or too many
+    int64_t nExpire = GetTime() - EVICTED_BMM_REQUEST_EXPIRY;
+    while (!vEvictedBMM.empty() && (vEvictedBMM.size() > MAX_EVICTED_BMM_REQUESTS || vEvictedBMM.front().second < nExpire))
+        vEvictedBMM.pop_front();
+
     for (const CTransaction& tx : vTxRemove) {
         vHashRemoved.push_back(tx.GetHash());
         removeRecursive(tx);
     }
 }
 
+std::vector<CTransactionRef> CTxMemPool::GetEvictedBMMRequests() const
+{
+    LOCK(cs);
+    std::vector<CTransactionRef> vTx;
+    int64_t nExpire = GetTime() - EVICTED_BMM_REQUEST_EXPIRY;
+    for (const auto& evicted : vEvictedBMM) {
+        if (evicted.second >= nExpire)
+            vTx.push_back(evicted.first);
+    }
+    return vTx;
+}
+
 void CTxMemPool::UpdateCTIPFromMempool(const std::map<uint8_t, SidechainCTIP>& mapCTIP)
 {
     LOCK(cs);
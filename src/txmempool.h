@@ -6,6 +6,7 @@
 #ifndef BITCOIN_TXMEMPOOL_H
 #define BITCOIN_TXMEMPOOL_H
 
+#include <deque>
 #include <memory>
 #include <set>
 #include <map>
@@ -33,6 +34,11 @@ class CBlockIndex;
 /** Fake height value used in Coin to signify they are only in the memory pool (since 0.8) */
 static const uint32_t MEMPOOL_HEIGHT = 0x7FFFFFFF;
 
+/** Maximum number of BMM requests evicted by SelectBMMRequests to remember */
+static const unsigned int MAX_EVICTED_BMM_REQUESTS = 100;
+/** How long (in seconds) evicted BMM requests are remembered */
+static const int64_t EVICTED_BMM_REQUEST_EXPIRY = 10 * 60;
+
 struct LockPoints
 {
     // Will be set to the blockchain height and median time past
@@ -357,6 +363,41 @@ struct TxMempoolInfo
     size_t nTxWeight;
 };
 
+/** Lower bounds of the mempool fee rate histogram buckets, in satoshis per 1000 virtual bytes */
+static constexpr CAmount MEMPOOL_FEERATE_BUCKETS[] = {
+    0, 1000, 2000, 3000, 4000, 5000, 6000, 8000, 10000, 12000, 15000, 20000, 25000,
+    30000, 40000, 50000, 60000, 80000, 100000, 150000, 200000, 300000, 500000, 1000000
+};
+static constexpr size_t MEMPOOL_FEERATE_BUCKET_COUNT = sizeof(MEMPOOL_FEERATE_BUCKETS) / sizeof(MEMPOOL_FEERATE_BUCKETS[0]);
+
+/**
+ * Summary of the mempool contents, updated as entries are added and removed
+ * so it can be reported without walking mapTx.
+ */
+struct MempoolStats
+{
+    struct FeeRateBucket {
+        uint64_t nCount = 0;
+        uint64_t nSize = 0;
+        CAmount nFees = 0;
+    };
+
+    struct SidechainActivity {
+        uint64_t nDeposits = 0;
+        uint64_t nBMMRequests = 0;
+        //! Fees paid by the BMM requests, which is what they bid to miners
+        CAmount nBMMFees = 0;
+    };
+
+    CAmount nTotalFees = 0;
+    //! Transactions by their own fee rate, indexed like MEMPOOL_FEERATE_BUCKETS
+    std::vector<FeeRateBucket> vFeeRateBuckets;
+    //! Only sidechains with pending deposits or BMM requests have an entry
+    std::map<uint8_t, SidechainActivity> mapSidechain;
+
+    MempoolStats() : vFeeRateBuckets(MEMPOOL_FEERATE_BUCKET_COUNT) {}
+};
+
 /** Reason why a transaction was removed from the mempool,
  * this is passed to the notification signal.
  */
@@ -432,6 +473,15 @@ public:
  * be in an inconsistent state where it's impossible to walk the ancestors of
  * a transaction.)
  *
+ * Entries connected through mapLinks are also grouped into clusters, which
+ * keep the count, size and modified fees of their members.  Clusters are
+ * merged as links are added and are split again only after removals that may
+ * have disconnected them, so a cluster can be a superset of a connected set of
+ * transactions but never misses one.  Its totals therefore bound the ancestor
+ * and descendant state of every member, which lets CalculateMemPoolAncestors()
+ * skip per-ancestor limit checks and lets removeForBlock() drop clusters that
+ * were confirmed in full without walking them.
+ *
  * In the event of a reorg, the assumption that a newly added tx has no
  * in-mempool children is false.  In particular, the mempool is in an
  * inconsistent state while new transactions are being added, because there may
@@ -523,6 +573,11 @@ public:
 
     void SelectBMMRequests(std::vector<uint256>& vHashRemoved);
 
+    /** Return the BMM requests SelectBMMRequests evicted recently. Another
+     * miner may have included one of them in a block, so they are kept
+     * around for compact block reconstruction. */
+    std::vector<CTransactionRef> GetEvictedBMMRequests() const;
+
     void UpdateCTIPFromMempool(const std::map<uint8_t, SidechainCTIP>& mapCTIP);
 
     void UpdateCTIPFromBlock(const std::map<uint8_t, SidechainCTIP>& mapCTIP, bool fDisconnect);
@@ -539,14 +594,42 @@ private:
     struct TxLinks {
         setEntries parents;
         setEntries children;
+        uint64_t cluster = 0;
     };
 
     typedef std::map<txiter, TxLinks, CompareIteratorByHash> txlinksMap;
     txlinksMap mapLinks;
 
+    struct TxCluster {
+        setEntries members;
+        uint64_t nCount = 0;
+        uint64_t nSize = 0;
+        CAmount nModFees = 0;
+        //! Set when a removal may have split the cluster
+        bool fDirty = false;
+    };
+
+    std::map<uint64_t, TxCluster> mapClusters;
+    uint64_t nNextClusterId;
+
+    //! BMM requests evicted by SelectBMMRequests and when, oldest first
+    std::deque<std::pair<CTransactionRef, int64_t>> vEvictedBMM;
+
+    MempoolStats stats;
+    /** Account for an entry being added to or removed from the mempool */
+    void UpdateStats(const CTxMemPoolEntry& entry, bool fAdd);
+
     void UpdateParent(txiter entry, txiter parent, bool add);
     void UpdateChild(txiter entry, txiter child, bool add);
 
+    void AddToNewCluster(txiter entry);
+    void MergeClusters(uint64_t a, uint64_t b);
+    void RemoveFromCluster(txiter entry);
+    /** Recompute the connected sets of clusters that removals may have split */
+    void SplitDirtyClusters();
+    /** Remove a cluster whose members were all confirmed in a block */
+    void RemoveConfirmedCluster(uint64_t cluster);
+
     std::vector<indexed_transaction_set::const_iterator> GetSortedDepthAndScore() const;
     std::vector<indexed_transaction_set::const_iterator> GetSortedTimeThenScore() const;
 
@@ -642,6 +725,15 @@ public:
      *  already in it.  */
     void CalculateDescendants(txiter it, setEntries &setDescendants);
 
+    /** Get the number of transactions, total size and modified fees of the
+     *  cluster of entries connected to it through in-mempool spends. The
+     *  cluster may be larger than that connected set after a removal, so the
+     *  totals are an upper bound on the ancestor and descendant state of it. */
+    void GetClusterStats(txiter it, uint64_t& nCount, uint64_t& nSize, CAmount& nModFees) const;
+
+    /** Get the fee rate histogram and per-sidechain activity of the mempool */
+    MempoolStats GetStats() const;
+
     /** The minimum fee to get into the mempool, which may itself not be enough
       *  for larger-sized transactions.
       *  The incrementalRelayFee policy variable is used to bound the time it
@@ -12,6 +12,7 @@
 #include <utilstrencodings.h>
 
 #include <stdarg.h>
+#include <thread>
 
 #if (defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__DragonFly__))
 #include <pthread.h>
@@ -937,6 +938,37 @@ int GetNumCores()
 #endif
 }
 
+bool ParallelForRanges(size_t nSize, int nThreads, const std::function<bool(size_t, size_t)>& func)
+{
+    if (nSize == 0)
+        return true;
+    if (nThreads < 1)
+        nThreads = 1;
+    if ((size_t)nThreads > nSize)
+        nThreads = nSize;
+
+    std::atomic<bool> fOk(true);
+    auto run = [&func, &fOk](size_t nBegin, size_t nEnd) {
+        try {
+            if (!func(nBegin, nEnd))
+                fOk = false;
+        } catch (...) {
+            fOk = false;
+        }
+    };
+
+    const size_t nChunk = (nSize + nThreads - 1) / nThreads;
+    std::vector<std::thread> vThreads;
+    vThreads.reserve(nThreads - 1);
+    for (size_t nBegin = nChunk; nBegin < nSize; nBegin += nChunk)
+        vThreads.emplace_back(run, nBegin, std::min(nSize, nBegin + nChunk));
+    run(0, std::min(nSize, nChunk));
+    for (std::thread& t : vThreads)
+        t.join();
+
+    return fOk;
+}
+
 std::string CopyrightHolders(const std::string& strPrefix)
 {
     std::string strCopyrightHolders = strPrefix + strprintf(_(COPYRIGHT_HOLDERS), _(COPYRIGHT_HOLDERS_SUBSTITUTION));
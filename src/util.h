@@ -22,6 +22,7 @@
 
 #include <atomic>
 #include <exception>
+#include <functional>
 #include <map>
 #include <stdint.h>
 #include <string>
@@ -313,6 +314,14 @@ std::string HelpMessageOpt(const std::string& option, const std::string& message
  */
 int GetNumCores();
 
+/**
+ * Split the index range [0, nSize) into contiguous chunks and call func(begin, end)
+ * on each of them from up to nThreads threads (the calling thread included).
+ * Blocks until every chunk has been processed.
+ * @return false if any invocation of func returned false or threw
+ */
+bool ParallelForRanges(size_t nSize, int nThreads, const std::function<bool(size_t, size_t)>& func);
+
 void RenameThread(const char* name);
 
 /**
@@ -6,6 +6,8 @@
 #include <validation.h>
 
 #include <arith_uint256.h>
+#include <blockcache.h>
+#include <blockwriter.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <checkpoints.h>
@@ -31,6 +33,7 @@
 #include <script/standard.h>
 #include <sidechain.h>
 #include <sidechaindb.h>
+#include <snapshot.h>
 #include <timedata.h>
 #include <tinyformat.h>
 #include <txdb.h>
@@ -48,6 +51,11 @@
 #include <sstream>
 #include <tuple>
 
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/join.hpp>
 #include <boost/thread.hpp>
@@ -166,9 +174,10 @@ public:
     bool AcceptBlock(const std::shared_ptr<const CBlock>& pblock, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex, bool fRequested,  const CDiskBlockPos* dbp, bool* fNewBlock, bool fFromDisk = false);
 
     // Block (dis)connection on a given view:
-    DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view);
+    // If pstats is set, the coins added and spent are also applied to it.
+    DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view, CUTXOSetStats* pstats = nullptr);
     bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pindex,
-                    CCoinsViewCache& view, const CChainParams& chainparams, bool fJustCheck = false);
+                    CCoinsViewCache& view, const CChainParams& chainparams, bool fJustCheck = false, CUTXOSetStats* pstats = nullptr);
 
     // Block disconnection on our pcoinsTip:
     bool DisconnectTip(CValidationState& state, const CChainParams& chainparams, DisconnectedBlockTransactions *disconnectpool);
@@ -181,6 +190,8 @@ public:
     bool ReplayBlocks(const CChainParams& params, CCoinsView* view);
     bool RewindBlockIndex(const CChainParams& params);
     bool LoadGenesisBlock(const CChainParams& chainparams);
+    /** Replace the empty chainstate by a snapshot; must be called with cs_main held */
+    bool LoadSnapshot(const fs::path& path, const uint256& hashExpected, const CChainParams& chainparams);
 
     void PruneBlockIndexCandidates();
 
@@ -237,6 +248,8 @@ CAmount maxTxFee = DEFAULT_TRANSACTION_MAXFEE;
 
 CBlockPolicyEstimator feeEstimator;
 CTxMemPool mempool(&feeEstimator);
+CBlockReadCache blockReadCache(DEFAULT_BLOCK_READ_CACHE << 20);
+CBlockFileWriter blockFileWriter(DEFAULT_BLOCK_WRITE_BUFFER << 20);
 
 SidechainDB scdb;
 
@@ -290,6 +303,9 @@ CBlockIndex* FindForkInGlobalIndex(const CChain& chain, const CBlockLocator& loc
 
 std::unique_ptr<CCoinsViewDB> pcoinsdbview;
 std::unique_ptr<CCoinsViewCache> pcoinsTip;
+/** Statistics of the UTXO set at pcoinsTip's best block, guarded by cs_main */
+static CUTXOSetStats utxoSetStats;
+static bool fUTXOSetStatsValid = true;
 std::unique_ptr<CBlockTreeDB> pblocktree;
 std::unique_ptr<CSidechainTreeDB> psidechaintree;
 std::unique_ptr<OPReturnDB> popreturndb;
@@ -489,20 +505,23 @@ void UpdateMempoolForReorg(DisconnectedBlockTransactions &disconnectpool, bool f
     // Iterate disconnectpool in reverse, so that we add transactions
     // back to the mempool starting with the earliest transaction that had
     // been previously seen in a block.
-    auto it = disconnectpool.queuedTx.get<insertion_order>().rbegin();
-    while (it != disconnectpool.queuedTx.get<insertion_order>().rend()) {
-        // ignore validation errors in resurrected transactions
-        CValidationState stateDummy;
-        if (!fAddToMempool || (*it)->IsCoinBase() ||
-            !AcceptToMemoryPool(mempool, stateDummy, *it, nullptr /* pfMissingInputs */,
-                                nullptr /* plTxnReplaced */, true /* bypass_limits */, 0 /* nAbsurdFee */)) {
+    std::vector<CTransactionRef> vtx(disconnectpool.queuedTx.get<insertion_order>().rbegin(),
+                                     disconnectpool.queuedTx.get<insertion_order>().rend());
+    // ignore validation errors in resurrected transactions
+    std::vector<CValidationState> vState(vtx.size());
+    if (fAddToMempool) {
+        AcceptToMemoryPoolBatch(mempool, vtx, {}, true /* bypass_limits */, vState);
+    }
+    for (size_t i = 0; i < vtx.size(); i++) {
+        if (!fAddToMempool || !vState[i].IsValid()) {
             // If the transaction doesn't make it in to the mempool, remove any
             // transactions that depend on it (which would now be orphans).
-            mempool.removeRecursive(**it, MemPoolRemovalReason::REORG);
-        } else if (mempool.exists((*it)->GetHash())) {
-            vHashUpdate.push_back((*it)->GetHash());
+            // A transaction later in the batch can't spend it, as it would
+            // have been missing inputs itself.
+            mempool.removeRecursive(*vtx[i], MemPoolRemovalReason::REORG);
+        } else if (mempool.exists(vtx[i]->GetHash())) {
+            vHashUpdate.push_back(vtx[i]->GetHash());
         }
-        ++it;
     }
     disconnectpool.queuedTx.clear();
     // AcceptToMemoryPool/addUnchecked all assume that new mempool entries have
@@ -619,9 +638,25 @@ bool GetDrivechainAmounts(const CCoinsView& coins, const CTransaction &tx,
     return true;
 }
 
+/** Script verification flags for mempool acceptance */
+static unsigned int GetStandardScriptFlags(const CChainParams& chainparams)
+{
+    unsigned int scriptVerifyFlags = STANDARD_SCRIPT_VERIFY_FLAGS;
+    if (!chainparams.RequireStandard()) {
+        scriptVerifyFlags = gArgs.GetArg("-promiscuousmempoolflags", scriptVerifyFlags);
+    }
+    return scriptVerifyFlags;
+}
+
+/**
+ * fScriptChecks may only be false for transactions whose scripts are known to
+ * have passed both script checks below, with the same flags, against the
+ * current tip, such as entries of a mempool snapshot taken at this tip.
+ */
 static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool& pool, CValidationState& state, const CTransactionRef& ptx,
                               bool* pfMissingInputs, int64_t nAcceptTime, std::list<CTransactionRef>* plTxnReplaced,
-                              bool bypass_limits, const CAmount& nAbsurdFee, std::vector<COutPoint>& coins_to_uncache)
+                              bool bypass_limits, const CAmount& nAbsurdFee, std::vector<COutPoint>& coins_to_uncache,
+                              bool fScriptChecks)
 {
     const CTransaction& tx = *ptx;
     const uint256 hash = tx.GetHash();
@@ -1097,15 +1132,12 @@ static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool
             }
         }
 
-        unsigned int scriptVerifyFlags = STANDARD_SCRIPT_VERIFY_FLAGS;
-        if (!chainparams.RequireStandard()) {
-            scriptVerifyFlags = gArgs.GetArg("-promiscuousmempoolflags", scriptVerifyFlags);
-        }
+        unsigned int scriptVerifyFlags = GetStandardScriptFlags(chainparams);
 
         // Check against previous transactions
         // This is done last to help prevent CPU exhaustion denial-of-service attacks.
         PrecomputedTransactionData txdata(tx);
-        if (!CheckInputs(tx, state, view, true, scriptVerifyFlags, true, false, txdata)) {
+        if (fScriptChecks && !CheckInputs(tx, state, view, true, scriptVerifyFlags, true, false, txdata)) {
             // SCRIPT_VERIFY_CLEANSTACK requires SCRIPT_VERIFY_WITNESS, so we
             // need to turn both off, and compare against just turning off CLEANSTACK
             // to see if the failure is specifically due to witness validation.
@@ -1134,7 +1166,7 @@ static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool
         // invalid blocks (using TestBlockValidity), however allowing such
         // transactions into the mempool can be exploited as a DoS attack.
         unsigned int currentBlockScriptVerifyFlags = GetBlockScriptFlags(chainActive.Tip(), Params().GetConsensus());
-        if (!CheckInputsFromMempoolAndCache(tx, state, view, pool, currentBlockScriptVerifyFlags, true, txdata))
+        if (fScriptChecks && !CheckInputsFromMempoolAndCache(tx, state, view, pool, currentBlockScriptVerifyFlags, true, txdata))
         {
             // If we're using promiscuousmempoolflags, we may hit this normally
             // Check if current block has some flags that scriptVerifyFlags
@@ -1195,10 +1227,10 @@ static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool
 /** (try to) add transaction to memory pool with a specified acceptance time **/
 static bool AcceptToMemoryPoolWithTime(const CChainParams& chainparams, CTxMemPool& pool, CValidationState &state, const CTransactionRef &tx,
                         bool* pfMissingInputs, int64_t nAcceptTime, std::list<CTransactionRef>* plTxnReplaced,
-                        bool bypass_limits, const CAmount nAbsurdFee)
+                        bool bypass_limits, const CAmount nAbsurdFee, bool fScriptChecks = true)
 {
     std::vector<COutPoint> coins_to_uncache;
-    bool res = AcceptToMemoryPoolWorker(chainparams, pool, state, tx, pfMissingInputs, nAcceptTime, plTxnReplaced, bypass_limits, nAbsurdFee, coins_to_uncache);
+    bool res = AcceptToMemoryPoolWorker(chainparams, pool, state, tx, pfMissingInputs, nAcceptTime, plTxnReplaced, bypass_limits, nAbsurdFee, coins_to_uncache, fScriptChecks);
     if (!res) {
         for (const COutPoint& hashTx : coins_to_uncache)
             pcoinsTip->Uncache(hashTx);
@@ -1237,6 +1269,7 @@ bool GetTransaction(const uint256& hash, CTransactionRef& txOut, const Consensus
         if (fTxIndex) {
             CDiskTxPos postx;
             if (pblocktree->ReadTxIndex(hash, postx)) {
+                blockFileWriter.WaitFor(postx);
                 CAutoFile file(OpenBlockFile(postx, true), SER_DISK, CLIENT_VERSION);
                 if (file.IsNull())
                     return error("%s: OpenBlockFile failed", __func__);
@@ -1265,9 +1298,9 @@ bool GetTransaction(const uint256& hash, CTransactionRef& txOut, const Consensus
     }
 
     if (pindexSlow) {
-        CBlock block;
-        if (ReadBlockFromDisk(block, pindexSlow, consensusParams)) {
-            for (const auto& tx : block.vtx) {
+        std::shared_ptr<const CBlock> pblock = ReadBlockFromDiskCached(pindexSlow, consensusParams);
+        if (pblock) {
+            for (const auto& tx : pblock->vtx) {
                 if (tx->GetHash() == hash) {
                     txOut = tx;
                     hashBlock = pindexSlow->GetBlockHash();
@@ -1290,39 +1323,60 @@ bool GetTransaction(const uint256& hash, CTransactionRef& txOut, const Consensus
 // CBlock and CBlockIndex
 //
 
-static bool WriteBlockToDisk(const CBlock& block, CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart)
+/** Deserialize the nSize byte block at the current position of file, and close it */
+static void UnserializeBlockFromFile(FILE* file, unsigned int nSize, CBlock& block)
 {
-    // Open history file to append
-    CAutoFile fileout(OpenBlockFile(pos), SER_DISK, CLIENT_VERSION);
-    if (fileout.IsNull())
-        return error("WriteBlockToDisk: OpenBlockFile failed");
-
-    // Write index header
-    unsigned int nSize = GetSerializeSize(fileout, block);
-    fileout << FLATDATA(messageStart) << nSize;
-
-    // Write block
-    long fileOutPos = ftell(fileout.Get());
-    if (fileOutPos < 0)
-        return error("WriteBlockToDisk: ftell failed");
-    pos.nPos = (unsigned int)fileOutPos;
-    fileout << block;
-
-    return true;
+#ifndef WIN32
+    // Map the block rather than reading it piecewise through stdio
+    static const long nPageSize = sysconf(_SC_PAGESIZE);
+    long nPos = ftell(file);
+    struct stat fileStat;
+    if (nPos >= 0 && nPageSize > 0 && fstat(fileno(file), &fileStat) == 0) {
+        if (nPos + (int64_t)nSize > fileStat.st_size) {
+            fclose(file);
+            throw std::ios_base::failure("block extends past end of file");
+        }
+        long nMapOffset = nPos - nPos % nPageSize;
+        size_t nMapSize = nSize + (nPos - nMapOffset);
+        void* pMap = mmap(nullptr, nMapSize, PROT_READ, MAP_PRIVATE, fileno(file), nMapOffset);
+        if (pMap != MAP_FAILED) {
+            fclose(file);
+            try {
+                CMemoryReader reader(SER_DISK, CLIENT_VERSION, (const unsigned char*)pMap + (nPos - nMapOffset), nSize);
+                reader >> block;
+            } catch (...) {
+                munmap(pMap, nMapSize);
+                throw;
+            }
+            munmap(pMap, nMapSize);
+            return;
+        }
+    }
+#endif
+    CAutoFile filein(file, SER_DISK, CLIENT_VERSION);
+    filein >> block;
 }
 
-bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus::Params& consensusParams)
+static bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus::Params& consensusParams, unsigned int& nSize)
 {
+    // Blocks that are still queued for writing are served from memory
+    std::shared_ptr<const CBlock> pblockPending = blockFileWriter.Get(pos);
+    if (pblockPending) {
+        block = *pblockPending;
+        nSize = ::GetSerializeSize(block, SER_DISK, CLIENT_VERSION);
+        return true;
+    }
+
     block.SetNull();
 
     // Open history file to read
-    CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
-    if (filein.IsNull())
-        return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
+    FILE* file = OpenRawBlockFromDisk(pos, Params().MessageStart(), nSize);
+    if (!file)
+        return error("ReadBlockFromDisk: OpenRawBlockFromDisk failed for %s", pos.ToString());
 
     // Read block
     try {
-        filein >> block;
+        UnserializeBlockFromFile(file, nSize, block);
     }
     catch (const std::exception& e) {
         return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
@@ -1335,7 +1389,13 @@ bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus:
     return true;
 }
 
-bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams)
+bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus::Params& consensusParams)
+{
+    unsigned int nSize = 0;
+    return ReadBlockFromDisk(block, pos, consensusParams, nSize);
+}
+
+static bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams, unsigned int& nSize)
 {
     CDiskBlockPos blockPos;
     {
@@ -1343,7 +1403,7 @@ bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus
         blockPos = pindex->GetBlockPos();
     }
 
-    if (!ReadBlockFromDisk(block, blockPos, consensusParams))
+    if (!ReadBlockFromDisk(block, blockPos, consensusParams, nSize))
         return false;
     if (block.GetHash() != pindex->GetBlockHash())
         return error("ReadBlockFromDisk(CBlock&, CBlockIndex*): GetHash() doesn't match index for %s at %s",
@@ -1351,6 +1411,69 @@ bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus
     return true;
 }
 
+bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams)
+{
+    unsigned int nSize = 0;
+    return ReadBlockFromDisk(block, pindex, consensusParams, nSize);
+}
+
+std::shared_ptr<const CBlock> ReadBlockFromDiskCached(const CBlockIndex* pindex, const Consensus::Params& consensusParams)
+{
+    std::shared_ptr<const CBlock> pblock = blockReadCache.Get(pindex->GetBlockHash());
+    if (pblock)
+        return pblock;
+    // The position is guarded by cs_main, the writer's queue by its own lock
+    CDiskBlockPos blockPos;
+    {
+        LOCK(cs_main);
+        blockPos = pindex->GetBlockPos();
+    }
+    pblock = blockFileWriter.Get(blockPos);
+    if (pblock && pblock->GetHash() == pindex->GetBlockHash())
+        return pblock;
+
+    std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
+    unsigned int nSize = 0;
+    if (!ReadBlockFromDisk(*pblockRead, pindex, consensusParams, nSize))
+        return nullptr;
+    blockReadCache.Insert(pblockRead, nSize);
+    return pblockRead;
+}
+
+FILE* OpenRawBlockFromDisk(const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart, unsigned int& nSize)
+{
+    // The index header written by the block writer precedes the block data
+    if (pos.nPos < CMessageHeader::MESSAGE_START_SIZE + sizeof(nSize)) {
+        error("OpenRawBlockFromDisk: invalid position %s", pos.ToString());
+        return nullptr;
+    }
+    blockFileWriter.WaitFor(pos);
+    CDiskBlockPos posHeader(pos.nFile, pos.nPos - CMessageHeader::MESSAGE_START_SIZE - sizeof(nSize));
+    CAutoFile filein(OpenBlockFile(posHeader, true), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull()) {
+        error("OpenRawBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
+        return nullptr;
+    }
+
+    try {
+        CMessageHeader::MessageStartChars blockStart;
+        filein >> FLATDATA(blockStart) >> nSize;
+        if (memcmp(blockStart, messageStart, CMessageHeader::MESSAGE_START_SIZE)) {
+            error("OpenRawBlockFromDisk: block magic mismatch at %s", pos.ToString());
+            return nullptr;
+        }
+        if (nSize > MAX_BLOCK_SERIALIZED_SIZE) {
+            error("OpenRawBlockFromDisk: block size %u too large at %s", nSize, pos.ToString());
+            return nullptr;
+        }
+    } catch (const std::exception& e) {
+        error("%s: I/O error - %s at %s", __func__, e.what(), pos.ToString());
+        return nullptr;
+    }
+
+    return filein.release();
+}
+
 CAmount GetBlockSubsidy(int nHeight, const Consensus::Params& consensusParams)
 {
     int halvings = nHeight / consensusParams.nSubsidyHalvingInterval;
@@ -1546,16 +1669,29 @@ int GetSpendHeight(const CCoinsViewCache& inputs)
 
 static CuckooCache::cache<uint256, SignatureCacheHasher> scriptExecutionCache;
 static uint256 scriptExecutionCacheNonce(GetRandHash());
+static size_t nScriptExecutionCacheCapacity = 0;
+static std::atomic<uint64_t> nScriptExecutionCacheHits(0);
+static std::atomic<uint64_t> nScriptExecutionCacheMisses(0);
 
 void InitScriptExecutionCache() {
     // nMaxCacheSize is unsigned. If -maxsigcachesize is set to zero,
     // setup_bytes creates the minimum possible cache (2 elements).
     size_t nMaxCacheSize = std::min(std::max((int64_t)0, gArgs.GetArg("-maxsigcachesize", DEFAULT_MAX_SIG_CACHE_SIZE) / 2), MAX_MAX_SIG_CACHE_SIZE) * ((size_t) 1 << 20);
     size_t nElems = scriptExecutionCache.setup_bytes(nMaxCacheSize);
+    nScriptExecutionCacheCapacity = nElems;
     LogPrintf("Using %zu MiB out of %zu/2 requested for script execution cache, able to store %zu elements\n",
             (nElems*sizeof(uint256)) >>20, (nMaxCacheSize*2)>>20, nElems);
 }
 
+CacheStats GetScriptExecutionCacheStats()
+{
+    CacheStats stats;
+    stats.nHits = nScriptExecutionCacheHits;
+    stats.nMisses = nScriptExecutionCacheMisses;
+    stats.nCapacity = nScriptExecutionCacheCapacity;
+    return stats;
+}
+
 /**
  * Check whether all inputs of this transaction are valid (no double spends, scripts & sigs, amounts)
  * This does not modify the UTXO set.
@@ -1599,8 +1735,10 @@ bool CheckInputs(const CTransaction& tx, CValidationState &state, const CCoinsVi
             CSHA256().Write(scriptExecutionCacheNonce.begin(), 55 - sizeof(flags) - 32).Write(tx.GetWitnessHash().begin(), 32).Write((unsigned char*)&flags, sizeof(flags)).Finalize(hashCacheEntry.begin());
             AssertLockHeld(cs_main); //TODO: Remove this requirement by making CuckooCache not require external locks
             if (scriptExecutionCache.contains(hashCacheEntry, !cacheFullScriptStore)) {
+                nScriptExecutionCacheHits++;
                 return true;
             }
+            nScriptExecutionCacheMisses++;
 
             for (unsigned int i = 0; i < tx.vin.size(); i++) {
                 const COutPoint &prevout = tx.vin[i].prevout;
@@ -1769,7 +1907,7 @@ int ApplyTxInUndo(Coin&& undo, CCoinsViewCache& view, const COutPoint& out)
 
 /** Undo the effects of this block (with given index) on the UTXO set represented by coins.
  *  When FAILED is returned, view is left in an indeterminate state. */
-DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view)
+DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view, CUTXOSetStats* pstats)
 {
     bool fClean = true;
 
@@ -1800,6 +1938,8 @@ DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockI
                 if (!is_spent || tx.vout[o] != coin.out || pindex->nHeight != coin.nHeight || is_coinbase != coin.fCoinBase) {
                     fClean = false; // transaction output mismatch
                 }
+                if (is_spent && pstats)
+                    pstats->RemoveCoin(out, coin);
             }
         }
 
@@ -1815,6 +1955,8 @@ DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockI
                 int res = ApplyTxInUndo(std::move(txundo.vprevout[j]), view, out);
                 if (res == DISCONNECT_FAILED) return DISCONNECT_FAILED;
                 fClean = fClean && res != DISCONNECT_UNCLEAN;
+                if (pstats)
+                    pstats->AddCoin(out, view.AccessCoin(out));
             }
             // At this point, all of txundo.vprevout should have been moved out.
         }
@@ -1837,6 +1979,8 @@ DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockI
 
     // move best block pointer to prevout block
     view.SetBestBlock(pindex->pprev->GetBlockHash());
+    if (pstats)
+        pstats->hashBlock = pindex->pprev->GetBlockHash();
 
     // Log that we have disconnected a block
     LogPrintf("%s: Block disconnected:\n%s\n", __func__, block.ToString());
@@ -1844,27 +1988,28 @@ DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockI
     return fClean ? DISCONNECT_OK : DISCONNECT_UNCLEAN;
 }
 
-void static FlushBlockFile(bool fFinalize = false)
+bool static FlushBlockFile(bool fFinalize = false)
 {
     LOCK(cs_LastBlockFile);
 
     CDiskBlockPos posOld(nLastBlockFile, 0);
 
-    FILE *fileOld = OpenBlockFile(posOld);
-    if (fileOld) {
-        if (fFinalize)
-            TruncateFile(fileOld, vinfoBlockFile[nLastBlockFile].nSize);
-        FileCommit(fileOld);
-        fclose(fileOld);
-    }
+    // Block data is written by blockFileWriter, so a finished file is
+    // finalized behind the blocks still queued for it
+    bool fWritten = true;
+    if (fFinalize)
+        blockFileWriter.Finalize(nLastBlockFile, vinfoBlockFile[nLastBlockFile].nSize);
+    else
+        fWritten = blockFileWriter.Flush();
 
-    fileOld = OpenUndoFile(posOld);
+    FILE *fileOld = OpenUndoFile(posOld);
     if (fileOld) {
         if (fFinalize)
             TruncateFile(fileOld, vinfoBlockFile[nLastBlockFile].nUndoSize);
         FileCommit(fileOld);
         fclose(fileOld);
     }
+    return fWritten;
 }
 
 static bool FindUndoPos(CValidationState &state, int nFile, CDiskBlockPos &pos, unsigned int nAddSize);
@@ -1915,6 +2060,138 @@ void ThreadScriptCheck() {
     scriptcheckqueue.Thread();
 }
 
+/** Transactions whose script checks share a CCheckQueueControl when filling
+ *  the signature cache. A failing check skips the rest of its group only. */
+static const size_t MEMPOOL_BATCH_CHECK_GROUP = 100;
+
+/**
+ * Verify the scripts of a batch of transactions on the script check threads,
+ * storing their signatures in the signature cache. Nothing is accepted here:
+ * this only makes the serial AcceptToMemoryPool calls that follow cheap.
+ * Inputs may come from the chain, the mempool or earlier transactions in the
+ * batch. vUncache receives, per transaction, the coins that were pulled into
+ * pcoinsTip for it, to be uncached if it is rejected.
+ */
+static void CacheMempoolBatchSignatures(CTxMemPool& pool, const std::vector<CTransactionRef>& vtx, std::vector<std::vector<COutPoint>>& vUncache)
+{
+    AssertLockHeld(cs_main);
+    vUncache.assign(vtx.size(), std::vector<COutPoint>());
+    if (!nScriptCheckThreads)
+        return;
+
+    LOCK(pool.cs);
+    CCoinsView dummy;
+    CCoinsViewCache view(&dummy);
+    CCoinsViewMemPool viewMemPool(pcoinsTip.get(), pool);
+    view.SetBackend(viewMemPool);
+
+    // Checks point to their precomputed data, which must not move
+    std::vector<PrecomputedTransactionData> vTxData;
+    vTxData.reserve(vtx.size());
+    std::vector<CScriptCheck> vChecks;
+    size_t nGroupTx = 0;
+    for (size_t i = 0; i < vtx.size(); i++) {
+        const CTransaction& tx = *vtx[i];
+        if (tx.IsCoinBase())
+            continue;
+        for (const CTxIn& txin : tx.vin) {
+            if (!pcoinsTip->HaveCoinInCache(txin.prevout))
+                vUncache[i].push_back(txin.prevout);
+        }
+        if (!view.HaveInputs(tx))
+            continue;
+        vTxData.emplace_back(tx);
+        CValidationState state;
+        CheckInputs(tx, state, view, true, STANDARD_SCRIPT_VERIFY_FLAGS, true, false, vTxData.back(), &vChecks);
+        AddCoins(view, tx, MEMPOOL_HEIGHT, true);
+
+        if (++nGroupTx == MEMPOOL_BATCH_CHECK_GROUP) {
+            CCheckQueueControl<CScriptCheck> control(&scriptcheckqueue);
+            control.Add(vChecks);
+            control.Wait();
+            vChecks.clear();
+            nGroupTx = 0;
+        }
+    }
+    if (!vChecks.empty()) {
+        CCheckQueueControl<CScriptCheck> control(&scriptcheckqueue);
+        control.Add(vChecks);
+        control.Wait();
+    }
+}
+
+/**
+ * Check the scripts of a batch of transactions that were accepted without
+ * script checks, and remove those that fail along with their descendants.
+ * The signatures are verified on the script check threads first, so the
+ * serial checks mostly hit the signature cache; like AcceptToMemoryPool they
+ * also store the result for the block script flags in the script execution
+ * cache. Returns the number of transactions removed from the pool.
+ */
+static size_t CheckMempoolBatchScripts(CTxMemPool& pool, const std::vector<CTransactionRef>& vtx)
+{
+    AssertLockHeld(cs_main);
+    std::vector<std::vector<COutPoint>> vUncache;
+    CacheMempoolBatchSignatures(pool, vtx, vUncache);
+
+    const CChainParams& chainparams = Params();
+    const unsigned int nStandardFlags = GetStandardScriptFlags(chainparams);
+    const unsigned int nBlockFlags = GetBlockScriptFlags(chainActive.Tip(), chainparams.GetConsensus());
+    LOCK(pool.cs);
+    const size_t nPoolSize = pool.size();
+    for (const CTransactionRef& tx : vtx) {
+        // Descendants of a failed transaction are gone already
+        if (!pool.exists(tx->GetHash()))
+            continue;
+        CCoinsView dummy;
+        CCoinsViewCache view(&dummy);
+        CCoinsViewMemPool viewMemPool(pcoinsTip.get(), pool);
+        view.SetBackend(viewMemPool);
+        PrecomputedTransactionData txdata(*tx);
+        CValidationState state;
+        if (!view.HaveInputs(*tx) ||
+                !CheckInputs(*tx, state, view, true, nStandardFlags, true, false, txdata) ||
+                !CheckInputsFromMempoolAndCache(*tx, state, view, pool, nBlockFlags, true, txdata)) {
+            LogPrint(BCLog::MEMPOOL, "%s: removing %s: %s\n", __func__, tx->GetHash().ToString(), FormatStateMessage(state));
+            pool.removeRecursive(*tx);
+        }
+    }
+    return nPoolSize - pool.size();
+}
+
+void AcceptToMemoryPoolBatch(CTxMemPool& pool, const std::vector<CTransactionRef>& vtx, const std::vector<int64_t>& vAcceptTime, bool bypass_limits, std::vector<CValidationState>& vState, bool fScriptChecks)
+{
+    assert(vAcceptTime.empty() || vAcceptTime.size() == vtx.size());
+    const CChainParams& chainparams = Params();
+    LOCK(cs_main);
+
+    int64_t nTimeStart = GetTimeMicros();
+    std::vector<std::vector<COutPoint>> vUncache(vtx.size());
+    if (fScriptChecks)
+        CacheMempoolBatchSignatures(pool, vtx, vUncache);
+    int64_t nTimeCached = GetTimeMicros();
+
+    // Accept in order, so deposits chain onto the CTIP left by the previous one
+    vState.assign(vtx.size(), CValidationState());
+    size_t nAccepted = 0;
+    for (size_t i = 0; i < vtx.size(); i++) {
+        const int64_t nAcceptTime = vAcceptTime.empty() ? GetTime() : vAcceptTime[i];
+        bool fMissingInputs = false;
+        if (AcceptToMemoryPoolWithTime(chainparams, pool, vState[i], vtx[i], &fMissingInputs, nAcceptTime,
+                                       nullptr /* plTxnReplaced */, bypass_limits, 0 /* nAbsurdFee */, fScriptChecks)) {
+            nAccepted++;
+        } else {
+            // Missing inputs leave the state valid; make every rejection visible
+            if (fMissingInputs)
+                vState[i].Invalid(false, 0, "missing-inputs");
+            for (const COutPoint& outpoint : vUncache[i])
+                pcoinsTip->Uncache(outpoint);
+        }
+    }
+    LogPrint(BCLog::MEMPOOL, "%s: accepted %u of %u transactions (signatures %.2fms, accept %.2fms)\n", __func__,
+             nAccepted, vtx.size(), (nTimeCached - nTimeStart) * 0.001, (GetTimeMicros() - nTimeCached) * 0.001);
+}
+
 // Protected by cs_main
 VersionBitsCache versionbitscache;
 
@@ -2009,7 +2286,7 @@ static int64_t nBlocksTotal = 0;
  *  Validity checks that depend on the UTXO set are also done; ConnectBlock()
  *  can fail if those validity checks fail (among other reasons). */
 bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pindex,
-                  CCoinsViewCache& view, const CChainParams& chainparams, bool fJustCheck)
+                  CCoinsViewCache& view, const CChainParams& chainparams, bool fJustCheck, CUTXOSetStats* pstats)
 {
     AssertLockHeld(cs_main);
     assert(pindex);
@@ -2043,6 +2320,8 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
     if (block.GetHash() == chainparams.GetConsensus().hashGenesisBlock) {
         if (!fJustCheck)
             view.SetBestBlock(pindex->GetBlockHash());
+        if (pstats)
+            pstats->hashBlock = pindex->GetBlockHash();
         return true;
     }
 
@@ -2404,9 +2683,26 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
         return state.Error("Failed to write block OP_RETURN data!");
     }
 
+    if (pstats) {
+        for (size_t i = 0; i < block.vtx.size(); i++) {
+            const CTransaction& tx = *block.vtx[i];
+            if (i > 0) {
+                const CTxUndo& txundo = blockundo.vtxundo[i - 1];
+                for (size_t j = 0; j < tx.vin.size(); j++)
+                    pstats->RemoveCoin(tx.vin[j].prevout, txundo.vprevout[j]);
+            }
+            for (size_t o = 0; o < tx.vout.size(); o++) {
+                if (!tx.vout[o].scriptPubKey.IsUnspendable())
+                    pstats->AddCoin(COutPoint(tx.GetHash(), o), Coin(tx.vout[o], pindex->nHeight, tx.IsCoinBase()));
+            }
+        }
+    }
+
     assert(pindex->phashBlock);
     // add this block to the view's block chain
     view.SetBestBlock(pindex->GetBlockHash());
+    if (pstats)
+        pstats->hashBlock = pindex->GetBlockHash();
 
     int64_t nTime5 = GetTimeMicros(); nTimeIndex += nTime5 - nTime4;
     LogPrint(BCLog::BENCH, "    - Index writing: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime5 - nTime4), nTimeIndex * MICRO, nTimeIndex * MILLI / nBlocksTotal);
@@ -2481,7 +2777,8 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
             if (!CheckDiskSpace(0))
                 return state.Error("out of disk space");
             // First make sure all block and undo data is flushed to disk.
-            FlushBlockFile();
+            if (!FlushBlockFile())
+                return AbortNode(state, "Failed to write block");
             // Then update all block file information (which may refer to block and undo files).
             {
                 std::vector<std::pair<int, const CBlockFileInfo*> > vFiles;
@@ -2514,7 +2811,9 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
             // overwrite one. Still, use a conservative safety factor of 2.
             if (!CheckDiskSpace(48 * 2 * 2 * pcoinsTip->GetCacheSize()))
                 return state.Error("out of disk space");
-            // Flush the chainstate (which may refer to block index entries).
+            // Flush the chainstate (which may refer to block index entries),
+            // and the UTXO set statistics along with its best block.
+            pcoinsdbview->SetUTXOSetStats(fUTXOSetStatsValid ? utxoSetStats : CUTXOSetStats());
             if (!pcoinsTip->Flush())
                 return AbortNode(state, "Failed to write to coin database");
             nLastFlush = nNow;
@@ -2630,10 +2929,12 @@ bool CChainState::DisconnectTip(CValidationState& state, const CChainParams& cha
     {
         CCoinsViewCache view(pcoinsTip.get());
         assert(view.GetBestBlock() == pindexDelete->GetBlockHash());
-        if (DisconnectBlock(block, pindexDelete, view) != DISCONNECT_OK)
+        CUTXOSetStats stats = utxoSetStats;
+        if (DisconnectBlock(block, pindexDelete, view, fUTXOSetStatsValid ? &stats : nullptr) != DISCONNECT_OK)
             return error("DisconnectTip(): DisconnectBlock %s failed", pindexDelete->GetBlockHash().ToString());
         bool flushed = view.Flush();
         assert(flushed);
+        utxoSetStats = stats;
     }
     LogPrint(BCLog::BENCH, "- Disconnect block: %.2fms\n", (GetTimeMicros() - nStart) * MILLI);
     // Write the chain state to disk, if necessary.
@@ -2760,7 +3061,8 @@ bool CChainState::ConnectTip(CValidationState& state, const CChainParams& chainp
     LogPrint(BCLog::BENCH, "  - Load block from disk: %.2fms [%.2fs]\n", (nTime2 - nTime1) * MILLI, nTimeReadFromDisk * MICRO);
     {
         CCoinsViewCache view(pcoinsTip.get());
-        bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, chainparams);
+        CUTXOSetStats stats = utxoSetStats;
+        bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, chainparams, false, fUTXOSetStatsValid ? &stats : nullptr);
         GetMainSignals().BlockChecked(blockConnecting, state);
         if (!rv) {
             if (state.IsInvalid())
@@ -2771,6 +3073,7 @@ bool CChainState::ConnectTip(CValidationState& state, const CChainParams& chainp
         LogPrint(BCLog::BENCH, "  - Connect total: %.2fms [%.2fs (%.2fms/blk)]\n", (nTime3 - nTime2) * MILLI, nTimeConnectTotal * MICRO, nTimeConnectTotal * MILLI / nBlocksTotal);
         bool flushed = view.Flush();
         assert(flushed);
+        utxoSetStats = stats;
     }
     int64_t nTime4 = GetTimeMicros(); nTimeFlush += nTime4 - nTime3;
     LogPrint(BCLog::BENCH, "  - Flush: %.2fms [%.2fs (%.2fms/blk)]\n", (nTime4 - nTime3) * MILLI, nTimeFlush * MICRO, nTimeFlush * MILLI / nBlocksTotal);
@@ -4067,7 +4370,8 @@ bool ProcessNewBlockHeaders(const std::vector<CBlockHeader>& headers, CValidatio
 }
 
 /** Store block on disk. If dbp is non-nullptr, the file is known to already reside on disk */
-static CDiskBlockPos SaveBlockToDisk(const CBlock& block, int nHeight, const CChainParams& chainparams, const CDiskBlockPos* dbp) {
+static CDiskBlockPos SaveBlockToDisk(const std::shared_ptr<const CBlock>& pblock, int nHeight, const CChainParams& chainparams, const CDiskBlockPos* dbp) {
+    const CBlock& block = *pblock;
     unsigned int nBlockSize = ::GetSerializeSize(block, SER_DISK, CLIENT_VERSION);
     CDiskBlockPos blockPos;
     if (dbp != nullptr)
@@ -4077,7 +4381,9 @@ static CDiskBlockPos SaveBlockToDisk(const CBlock& block, int nHeight, const CCh
         return CDiskBlockPos();
     }
     if (dbp == nullptr) {
-        if (!WriteBlockToDisk(block, blockPos, chainparams.MessageStart())) {
+        // The block data follows its index header
+        blockPos.nPos += CMessageHeader::MESSAGE_START_SIZE + sizeof(nBlockSize);
+        if (!blockFileWriter.Write(pblock, blockPos, nBlockSize, chainparams.MessageStart())) {
             AbortNode("Failed to write block");
             return CDiskBlockPos();
         }
@@ -4148,7 +4454,7 @@ bool CChainState::AcceptBlock(const std::shared_ptr<const CBlock>& pblock, CVali
 
     // Write block to history file
     try {
-        CDiskBlockPos blockPos = SaveBlockToDisk(block, pindex->nHeight, chainparams, dbp);
+        CDiskBlockPos blockPos = SaveBlockToDisk(pblock, pindex->nHeight, chainparams, dbp);
         if (blockPos.IsNull()) {
             state.Error(strprintf("%s: Failed to find position to write new block to disk", __func__));
             return false;
@@ -4449,6 +4755,8 @@ bool CChainState::LoadBlockIndex(const Consensus::Params& consensus_params, CBlo
 
     boost::this_thread::interruption_point();
 
+    int64_t nTimeStart = GetTimeMicros();
+
     // Calculate nChainWork
     std::vector<std::pair<int, CBlockIndex*> > vSortedByHeight;
     vSortedByHeight.reserve(mapBlockIndex.size());
@@ -4458,10 +4766,22 @@ bool CChainState::LoadBlockIndex(const Consensus::Params& consensus_params, CBlo
         vSortedByHeight.push_back(std::make_pair(pindex->nHeight, pindex));
     }
     sort(vSortedByHeight.begin(), vSortedByHeight.end());
-    for (const std::pair<int, CBlockIndex*>& item : vSortedByHeight)
+    int64_t nTimeSort = GetTimeMicros();
+
+    // The per-block proof only depends on nBits, so compute it on all cores
+    // and leave just the cumulative sum for the sequential pass below.
+    std::vector<arith_uint256> vBlockProof(vSortedByHeight.size());
+    ParallelForRanges(vSortedByHeight.size(), GetNumCores(), [&](size_t nBegin, size_t nEnd) {
+        for (size_t i = nBegin; i < nEnd; i++)
+            vBlockProof[i] = GetBlockProof(*vSortedByHeight[i].second);
+        return true;
+    });
+    int64_t nTimeProof = GetTimeMicros();
+
+    for (size_t i = 0; i < vSortedByHeight.size(); i++)
     {
-        CBlockIndex* pindex = item.second;
-        pindex->nChainWork = (pindex->pprev ? pindex->pprev->nChainWork : 0) + GetBlockProof(*pindex);
+        CBlockIndex* pindex = vSortedByHeight[i].second;
+        pindex->nChainWork = (pindex->pprev ? pindex->pprev->nChainWork : 0) + vBlockProof[i];
         pindex->nTimeMax = (pindex->pprev ? std::max(pindex->pprev->nTimeMax, pindex->nTime) : pindex->nTime);
         // We can link the chain of blocks for which we've received transactions at some point.
         // Pruned nodes may have deleted the block.
@@ -4490,6 +4810,11 @@ bool CChainState::LoadBlockIndex(const Consensus::Params& consensus_params, CBlo
         if (pindex->IsValid(BLOCK_VALID_TREE) && (pindexBestHeader == nullptr || CBlockIndexWorkComparator()(pindexBestHeader, pindex)))
             pindexBestHeader = pindex;
     }
+    int64_t nTimeChainWork = GetTimeMicros();
+
+    LogPrint(BCLog::BENCH, "%s: sort %.2fms, block proof %.2fms, chain work %.2fms\n", __func__,
+            (nTimeSort - nTimeStart) * 0.001, (nTimeProof - nTimeSort) * 0.001,
+            (nTimeChainWork - nTimeProof) * 0.001);
 
     return true;
 }
@@ -4551,8 +4876,51 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
     return true;
 }
 
+/** Load the UTXO set statistics stored with pcoinsTip's best block, or
+ * recompute them from the coins database if they are missing or stale. */
+static bool LoadUTXOSetStats()
+{
+    LOCK(cs_main);
+    const uint256 hashBest = pcoinsTip->GetBestBlock();
+    if (pcoinsdbview->ReadUTXOSetStats(utxoSetStats) && utxoSetStats.hashBlock == hashBest) {
+        fUTXOSetStatsValid = true;
+        return true;
+    }
+
+    fUTXOSetStatsValid = false;
+    utxoSetStats.SetNull();
+    if (pcoinsdbview->GetBestBlock() != hashBest)
+        return error("%s: coins database is behind the chain state", __func__);
+    if (!hashBest.IsNull())
+        LogPrintf("Computing UTXO set statistics...\n");
+    std::unique_ptr<CCoinsViewCursor> pcursor(pcoinsdbview->Cursor());
+    while (pcursor->Valid()) {
+        COutPoint key;
+        Coin coin;
+        if (!pcursor->GetKey(key) || !pcursor->GetValue(coin))
+            return error("%s: unable to read coins database", __func__);
+        utxoSetStats.AddCoin(key, coin);
+        pcursor->Next();
+    }
+    utxoSetStats.hashBlock = hashBest;
+    fUTXOSetStatsValid = true;
+    return true;
+}
+
+bool GetUTXOSetStats(CUTXOSetStats& stats)
+{
+    LOCK(cs_main);
+    if (!fUTXOSetStatsValid)
+        return false;
+    stats = utxoSetStats;
+    return true;
+}
+
 bool LoadChainTip(const CChainParams& chainparams)
 {
+    if (!LoadUTXOSetStats())
+        LogPrintf("%s: UTXO set statistics are unavailable\n", __func__);
+
     if (chainActive.Tip() && chainActive.Tip()->GetBlockHash() == pcoinsTip->GetBestBlock()) return true;
 
     if (pcoinsTip->GetBestBlock().IsNull() && mapBlockIndex.size() == 1) {
@@ -4917,6 +5285,8 @@ void UnloadBlockIndex()
     }
     mapBlockIndex.clear();
     fHavePruned = false;
+    utxoSetStats.SetNull();
+    fUTXOSetStatsValid = true;
 
     g_chainstate.UnloadBlockIndex();
 }
@@ -4985,8 +5355,9 @@ bool CChainState::LoadGenesisBlock(const CChainParams& chainparams)
         return true;
 
     try {
-        CBlock &block = const_cast<CBlock&>(chainparams.GenesisBlock());
-        CDiskBlockPos blockPos = SaveBlockToDisk(block, 0, chainparams, nullptr);
+        std::shared_ptr<const CBlock> pblock = std::make_shared<const CBlock>(chainparams.GenesisBlock());
+        const CBlock& block = *pblock;
+        CDiskBlockPos blockPos = SaveBlockToDisk(pblock, 0, chainparams, nullptr);
         if (blockPos.IsNull())
             return error("%s: writing genesis block to disk failed", __func__);
         CBlockIndex *pindex = AddToBlockIndex(block);
@@ -5336,11 +5707,21 @@ int VersionBitsTipStateSinceHeight(const Consensus::Params& params, Consensus::D
     return VersionBitsStateSinceHeight(chainActive.Tip(), params, pos, versionbitscache);
 }
 
-static const uint64_t MEMPOOL_DUMP_VERSION = 1;
+/**
+ * Version 1 is a plain list of transactions. Version 2 is a snapshot that also
+ * records the tip and script flags its entries were validated against, and
+ * ends with a hash of its contents. Loading a snapshot at the same tip with
+ * the same flags skips script verification. The hash is not keyed: it only
+ * detects a damaged file, and a snapshot is trusted like the rest of the data
+ * directory.
+ */
+static const uint64_t MEMPOOL_DUMP_VERSION_NO_SNAPSHOT = 1;
+static const uint64_t MEMPOOL_DUMP_VERSION = 2;
+/** Transactions from mempool.dat that are accepted as a batch */
+static const size_t MEMPOOL_LOAD_BATCH_SIZE = 1000;
 
 bool LoadMempool(void)
 {
-    const CChainParams& chainparams = Params();
     int64_t nExpiryTimeout = gArgs.GetArg("-mempoolexpiry", DEFAULT_MEMPOOL_EXPIRY) * 60 * 60;
     FILE* filestr = fsbridge::fopen(GetDataDir() / "mempool.dat", "rb");
     CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
@@ -5354,63 +5735,131 @@ bool LoadMempool(void)
     int64_t failed = 0;
     int64_t already_there = 0;
     int64_t nNow = GetTime();
+    bool fSnapshotAtTip = false;
 
     try {
         uint64_t version;
         file >> version;
-        if (version != MEMPOOL_DUMP_VERSION) {
+        if (version != MEMPOOL_DUMP_VERSION && version != MEMPOOL_DUMP_VERSION_NO_SNAPSHOT) {
             return false;
         }
+
+        CHashVerifier<CAutoFile> verifier(&file);
+        uint256 hashTip;
+        unsigned int nStandardFlags = 0;
+        unsigned int nBlockFlags = 0;
+        if (version == MEMPOOL_DUMP_VERSION) {
+            verifier >> hashTip;
+            verifier >> nStandardFlags;
+            verifier >> nBlockFlags;
+        }
+
+        // Read everything before accepting anything, so that a damaged
+        // snapshot is caught by its checksum first
         uint64_t num;
-        file >> num;
+        verifier >> num;
+        std::vector<CTransactionRef> vtx;
+        std::vector<int64_t> vAcceptTime;
+        std::vector<CAmount> vFeeDelta;
         while (num--) {
             CTransactionRef tx;
             int64_t nTime;
             int64_t nFeeDelta;
-            file >> tx;
-            file >> nTime;
-            file >> nFeeDelta;
+            verifier >> tx;
+            verifier >> nTime;
+            verifier >> nFeeDelta;
+            vtx.push_back(tx);
+            vAcceptTime.push_back(nTime);
+            vFeeDelta.push_back(nFeeDelta);
+        }
+        std::map<uint256, CAmount> mapDeltas;
+        verifier >> mapDeltas;
 
-            CAmount amountdelta = nFeeDelta;
+        if (version == MEMPOOL_DUMP_VERSION) {
+            uint256 hashChecksum;
+            file >> hashChecksum;
+            if (hashChecksum != verifier.GetHash()) {
+                LogPrintf("Mempool snapshot on disk is corrupted, not loading it.\n");
+                return false;
+            }
+            LOCK(cs_main);
+            const CChainParams& chainparams = Params();
+            fSnapshotAtTip = chainActive.Tip() && hashTip == chainActive.Tip()->GetBlockHash() &&
+                             nStandardFlags == GetStandardScriptFlags(chainparams) &&
+                             nBlockFlags == GetBlockScriptFlags(chainActive.Tip(), chainparams.GetConsensus());
+        }
+
+        for (size_t i = 0; i < vtx.size(); i++) {
+            CAmount amountdelta = vFeeDelta[i];
             if (amountdelta) {
-                mempool.PrioritiseTransaction(tx->GetHash(), amountdelta);
+                mempool.PrioritiseTransaction(vtx[i]->GetHash(), amountdelta);
             }
-            CValidationState state;
-            if (nTime + nExpiryTimeout > nNow) {
-                LOCK(cs_main);
-                AcceptToMemoryPoolWithTime(chainparams, mempool, state, tx, nullptr /* pfMissingInputs */, nTime,
-                                           nullptr /* plTxnReplaced */, false /* bypass_limits */, 0 /* nAbsurdFee */);
-                if (state.IsValid()) {
+        }
+
+        // Entries accepted without script checks, to be checked once the
+        // whole snapshot is in the pool
+        std::vector<CTransactionRef> vUnchecked;
+        size_t nNext = 0;
+        while (nNext < vtx.size()) {
+            std::vector<CTransactionRef> vBatch;
+            std::vector<int64_t> vBatchTime;
+            for (; nNext < vtx.size() && vBatch.size() < MEMPOOL_LOAD_BATCH_SIZE; nNext++) {
+                if (vAcceptTime[nNext] + nExpiryTimeout > nNow) {
+                    vBatch.push_back(vtx[nNext]);
+                    vBatchTime.push_back(vAcceptTime[nNext]);
+                } else {
+                    ++expired;
+                }
+            }
+
+            std::vector<CValidationState> vState;
+            AcceptToMemoryPoolBatch(mempool, vBatch, vBatchTime, false /* bypass_limits */, vState, !fSnapshotAtTip);
+            for (size_t i = 0; i < vBatch.size(); i++) {
+                if (vState[i].IsValid()) {
                     ++count;
+                    if (fSnapshotAtTip)
+                        vUnchecked.push_back(vBatch[i]);
                 } else {
                     // mempool may contain the transaction already, e.g. from
                     // wallet(s) having loaded it while we were processing
                     // mempool transactions; consider these as valid, instead of
                     // failed, but mark them as 'already there'
-                    if (mempool.exists(tx->GetHash())) {
+                    if (mempool.exists(vBatch[i]->GetHash())) {
                         ++already_there;
                     } else {
                         ++failed;
                     }
                 }
-            } else {
-                ++expired;
             }
             if (ShutdownRequested())
                 return false;
         }
-        std::map<uint256, CAmount> mapDeltas;
-        file >> mapDeltas;
 
         for (const auto& i : mapDeltas) {
             mempool.PrioritiseTransaction(i.first, i.second);
         }
+
+        // The pool is usable at this point. Checking the skipped scripts now,
+        // a batch at a time so cs_main is released in between, fills the
+        // signature and script execution caches for the blocks that will
+        // confirm these transactions, and drops any the snapshot got wrong.
+        for (size_t nBegin = 0; nBegin < vUnchecked.size(); nBegin += MEMPOOL_LOAD_BATCH_SIZE) {
+            std::vector<CTransactionRef> vBatch(vUnchecked.begin() + nBegin,
+                                                vUnchecked.begin() + std::min(nBegin + MEMPOOL_LOAD_BATCH_SIZE, vUnchecked.size()));
+            LOCK(cs_main);
+            size_t nRemoved = CheckMempoolBatchScripts(mempool, vBatch);
+            count -= nRemoved;
+            failed += nRemoved;
+            if (ShutdownRequested())
+                return false;
+        }
     } catch (const std::exception& e) {
         LogPrintf("Failed to deserialize mempool data on disk: %s. Continuing anyway.\n", e.what());
         return false;
     }
 
-    LogPrintf("Imported mempool transactions from disk: %i succeeded, %i failed, %i expired, %i already there\n", count, failed, expired, already_there);
+    LogPrintf("Imported mempool transactions from disk: %i succeeded, %i failed, %i expired, %i already there%s\n", count, failed, expired, already_there,
+              fSnapshotAtTip ? " (snapshot at tip, scripts checked after loading)" : "");
     return true;
 }
 
@@ -5420,13 +5869,23 @@ bool DumpMempool(void)
 
     std::map<uint256, CAmount> mapDeltas;
     std::vector<TxMempoolInfo> vinfo;
+    uint256 hashTip;
+    unsigned int nStandardFlags = 0;
+    unsigned int nBlockFlags = 0;
 
     {
-        LOCK(mempool.cs);
+        // Every entry was validated against this tip and these flags
+        LOCK2(cs_main, mempool.cs);
         for (const auto &i : mempool.mapDeltas) {
             mapDeltas[i.first] = i.second;
         }
         vinfo = mempool.infoAll();
+        const CChainParams& chainparams = Params();
+        if (chainActive.Tip()) {
+            hashTip = chainActive.Tip()->GetBlockHash();
+            nBlockFlags = GetBlockScriptFlags(chainActive.Tip(), chainparams.GetConsensus());
+        }
+        nStandardFlags = GetStandardScriptFlags(chainparams);
     }
 
     int64_t mid = GetTimeMicros();
@@ -5442,15 +5901,21 @@ bool DumpMempool(void)
         uint64_t version = MEMPOOL_DUMP_VERSION;
         file << version;
 
-        file << (uint64_t)vinfo.size();
+        CHashedWriter<CAutoFile> writer(&file);
+        writer << hashTip;
+        writer << nStandardFlags;
+        writer << nBlockFlags;
+
+        writer << (uint64_t)vinfo.size();
         for (const auto& i : vinfo) {
-            file << *(i.tx);
-            file << (int64_t)i.nTime;
-            file << (int64_t)i.nFeeDelta;
+            writer << *(i.tx);
+            writer << (int64_t)i.nTime;
+            writer << (int64_t)i.nFeeDelta;
             mapDeltas.erase(i.tx->GetHash());
         }
 
-        file << mapDeltas;
+        writer << mapDeltas;
+        file << writer.GetHash();
         FileCommit(file.Get());
         file.fclose();
         RenameOver(GetDataDir() / "mempool.dat.new", GetDataDir() / "mempool.dat");
@@ -5463,6 +5928,211 @@ bool DumpMempool(void)
     return true;
 }
 
+bool DumpChainstateSnapshot(const fs::path& path, CSnapshotMetadata& metadata)
+{
+    int64_t nStart = GetTimeMillis();
+
+    std::unique_ptr<CCoinsViewCursor> pcursor;
+    std::vector<std::pair<CBlockHeader, unsigned int>> vHeader;
+    CSnapshotSCDB scdbSnapshot;
+    {
+        LOCK(cs_main);
+        // The cursor keeps seeing the coins database as of this flush
+        FlushStateToDisk();
+        const CBlockIndex* pindexBase = chainActive.Tip();
+        if (!GetUTXOSetStats(metadata.stats) || metadata.stats.hashBlock != pindexBase->GetBlockHash())
+            return error("%s: UTXO set statistics are unavailable", __func__);
+        if (pcoinsdbview->GetBestBlock() != pindexBase->GetBlockHash())
+            return error("%s: coins database is behind the chain state", __func__);
+        pcursor.reset(pcoinsdbview->Cursor());
+
+        metadata.nVersion = SNAPSHOT_VERSION;
+        memcpy(metadata.messageStart, Params().MessageStart(), CMessageHeader::MESSAGE_START_SIZE);
+        metadata.hashBase = pindexBase->GetBlockHash();
+        metadata.nHeight = pindexBase->nHeight;
+
+        vHeader.reserve(metadata.nHeight);
+        for (int nHeight = 1; nHeight <= metadata.nHeight; nHeight++)
+            vHeader.emplace_back(chainActive[nHeight]->GetBlockHeader(), chainActive[nHeight]->nTx);
+
+        scdbSnapshot.data.vWithdrawalStatus = scdb.GetState();
+        scdbSnapshot.data.vActivationStatus = scdb.GetSidechainActivationStatus();
+        scdbSnapshot.data.vSidechain = scdb.GetSidechains();
+        for (const Sidechain& s : scdb.GetActiveSidechains()) {
+            std::vector<SidechainDeposit> vDeposit = scdb.GetDeposits(s.nSidechain);
+            scdbSnapshot.vDeposit.insert(scdbSnapshot.vDeposit.end(), vDeposit.begin(), vDeposit.end());
+        }
+        scdbSnapshot.vSpent = scdb.GetSpentWithdrawalCache();
+        scdbSnapshot.vFailed = scdb.GetFailedWithdrawalCache();
+        scdbSnapshot.vWithdrawalTx = scdb.GetWithdrawalTxCache();
+        metadata.hashSCDB = scdbSnapshot.GetHash();
+    }
+
+    fs::path pathTmp = path.string() + ".incomplete";
+    try {
+        CAutoFile fileout(fsbridge::fopen(pathTmp, "wb"), SER_DISK, CLIENT_VERSION);
+        if (fileout.IsNull())
+            return error("%s: unable to open %s", __func__, pathTmp.string());
+
+        fileout << metadata;
+        for (const auto& header : vHeader)
+            fileout << header.first << VARINT(header.second);
+        fileout << scdbSnapshot;
+
+        uint64_t nCoins = 0;
+        while (pcursor->Valid()) {
+            COutPoint key;
+            Coin coin;
+            if (!pcursor->GetKey(key) || !pcursor->GetValue(coin))
+                throw std::runtime_error("unable to read coins database");
+            fileout << key << coin;
+            nCoins++;
+            pcursor->Next();
+        }
+        if (nCoins != metadata.stats.nTransactionOutputs)
+            throw std::runtime_error(strprintf("wrote %u coins, expected %u", nCoins, metadata.stats.nTransactionOutputs));
+
+        FileCommit(fileout.Get());
+        fileout.fclose();
+        if (!RenameOver(pathTmp, path))
+            throw std::runtime_error("unable to rename " + pathTmp.string());
+    } catch (const std::exception& e) {
+        fs::remove(pathTmp);
+        return error("%s: %s", __func__, e.what());
+    }
+
+    LogPrintf("Dumped chainstate snapshot of block %s (height %d, %u coins) in %dms\n",
+        metadata.hashBase.ToString(), metadata.nHeight, metadata.stats.nTransactionOutputs, GetTimeMillis() - nStart);
+    return true;
+}
+
+bool CChainState::LoadSnapshot(const fs::path& path, const uint256& hashExpected, const CChainParams& chainparams)
+{
+    AssertLockHeld(cs_main);
+    int64_t nStart = GetTimeMillis();
+    const Consensus::Params& consensusParams = chainparams.GetConsensus();
+
+    if (chainActive.Height() != 0 || pcoinsTip->GetBestBlock() != chainActive.Tip()->GetBlockHash())
+        return error("%s: the chainstate is not empty", __func__);
+
+    CAutoFile filein(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull())
+        return error("%s: unable to open %s", __func__, path.string());
+
+    CSnapshotMetadata metadata;
+    CSnapshotSCDB scdbSnapshot;
+    std::vector<std::pair<CBlockIndex*, unsigned int>> vBlockTx;
+    CUTXOSetStats stats;
+    // Coins are only handed to pcoinsTip once the whole snapshot checks out
+    CCoinsViewCache cache(pcoinsTip.get());
+    try {
+        filein >> metadata;
+        if (metadata.nVersion != SNAPSHOT_VERSION)
+            return error("%s: unsupported snapshot version %u", __func__, metadata.nVersion);
+        if (memcmp(metadata.messageStart, chainparams.MessageStart(), CMessageHeader::MESSAGE_START_SIZE))
+            return error("%s: snapshot is for a different network", __func__);
+        if (metadata.nHeight <= 0 || metadata.stats.hashBlock != metadata.hashBase)
+            return error("%s: invalid snapshot metadata", __func__);
+        // Everything below is checked against the metadata, which is only
+        // trusted because of this
+        if (metadata.GetSnapshotHash() != hashExpected)
+            return error("%s: snapshot hash %s does not match the expected %s", __func__,
+                metadata.GetSnapshotHash().ToString(), hashExpected.ToString());
+
+        // The headers are validated like headers received from a peer
+        CBlockIndex* pindex = chainActive.Genesis();
+        vBlockTx.reserve(metadata.nHeight);
+        for (int nHeight = 1; nHeight <= metadata.nHeight; nHeight++) {
+            CBlockHeader header;
+            unsigned int nTx;
+            filein >> header >> VARINT(nTx);
+            CValidationState state;
+            if (header.hashPrevBlock != pindex->GetBlockHash() || nTx == 0)
+                return error("%s: invalid header at height %d", __func__, nHeight);
+            if (!AcceptBlockHeader(header, state, chainparams, &pindex))
+                return error("%s: invalid header at height %d: %s", __func__, nHeight, FormatStateMessage(state));
+            vBlockTx.emplace_back(pindex, nTx);
+        }
+        if (pindex->GetBlockHash() != metadata.hashBase)
+            return error("%s: headers do not lead to the snapshot block", __func__);
+
+        filein >> scdbSnapshot;
+        if (scdbSnapshot.GetHash() != metadata.hashSCDB)
+            return error("%s: sidechain state does not match its hash", __func__);
+
+        for (uint64_t i = 0; i < metadata.stats.nTransactionOutputs; i++) {
+            COutPoint outpoint;
+            Coin coin;
+            filein >> outpoint >> coin;
+            if (coin.IsSpent() || (int)coin.nHeight > metadata.nHeight)
+                return error("%s: invalid coin %s", __func__, outpoint.ToString());
+            stats.AddCoin(outpoint, coin);
+            cache.AddCoin(outpoint, std::move(coin), false);
+        }
+    } catch (const std::exception& e) {
+        return error("%s: unable to read snapshot: %s", __func__, e.what());
+    }
+    stats.hashBlock = metadata.hashBase;
+    if (!(stats == metadata.stats))
+        return error("%s: UTXO set hash mismatch, expected %s, got %s", __func__,
+            metadata.stats.hashRolling.ToString(), stats.hashRolling.ToString());
+
+    // Blocks below the snapshot are treated like pruned blocks: their
+    // transactions were connected and validated, but the data is missing.
+    // Nothing validates them later, and the OP_RETURN index is neither
+    // loaded from the snapshot nor rebuilt, so it starts at the next block.
+    for (const auto& item : vBlockTx) {
+        CBlockIndex* pindexSnapshot = item.first;
+        pindexSnapshot->nTx = item.second;
+        pindexSnapshot->nChainTx = pindexSnapshot->pprev->nChainTx + pindexSnapshot->nTx;
+        pindexSnapshot->RaiseValidity(BLOCK_VALID_SCRIPTS);
+        if (IsWitnessEnabled(pindexSnapshot->pprev, consensusParams))
+            pindexSnapshot->nStatus |= BLOCK_OPT_WITNESS;
+        setDirtyBlockIndex.insert(pindexSnapshot);
+    }
+    CBlockIndex* pindexBase = vBlockTx.back().first;
+    fHavePruned = true;
+    pblocktree->WriteFlag("prunedblockfiles", true);
+
+    cache.SetBestBlock(pindexBase->GetBlockHash());
+    if (!cache.Flush())
+        return error("%s: unable to write the coins", __func__);
+    utxoSetStats = stats;
+    fUTXOSetStatsValid = true;
+
+    scdb.Reset();
+    scdb.ApplyLDBData(pindexBase->GetBlockHash(), scdbSnapshot.data);
+    scdb.AddDeposits(scdbSnapshot.vDeposit);
+    scdb.AddSpentWithdrawals(scdbSnapshot.vSpent);
+    scdb.AddFailedWithdrawals(scdbSnapshot.vFailed);
+    for (const auto& withdrawal : scdbSnapshot.vWithdrawalTx)
+        scdb.CacheWithdrawalTx(CTransaction(withdrawal.second), withdrawal.first);
+    mempool.UpdateCTIPFromBlock(scdb.GetCTIP(), false /* fDisconnect */);
+    if (!psidechaintree->WriteSidechainBlockData(std::make_pair(pindexBase->GetBlockHash(), scdbSnapshot.data)))
+        return error("%s: unable to write sidechain block data", __func__);
+
+    chainActive.SetTip(pindexBase);
+    setBlockIndexCandidates.insert(pindexBase);
+    PruneBlockIndexCandidates();
+    CheckBlockIndex(consensusParams);
+
+    CValidationState state;
+    if (!FlushStateToDisk(chainparams, state, FLUSH_STATE_ALWAYS))
+        return error("%s: %s", __func__, FormatStateMessage(state));
+    DumpSCDBCache();
+
+    LogPrintf("Loaded chainstate snapshot of block %s (height %d, %u coins, UTXO set hash %s) in %dms\n",
+        pindexBase->GetBlockHash().ToString(), pindexBase->nHeight, stats.nTransactionOutputs,
+        stats.hashRolling.ToString(), GetTimeMillis() - nStart);
+    return true;
+}
+
+bool LoadChainstateSnapshot(const fs::path& path, const uint256& hashExpected, const CChainParams& chainparams)
+{
+    LOCK(cs_main);
+    return g_chainstate.LoadSnapshot(path, hashExpected, chainparams);
+}
+
 static const uint64_t SCDB_DUMP_VERSION = 1;
 
 bool LoadCustomVoteCache()
@@ -5960,9 +6630,10 @@ bool GetTxOutProof(const uint256& txid, const uint256& hashBlock, std::string& s
         return false;
     pblockindex = mapBlockIndex[hashBlock];
 
-    CBlock block;
-    if(!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
+    std::shared_ptr<const CBlock> pblock = ReadBlockFromDiskCached(pblockindex, Params().GetConsensus());
+    if (!pblock)
         return false;
+    const CBlock& block = *pblock;
 
     bool fTxFound = false;
     for (const auto& tx : block.vtx)
@@ -37,13 +37,17 @@ class CCoinsViewDB;
 class CInv;
 class CConnman;
 class CScriptCheck;
+class CSnapshotMetadata;
 class CBlockPolicyEstimator;
+class CBlockFileWriter;
+class CBlockReadCache;
 class CTxMemPool;
 class CValidationState;
 class SidechainDB;
 class SidechainWithdrawalState;
 class CSidechainTreeDB;
 class OPReturnDB;
+struct CacheStats;
 struct ChainTxData;
 
 struct PrecomputedTransactionData;
@@ -165,6 +169,10 @@ extern CScript COINBASE_FLAGS;
 extern CCriticalSection cs_main;
 extern CBlockPolicyEstimator feeEstimator;
 extern CTxMemPool mempool;
+/** Blocks recently read from disk, shared by all readers */
+extern CBlockReadCache blockReadCache;
+/** Writes new blocks to the block files in the background */
+extern CBlockFileWriter blockFileWriter;
 typedef std::unordered_map<uint256, CBlockIndex*, BlockHasher> BlockMap;
 extern BlockMap& mapBlockIndex;
 extern uint64_t nLastBlockTx;
@@ -279,6 +287,8 @@ bool LoadGenesisBlock(const CChainParams& chainparams);
 bool LoadBlockIndex(const CChainParams& chainparams);
 /** Update the chain tip based on database information. */
 bool LoadChainTip(const CChainParams& chainparams);
+/** Get the statistics of the UTXO set at the chain tip. Returns false if they are unavailable. */
+bool GetUTXOSetStats(CUTXOSetStats& stats);
 /** Compact witness block information */
 void CompactWitBlockIndex();
 /** Unload database information */
@@ -333,6 +343,21 @@ bool AcceptToMemoryPool(CTxMemPool& pool, CValidationState &state, const CTransa
                         bool* pfMissingInputs, std::list<CTransactionRef>* plTxnReplaced,
                         bool bypass_limits, const CAmount nAbsurdFee);
 
+/**
+ * (try to) add a batch of transactions to the memory pool, parents before
+ * children. The signatures of the whole batch are first verified on the
+ * script check threads, filling the signature cache, and the transactions
+ * are then accepted one at a time, so policy and drivechain checks such as
+ * deposit CTIP chaining still run in order.
+ * vAcceptTime is empty or holds the acceptance time of each transaction.
+ * vState is set to the validation state of each transaction, which is valid
+ * only if the transaction was accepted.
+ * fScriptChecks = false skips script verification, and is only for
+ * transactions already verified against the current tip and script flags.
+ */
+void AcceptToMemoryPoolBatch(CTxMemPool& pool, const std::vector<CTransactionRef>& vtx, const std::vector<int64_t>& vAcceptTime,
+                             bool bypass_limits, std::vector<CValidationState>& vState, bool fScriptChecks = true);
+
 /** Convert CValidationState to a human-readable message for logging */
 std::string FormatStateMessage(const CValidationState &state);
 
@@ -416,10 +441,25 @@ public:
 /** Initializes the script-execution cache */
 void InitScriptExecutionCache();
 
+/** Lookups of the script-execution cache, which lets blocks skip transactions checked in the mempool */
+CacheStats GetScriptExecutionCacheStats();
+
 
 /** Functions for disk access for blocks */
 bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus::Params& consensusParams);
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams);
+/**
+ * Read a block through blockReadCache. Prefer this over ReadBlockFromDisk for
+ * blocks that are only read, as recent blocks tend to be requested repeatedly
+ * by RPC, REST and peers. Returns nullptr on failure.
+ */
+std::shared_ptr<const CBlock> ReadBlockFromDiskCached(const CBlockIndex* pindex, const Consensus::Params& consensusParams);
+/**
+ * Open the block file holding the block at pos without deserializing it.
+ * The returned file is positioned at the start of the serialized block and
+ * nSize is set to its length. Returns nullptr on failure.
+ */
+FILE* OpenRawBlockFromDisk(const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart, unsigned int& nSize);
 
 /** Functions for validating blocks and updating the block tree */
 
@@ -537,6 +577,16 @@ bool DumpMempool();
 /** Load the mempool from disk. */
 bool LoadMempool();
 
+/** Write a snapshot of the chainstate at the tip to path, filling in its metadata. */
+bool DumpChainstateSnapshot(const fs::path& path, CSnapshotMetadata& metadata);
+
+/**
+ * Start an empty chainstate from the snapshot at path, if its snapshot hash is
+ * hashExpected. Blocks below the snapshot have no data afterwards, as if they
+ * had been pruned, and are not in the OP_RETURN index.
+ */
+bool LoadChainstateSnapshot(const fs::path& path, const uint256& hashExpected, const CChainParams& chainparams);
+
 /** Load cache of user set votes for withdrawals */
 bool LoadCustomVoteCache();
 
@@ -289,6 +289,9 @@ bool OpenWallets()
         vpwallets.push_back(pwallet);
     }
 
+    // Every wallet has taken its transactions from the shared file by now
+    CWallet::RemoveLegacyScheduledTransactions();
+
     return true;
 }
 
@@ -2223,6 +2223,185 @@ UniValue abandontransaction(const JSONRPCRequest& request)
     return NullUniValue;
 }
 
+UniValue scheduletransaction(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 2) {
+        throw std::runtime_error(
+            "scheduletransaction \"txid\" time\n"
+            "\nSchedule in-wallet transaction <txid> to be broadcast at a later time.\n"
+            "The transaction is broadcast by the wallet once <time> has passed, and is not\n"
+            "rebroadcast or spent from before then.\n"
+            "\nArguments:\n"
+            "1. \"txid\"    (string, required) The transaction id\n"
+            "2. time        (numeric, required) The UNIX epoch time at which to broadcast the transaction\n"
+            "\nResult:\n"
+            "\nExamples:\n"
+            + HelpExampleCli("scheduletransaction", "\"1075db55d416d3ca199f55b6084e2115b9345e16c5cf302fc80e9d5fbf5d48d\" 1700000000")
+            + HelpExampleRpc("scheduletransaction", "\"1075db55d416d3ca199f55b6084e2115b9345e16c5cf302fc80e9d5fbf5d48d\", 1700000000")
+        );
+    }
+
+    ObserveSafeMode();
+
+    LOCK2(cs_main, pwallet->cs_wallet);
+
+    uint256 hash = ParseHashV(request.params[0], "txid");
+    int64_t nTime = request.params[1].get_int64();
+
+    if (!pwallet->mapWallet.count(hash)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid or non-wallet transaction id");
+    }
+    const CWalletTx& wtx = pwallet->mapWallet[hash];
+    if (wtx.GetDepthInMainChain() != 0 || wtx.InMempool()) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Transaction already broadcast");
+    }
+    if (!pwallet->ScheduleTransaction(hash, nTime)) {
+        throw JSONRPCError(RPC_WALLET_ERROR, "Transaction already scheduled");
+    }
+
+    return NullUniValue;
+}
+
+UniValue listscheduledtransactions(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 0) {
+        throw std::runtime_error(
+            "listscheduledtransactions\n"
+            "\nList the transactions scheduled for later broadcast, earliest first.\n"
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"txid\": \"txid\",   (string) The transaction id\n"
+            "    \"time\": n,        (numeric) The UNIX epoch time at which the transaction will be broadcast\n"
+            "  }\n"
+            "  ,...\n"
+            "]\n"
+            "\nExamples:\n"
+            + HelpExampleCli("listscheduledtransactions", "")
+            + HelpExampleRpc("listscheduledtransactions", "")
+        );
+    }
+
+    UniValue ret(UniValue::VARR);
+    for (const ScheduledTransaction& scheduled : pwallet->GetScheduled()) {
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("txid", scheduled.wtxid.GetHex()));
+        obj.push_back(Pair("time", scheduled.nTime));
+        ret.push_back(obj);
+    }
+
+    return ret;
+}
+
+UniValue cancelscheduledtransaction(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 1) {
+        throw std::runtime_error(
+            "cancelscheduledtransaction \"txid\"\n"
+            "\nCancel the scheduled broadcast of in-wallet transaction <txid>.\n"
+            "The transaction stays in the wallet, and can be abandoned to respend its inputs.\n"
+            "\nArguments:\n"
+            "1. \"txid\"    (string, required) The transaction id\n"
+            "\nResult:\n"
+            "\nExamples:\n"
+            + HelpExampleCli("cancelscheduledtransaction", "\"1075db55d416d3ca199f55b6084e2115b9345e16c5cf302fc80e9d5fbf5d48d\"")
+            + HelpExampleRpc("cancelscheduledtransaction", "\"1075db55d416d3ca199f55b6084e2115b9345e16c5cf302fc80e9d5fbf5d48d\"")
+        );
+    }
+
+    ObserveSafeMode();
+
+    uint256 hash = ParseHashV(request.params[0], "txid");
+    if (!pwallet->RemoveScheduledTransaction(hash)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Transaction is not scheduled");
+    }
+
+    return NullUniValue;
+}
+
+UniValue denycoins(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 3) {
+        throw std::runtime_error(
+            "denycoins goal ( count maxdelay )\n"
+            "\nDeny the wallet's coins with a denial score below <goal>, lowest score first.\n"
+            "The denial transactions are created and signed in one batch and scheduled\n"
+            "for broadcast at random times within <maxdelay> seconds from now.\n"
+            "\nArguments:\n"
+            "1. goal        (numeric, required) Deny coins with a denial score below this\n"
+            "2. count       (numeric, optional, default=0) Maximum number of coins to deny, 0 for all\n"
+            "3. maxdelay    (numeric, optional, default=3600) Broadcast within this many seconds\n"
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"txid\": \"txid\",   (string) The denial transaction id\n"
+            "    \"time\": n,        (numeric) The UNIX epoch time at which the transaction will be broadcast\n"
+            "  }\n"
+            "  ,...\n"
+            "]\n"
+            "\nExamples:\n"
+            + HelpExampleCli("denycoins", "3")
+            + HelpExampleCli("denycoins", "3 10 600")
+            + HelpExampleRpc("denycoins", "3, 10, 600")
+        );
+    }
+
+    ObserveSafeMode();
+
+    int nGoal = request.params[0].get_int();
+    if (nGoal < 1)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid goal");
+
+    int nCount = request.params[1].isNull() ? 0 : request.params[1].get_int();
+    if (nCount < 0)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid count");
+
+    int64_t nMaxDelay = request.params[2].isNull() ? 3600 : request.params[2].get_int64();
+    if (nMaxDelay < 0)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid maxdelay");
+
+    LOCK2(cs_main, pwallet->cs_wallet);
+
+    EnsureWalletIsUnlocked(pwallet);
+
+    std::vector<COutput> vCoins = pwallet->SelectDenialCoins(nGoal, nCount);
+
+    std::vector<ScheduledTransaction> vScheduled;
+    std::string strFail;
+    if (!pwallet->CreateDenials(vCoins, nMaxDelay, vScheduled, strFail))
+        throw JSONRPCError(RPC_WALLET_ERROR, strFail);
+
+    UniValue ret(UniValue::VARR);
+    for (const ScheduledTransaction& scheduled : vScheduled) {
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("txid", scheduled.wtxid.GetHex()));
+        obj.push_back(Pair("time", scheduled.nTime));
+        ret.push_back(obj);
+    }
+
+    return ret;
+}
+
 UniValue abandonbmm(const JSONRPCRequest& request)
 {
     CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
@@ -3562,46 +3741,17 @@ UniValue generate(const JSONRPCRequest& request)
     return generateBlocks(coinbase_script, num_generate, max_tries, true);
 }
 
-UniValue createsidechaindeposit(const JSONRPCRequest& request)
+/** Parse and check the sidechain deposit arguments shared by createsidechaindeposit and queuesidechaindeposit */
+static void ParseSidechainDeposit(const JSONRPCRequest& request, unsigned int& nSidechain, std::string& strDest, CAmount& nAmount, CAmount& nFee, CScript& sidechainScriptPubKey)
 {
-    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
-    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
-        return NullUniValue;
-    }
-
-    if (request.fHelp || request.params.size() != 4)
-        throw std::runtime_error(
-            "createsidechaindeposit \"nsidechain\" \"depositaddress\" \"amount\"\n"
-            "\nCreate a sidechain deposit of an amount to a given address.\n"
-            + HelpRequiringPassphrase(pwallet) +
-            "\nArguments:\n"
-            "1. \"nsidechain\"         (numeric, required) The sidechain to send to.\n"
-            "2. \"depositaddress\"     (string, required) The sidechain deposit address to send to.\n"
-            "3. \"amount\"             (numeric or string, required) The amount in " + CURRENCY_UNIT + " to send. eg 0.1\n"
-            "4. \"fee\"                (numeric or string, required) The fee in " + CURRENCY_UNIT + "\n"
-            "\nResult:\n"
-            "\"txid\"                  (string) The transaction id.\n"
-            "\nExamples:\n"
-            + HelpExampleCli("createsidechaindeposit", "0 \"s0_1M72Sfpbz1BPpXFHz9m3CdqATR44Jvaydd_xxxxxx\" 0.1, 0.01")
-            + HelpExampleRpc("createsidechaindeposit", "0, \"s0_1M72Sfpbz1BPpXFHz9m3CdqATR44Jvaydd_xxxxxx\", 0.1, 0.01")
-        );
-
-    ObserveSafeMode();
-
     // Check sidechain number we are depositing to
-    unsigned int nSidechain = request.params[0].get_int();
+    nSidechain = request.params[0].get_int();
     if (!scdb.IsSidechainActive(nSidechain)) {
         std::string strError = "Invalid sidechain number";
         LogPrintf("%s: %s\n", __func__, strError);
         throw JSONRPCError(RPC_MISC_ERROR, strError);
     }
 
-    // Make sure the results are valid at least up to the most recent block
-    // the user could have gotten from another RPC command prior to now
-    pwallet->BlockUntilSyncedToCurrentChain();
-
-    LOCK2(cs_main, pwallet->cs_wallet);
-
     // strDepositAddress
     std::string strDepositAddress = request.params[1].get_str();
     if (strDepositAddress.empty()) {
@@ -3611,7 +3761,6 @@ UniValue createsidechaindeposit(const JSONRPCRequest& request)
     }
 
     // Get strDest from deposit address
-    std::string strDest = "";
     unsigned int nSidechainFromAddress;
     if (!ParseDepositAddress(strDepositAddress, strDest, nSidechainFromAddress)) {
         std::string strError = "Invalid sidechain deposit address - failed to parse";
@@ -3634,7 +3783,7 @@ UniValue createsidechaindeposit(const JSONRPCRequest& request)
     }
 
     // Amount
-    CAmount nAmount = AmountFromValue(request.params[2]);
+    nAmount = AmountFromValue(request.params[2]);
     if (nAmount <= 0) {
         std::string strError = "Invalid amount for send";
         LogPrintf("%s: %s\n", __func__, strError);
@@ -3642,7 +3791,7 @@ UniValue createsidechaindeposit(const JSONRPCRequest& request)
     }
 
     // Fee
-    CAmount nFee = AmountFromValue(request.params[3]);
+    nFee = AmountFromValue(request.params[3]);
     if (nFee <= 0) {
         std::string strError = "Invalid fee amount";
         LogPrintf("%s: %s\n", __func__, strError);
@@ -3650,13 +3799,52 @@ UniValue createsidechaindeposit(const JSONRPCRequest& request)
     }
 
     // Get sidechain script
-    CScript sidechainScriptPubKey;
     if (!scdb.GetSidechainScript(nSidechain, sidechainScriptPubKey))
     {
         std::string strError = "Failed to lookup sidechain script";
         LogPrintf("%s: %s\n", __func__, strError);
         throw JSONRPCError(RPC_MISC_ERROR, strError);
     }
+}
+
+UniValue createsidechaindeposit(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 4)
+        throw std::runtime_error(
+            "createsidechaindeposit \"nsidechain\" \"depositaddress\" \"amount\"\n"
+            "\nCreate a sidechain deposit of an amount to a given address.\n"
+            + HelpRequiringPassphrase(pwallet) +
+            "\nArguments:\n"
+            "1. \"nsidechain\"         (numeric, required) The sidechain to send to.\n"
+            "2. \"depositaddress\"     (string, required) The sidechain deposit address to send to.\n"
+            "3. \"amount\"             (numeric or string, required) The amount in " + CURRENCY_UNIT + " to send. eg 0.1\n"
+            "4. \"fee\"                (numeric or string, required) The fee in " + CURRENCY_UNIT + "\n"
+            "\nResult:\n"
+            "\"txid\"                  (string) The transaction id.\n"
+            "\nExamples:\n"
+            + HelpExampleCli("createsidechaindeposit", "0 \"s0_1M72Sfpbz1BPpXFHz9m3CdqATR44Jvaydd_xxxxxx\" 0.1, 0.01")
+            + HelpExampleRpc("createsidechaindeposit", "0, \"s0_1M72Sfpbz1BPpXFHz9m3CdqATR44Jvaydd_xxxxxx\", 0.1, 0.01")
+        );
+
+    ObserveSafeMode();
+
+    // Make sure the results are valid at least up to the most recent block
+    // the user could have gotten from another RPC command prior to now
+    pwallet->BlockUntilSyncedToCurrentChain();
+
+    LOCK2(cs_main, pwallet->cs_wallet);
+
+    unsigned int nSidechain;
+    std::string strDest;
+    CAmount nAmount;
+    CAmount nFee;
+    CScript sidechainScriptPubKey;
+    ParseSidechainDeposit(request, nSidechain, strDest, nAmount, nFee, sidechainScriptPubKey);
 
     EnsureWalletIsUnlocked(pwallet);
 
@@ -3671,6 +3859,141 @@ UniValue createsidechaindeposit(const JSONRPCRequest& request)
     return tx->GetHash().GetHex();
 }
 
+UniValue queuesidechaindeposit(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 4)
+        throw std::runtime_error(
+            "queuesidechaindeposit \"nsidechain\" \"depositaddress\" \"amount\" \"fee\"\n"
+            "\nQueue a sidechain deposit of an amount to a given address. Queued deposits are\n"
+            "created by sendqueuedsidechaindeposits, each spending the CTIP of the one before.\n"
+            "The queue is kept in memory only.\n"
+            "\nArguments:\n"
+            "1. \"nsidechain\"         (numeric, required) The sidechain to send to.\n"
+            "2. \"depositaddress\"     (string, required) The sidechain deposit address to send to.\n"
+            "3. \"amount\"             (numeric or string, required) The amount in " + CURRENCY_UNIT + " to send. eg 0.1\n"
+            "4. \"fee\"                (numeric or string, required) The fee in " + CURRENCY_UNIT + "\n"
+            "\nResult:\n"
+            "n                       (numeric) The number of deposits queued for the sidechain.\n"
+            "\nExamples:\n"
+            + HelpExampleCli("queuesidechaindeposit", "0 \"s0_1M72Sfpbz1BPpXFHz9m3CdqATR44Jvaydd_xxxxxx\" 0.1, 0.01")
+            + HelpExampleRpc("queuesidechaindeposit", "0, \"s0_1M72Sfpbz1BPpXFHz9m3CdqATR44Jvaydd_xxxxxx\", 0.1, 0.01")
+        );
+
+    ObserveSafeMode();
+
+    LOCK2(cs_main, pwallet->cs_wallet);
+
+    unsigned int nSidechain;
+    std::string strDest;
+    CAmount nAmount;
+    CAmount nFee;
+    CScript sidechainScriptPubKey;
+    ParseSidechainDeposit(request, nSidechain, strDest, nAmount, nFee, sidechainScriptPubKey);
+
+    std::string strFail = "";
+    if (!pwallet->QueueSidechainDeposit(strFail, sidechainScriptPubKey, nSidechain, nAmount, nFee, strDest))
+    {
+        LogPrintf("%s: %s\n", __func__, strFail);
+        throw JSONRPCError(RPC_MISC_ERROR, strFail);
+    }
+
+    return (uint64_t)pwallet->GetQueuedSidechainDeposits(nSidechain).size();
+}
+
+UniValue sendqueuedsidechaindeposits(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 1)
+        throw std::runtime_error(
+            "sendqueuedsidechaindeposits \"nsidechain\"\n"
+            "\nCreate the deposits queued for a sidechain as a chain of CTIP spends and\n"
+            "submit them together. If any of them is rejected none are sent: the chain\n"
+            "is marked abandoned in the wallet, and the queue is kept.\n"
+            + HelpRequiringPassphrase(pwallet) +
+            "\nArguments:\n"
+            "1. \"nsidechain\"         (numeric, required) The sidechain to send to.\n"
+            "\nResult:\n"
+            "[\n"
+            "  \"txid\"                (string) The deposit transaction ids, in CTIP order\n"
+            "  ,...\n"
+            "]\n"
+            "\nExamples:\n"
+            + HelpExampleCli("sendqueuedsidechaindeposits", "0")
+            + HelpExampleRpc("sendqueuedsidechaindeposits", "0")
+        );
+
+    ObserveSafeMode();
+
+    unsigned int nSidechain = request.params[0].get_int();
+    if (!scdb.IsSidechainActive(nSidechain)) {
+        std::string strError = "Invalid sidechain number";
+        LogPrintf("%s: %s\n", __func__, strError);
+        throw JSONRPCError(RPC_MISC_ERROR, strError);
+    }
+
+    // Make sure the results are valid at least up to the most recent block
+    // the user could have gotten from another RPC command prior to now
+    pwallet->BlockUntilSyncedToCurrentChain();
+
+    LOCK2(cs_main, pwallet->cs_wallet);
+
+    EnsureWalletIsUnlocked(pwallet);
+
+    std::vector<CTransactionRef> vtx;
+    std::string strFail = "";
+    if (!pwallet->CreateQueuedSidechainDeposits(vtx, strFail, nSidechain))
+    {
+        LogPrintf("%s: %s\n", __func__, strFail);
+        throw JSONRPCError(RPC_MISC_ERROR, strFail);
+    }
+
+    UniValue ret(UniValue::VARR);
+    for (const CTransactionRef& tx : vtx)
+        ret.push_back(tx->GetHash().GetHex());
+
+    return ret;
+}
+
+UniValue clearqueuedsidechaindeposits(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() != 1)
+        throw std::runtime_error(
+            "clearqueuedsidechaindeposits \"nsidechain\"\n"
+            "\nDrop the deposits queued for a sidechain.\n"
+            "\nArguments:\n"
+            "1. \"nsidechain\"         (numeric, required) The sidechain.\n"
+            "\nResult:\n"
+            "n                       (numeric) The number of deposits dropped.\n"
+            "\nExamples:\n"
+            + HelpExampleCli("clearqueuedsidechaindeposits", "0")
+            + HelpExampleRpc("clearqueuedsidechaindeposits", "0")
+        );
+
+    unsigned int nSidechain = request.params[0].get_int();
+    if (nSidechain > std::numeric_limits<uint8_t>::max())
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid sidechain number");
+
+    LOCK(pwallet->cs_wallet);
+    const size_t nQueued = pwallet->GetQueuedSidechainDeposits(nSidechain).size();
+    pwallet->ClearQueuedSidechainDeposits(nSidechain);
+
+    return (uint64_t)nQueued;
+}
+
 UniValue createopreturntransaction(const JSONRPCRequest& request)
 {
     CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
@@ -4070,6 +4393,8 @@ static const CRPCCommand commands[] =
     { "hidden",             "addwitnessaddress",          &addwitnessaddress,          {"address","p2sh"} },
     { "wallet",             "backupwallet",               &backupwallet,               {"destination"} },
     { "wallet",             "bumpfee",                    &bumpfee,                    {"txid", "options"} },
+    { "wallet",             "cancelscheduledtransaction", &cancelscheduledtransaction, {"txid"} },
+    { "wallet",             "denycoins",                  &denycoins,                  {"goal","count","maxdelay"} },
     { "wallet",             "dumpprivkey",                &dumpprivkey,                {"address"}  },
     { "wallet",             "dumpwallet",                 &dumpwallet,                 {"filename"} },
     { "wallet",             "encryptwallet",              &encryptwallet,              {"passphrase"} },
@@ -4096,12 +4421,14 @@ static const CRPCCommand commands[] =
     { "wallet",             "listlockunspent",            &listlockunspent,            {} },
     { "wallet",             "listreceivedbyaccount",      &listreceivedbyaccount,      {"minconf","include_empty","include_watchonly"} },
     { "wallet",             "listreceivedbyaddress",      &listreceivedbyaddress,      {"minconf","include_empty","include_watchonly"} },
+    { "wallet",             "listscheduledtransactions",  &listscheduledtransactions,  {} },
     { "wallet",             "listsinceblock",             &listsinceblock,             {"blockhash","target_confirmations","include_watchonly","include_removed"} },
     { "wallet",             "listtransactions",           &listtransactions,           {"account","count","skip","include_watchonly"} },
     { "wallet",             "listunspent",                &listunspent,                {"minconf","maxconf","addresses","include_unsafe","query_options"} },
     { "wallet",             "listwallets",                &listwallets,                {} },
     { "wallet",             "lockunspent",                &lockunspent,                {"unlock","transactions"} },
     { "wallet",             "move",                       &movecmd,                    {"fromaccount","toaccount","amount","minconf","comment"} },
+    { "wallet",             "scheduletransaction",        &scheduletransaction,        {"txid","time"} },
     { "wallet",             "sendfrom",                   &sendfrom,                   {"fromaccount","toaddress","amount","minconf","comment","comment_to"} },
     { "wallet",             "sendmany",                   &sendmany,                   {"fromaccount","amounts","minconf","comment","subtractfeefrom","replaceable","conf_target","estimate_mode"} },
     { "wallet",             "sendtoaddress",              &sendtoaddress,              {"address","amount","comment","comment_to","subtractfeefromamount","replaceable","conf_target","estimate_mode"} },
@@ -4117,6 +4444,9 @@ static const CRPCCommand commands[] =
     { "generating",         "generate",                   &generate,                   {"nblocks","maxtries"} },
 
     { "Drivechain",         "createsidechaindeposit",     &createsidechaindeposit,     {"nSidechain", "depositaddress", "amount", "fee"} },
+    { "Drivechain",         "queuesidechaindeposit",      &queuesidechaindeposit,      {"nSidechain", "depositaddress", "amount", "fee"} },
+    { "Drivechain",         "sendqueuedsidechaindeposits", &sendqueuedsidechaindeposits, {"nSidechain"} },
+    { "Drivechain",         "clearqueuedsidechaindeposits", &clearqueuedsidechaindeposits, {"nSidechain"} },
     { "Drivechain",         "createbmmcriticaldatatx",    &createbmmcriticaldatatx,    {"amount", "height", "criticalhash", "nsidechain"}},
 
     { "CoinNews",           "createopreturntransaction",  &createopreturntransaction,  {"text", "fee"} },
@@ -11,6 +11,7 @@
 
 #include <consensus/validation.h>
 #include <rpc/server.h>
+#include <sidechaindb.h>
 #include <test/test_drivechain.h>
 #include <validation.h>
 #include <wallet/coincontrol.h>
@@ -599,6 +600,47 @@ BOOST_AUTO_TEST_CASE(LoadReceiveRequests)
     BOOST_CHECK_EQUAL(values[1], "val_rr1");
 }
 
+BOOST_AUTO_TEST_CASE(ScheduledTransactions)
+{
+    CMutableTransaction tx1, tx2;
+    tx1.nLockTime = 1;
+    tx2.nLockTime = 2;
+    CWalletTx wtx1(pwalletMain.get(), MakeTransactionRef(tx1));
+    CWalletTx wtx2(pwalletMain.get(), MakeTransactionRef(tx2));
+    pwalletMain->AddToWallet(wtx1);
+    pwalletMain->AddToWallet(wtx2);
+
+    BOOST_CHECK(pwalletMain->ScheduleTransaction(wtx1.GetHash(), 2000));
+    BOOST_CHECK(pwalletMain->ScheduleTransaction(wtx2.GetHash(), 1000));
+
+    // Duplicates and transactions not in the wallet are rejected
+    BOOST_CHECK(!pwalletMain->ScheduleTransaction(wtx1.GetHash(), 3000));
+    BOOST_CHECK(!pwalletMain->ScheduleTransaction(GetRandHash(), 3000));
+
+    // Listed earliest first
+    std::vector<ScheduledTransaction> vScheduled = pwalletMain->GetScheduled();
+    BOOST_REQUIRE_EQUAL(vScheduled.size(), 2U);
+    BOOST_CHECK(vScheduled[0].wtxid == wtx2.GetHash());
+    BOOST_CHECK_EQUAL(vScheduled[0].nTime, 1000);
+    BOOST_CHECK(vScheduled[1].wtxid == wtx1.GetHash());
+
+    BOOST_CHECK(pwalletMain->RemoveScheduledTransaction(wtx2.GetHash()));
+    BOOST_CHECK(!pwalletMain->RemoveScheduledTransaction(wtx2.GetHash()));
+    BOOST_CHECK(!pwalletMain->IsScheduled(wtx2.GetHash()));
+    BOOST_CHECK(pwalletMain->IsScheduled(wtx1.GetHash()));
+
+    // A due transaction that fails to broadcast stays scheduled for a retry,
+    // and transactions that are not due yet are left alone
+    BOOST_CHECK(pwalletMain->ScheduleTransaction(wtx2.GetHash(), 500));
+    SetMockTime(1500);
+    pwalletMain->ProcessScheduled();
+    BOOST_CHECK(pwalletMain->IsScheduled(wtx1.GetHash()));
+    BOOST_CHECK(pwalletMain->IsScheduled(wtx2.GetHash()));
+    BOOST_CHECK_EQUAL(pwalletMain->GetScheduled()[0].nTime, 500);
+
+    SetMockTime(0);
+}
+
 class ListCoinsTestingSetup : public TestChain100Setup
 {
 public:
@@ -702,4 +744,240 @@ BOOST_FIXTURE_TEST_CASE(ListCoins, ListCoinsTestingSetup)
     BOOST_CHECK_EQUAL(list.begin()->second.size(), 2);
 }
 
+BOOST_FIXTURE_TEST_CASE(AvailableCoinsAbandoned, ListCoinsTestingSetup)
+{
+    auto countAvailable = [this]() {
+        LOCK2(cs_main, wallet->cs_wallet);
+        std::vector<COutput> available;
+        wallet->AvailableCoins(available);
+        return available.size();
+    };
+    BOOST_CHECK_EQUAL(countAvailable(), 1U);
+
+    // Spend the coin in a transaction that never reaches the mempool
+    CWalletTx wtx;
+    CReserveKey reservekey(wallet.get());
+    CAmount fee;
+    int changePos = -1;
+    std::string error;
+    CCoinControl dummy;
+    BOOST_CHECK(wallet->CreateTransaction({CRecipient{GetScriptForRawPubKey({}), 1 * COIN, false}}, wtx, reservekey, fee, changePos, error, dummy));
+    BOOST_CHECK(wallet->AddToWallet(wtx));
+    BOOST_CHECK_EQUAL(countAvailable(), 0U);
+
+    // Abandoning the spend makes the coin available again
+    BOOST_CHECK(wallet->AbandonTransaction(wtx.GetHash()));
+    BOOST_CHECK_EQUAL(countAvailable(), 1U);
+}
+
+BOOST_FIXTURE_TEST_CASE(DenyCoins, ListCoinsTestingSetup)
+{
+    wallet->SetBroadcastTransactions(true);
+
+    // One mature coinbase coin, which has never been denied
+    std::vector<COutput> vCoins = wallet->SelectDenialCoins(1);
+    BOOST_REQUIRE_EQUAL(vCoins.size(), 1U);
+    BOOST_CHECK(wallet->SelectDenialCoins(0).empty());
+
+    SetMockTime(1000);
+    std::vector<ScheduledTransaction> vScheduled;
+    std::string strFail;
+    BOOST_CHECK(wallet->CreateDenials(vCoins, 600, vScheduled, strFail));
+    BOOST_REQUIRE_EQUAL(vScheduled.size(), 1U);
+    BOOST_CHECK(vScheduled[0].nTime >= 1000 && vScheduled[0].nTime < 1600);
+    BOOST_CHECK(wallet->IsScheduled(vScheduled[0].wtxid));
+    {
+        LOCK(wallet->cs_wallet);
+        const CWalletTx& wtx = wallet->mapWallet.at(vScheduled[0].wtxid);
+        BOOST_CHECK_EQUAL(wtx.nDenial, 1U);
+        BOOST_CHECK(wtx.tx->vin[0].prevout == COutPoint(vCoins[0].tx->GetHash(), vCoins[0].i));
+    }
+
+    // The denied coin is spent, and its replacements are not broadcast yet
+    BOOST_CHECK(wallet->SelectDenialCoins(1).empty());
+    SetMockTime(0);
+}
+
+BOOST_FIXTURE_TEST_CASE(DenyCoinsFailure, ListCoinsTestingSetup)
+{
+    wallet->SetBroadcastTransactions(true);
+
+    std::vector<COutput> vCoins = wallet->SelectDenialCoins(1);
+    BOOST_REQUIRE_EQUAL(vCoins.size(), 1U);
+
+    // A coin paying to a key the wallet does not have can't be signed for,
+    // which fails the batch after the first denial has been built
+    CKey keyForeign;
+    keyForeign.MakeNewKey(true);
+    CMutableTransaction mtxForeign;
+    mtxForeign.vin.resize(1);
+    mtxForeign.vout.emplace_back(COIN, GetScriptForDestination(keyForeign.GetPubKey().GetID()));
+    CWalletTx wtxForeign(wallet.get(), MakeTransactionRef(std::move(mtxForeign)));
+    vCoins.emplace_back(&wtxForeign, 0, 1, true, true, true);
+
+    size_t nWalletTx;
+    {
+        LOCK(wallet->cs_wallet);
+        nWalletTx = wallet->mapWallet.size();
+    }
+    std::vector<ScheduledTransaction> vScheduled;
+    std::string strFail;
+    BOOST_CHECK(!wallet->CreateDenials(vCoins, 600, vScheduled, strFail));
+    BOOST_CHECK(vScheduled.empty());
+
+    // Nothing of the batch is kept, so nothing can be rebroadcast early
+    {
+        LOCK(wallet->cs_wallet);
+        BOOST_CHECK_EQUAL(wallet->mapWallet.size(), nWalletTx);
+    }
+    BOOST_CHECK(wallet->GetScheduled().empty());
+    BOOST_CHECK_EQUAL(wallet->SelectDenialCoins(1).size(), 1U);
+}
+
+static bool IsSidechainDeposit(const CWalletTx& wtx, const uint8_t nSidechain)
+{
+    uint8_t nSidechainOut;
+    for (const CTxOut& out : wtx.tx->vout) {
+        if (out.scriptPubKey.IsDrivechain(nSidechainOut) && nSidechainOut == nSidechain)
+            return true;
+    }
+    return false;
+}
+
+BOOST_FIXTURE_TEST_CASE(QueuedSidechainDeposits, ListCoinsTestingSetup)
+{
+    // Mature a second coinbase output, so each deposit has a coin of its own
+    CreateAndProcessBlock({}, GetScriptForRawPubKey(coinbaseKey.GetPubKey()));
+
+    Sidechain proposal;
+    proposal.nSidechain = 0;
+    proposal.nVersion = 0;
+    proposal.title = "Test";
+    proposal.description = "Description";
+    proposal.hashID1 = uint256S("b55d224f1fda033d930c92b1b40871f209387355557dd5e0d2b5dd9bb813c33f");
+    proposal.hashID2 = uint160S("31d98584f3c570961359c308619f5cf2e9178482");
+    BOOST_REQUIRE(ActivateSidechain(scdb, proposal, chainActive.Height()));
+    CScript sidechainScript;
+    BOOST_REQUIRE(scdb.GetSidechainScript(0, sidechainScript));
+
+    wallet->SetBroadcastTransactions(true);
+    std::string strFail;
+
+    // The second deposit pays an absurd fee, so the mempool takes the first
+    // one and rejects the second
+    BOOST_CHECK(wallet->QueueSidechainDeposit(strFail, sidechainScript, 0, COIN, 100000, "dest1"));
+    BOOST_CHECK(wallet->QueueSidechainDeposit(strFail, sidechainScript, 0, COIN, maxTxFee + COIN, "dest2"));
+    std::vector<CTransactionRef> vtx;
+    BOOST_CHECK(!wallet->CreateQueuedSidechainDeposits(vtx, strFail, 0));
+    BOOST_CHECK(vtx.empty());
+
+    // The first deposit was taken back out of the mempool along with its
+    // CTIP, the chain is abandoned and the queue is kept
+    SidechainCTIP ctip;
+    BOOST_CHECK_EQUAL(mempool.size(), 0U);
+    BOOST_CHECK(!mempool.GetMemPoolCTIP(0, ctip));
+    BOOST_CHECK_EQUAL(wallet->GetQueuedSidechainDeposits(0).size(), 2U);
+    {
+        LOCK(wallet->cs_wallet);
+        int nDeposits = 0;
+        for (const auto& entry : wallet->mapWallet) {
+            if (!IsSidechainDeposit(entry.second, 0))
+                continue;
+            BOOST_CHECK(entry.second.isAbandoned());
+            BOOST_CHECK(!entry.second.InMempool());
+            nDeposits++;
+        }
+        BOOST_CHECK_EQUAL(nDeposits, 2);
+    }
+
+    // The coins of the abandoned chain can be spent by the next attempt
+    wallet->ClearQueuedSidechainDeposits(0);
+    BOOST_CHECK(wallet->QueueSidechainDeposit(strFail, sidechainScript, 0, COIN, 100000, "dest1"));
+    BOOST_CHECK(wallet->QueueSidechainDeposit(strFail, sidechainScript, 0, COIN, 100000, "dest2"));
+    BOOST_CHECK(wallet->CreateQueuedSidechainDeposits(vtx, strFail, 0));
+    BOOST_REQUIRE_EQUAL(vtx.size(), 2U);
+    BOOST_CHECK_EQUAL(mempool.size(), 2U);
+    BOOST_CHECK(wallet->GetQueuedSidechainDeposits(0).empty());
+
+    // Each deposit spends the CTIP of the one before it
+    const COutPoint ctipFirst(vtx[0]->GetHash(), vtx[0]->vout.size() - 1);
+    bool fSpendsFirst = false;
+    for (const CTxIn& txin : vtx[1]->vin)
+        fSpendsFirst |= txin.prevout == ctipFirst;
+    BOOST_CHECK(fSpendsFirst);
+    BOOST_REQUIRE(mempool.GetMemPoolCTIP(0, ctip));
+    BOOST_CHECK(ctip.out == COutPoint(vtx[1]->GetHash(), vtx[1]->vout.size() - 1));
+    BOOST_CHECK_EQUAL(ctip.amount, 2 * COIN);
+}
+
+/** A wallet in the mock database environment deriving its keys from seed */
+static std::unique_ptr<CWallet> MakeHDWallet(const std::string& strFile, const CKey& seed, unsigned int nKeyPool)
+{
+    std::unique_ptr<CWallet> pwallet(new CWallet(std::unique_ptr<CWalletDBWrapper>(new CWalletDBWrapper(&bitdb, strFile))));
+    bool fFirstRun;
+    pwallet->LoadWallet(fFirstRun);
+    AddKey(*pwallet, seed);
+    pwallet->SetHDMasterKey(seed.GetPubKey());
+    pwallet->TopUpKeyPool(nKeyPool);
+    return pwallet;
+}
+
+static CMutableTransaction SpendToKey(const COutPoint& prevout, const CKey& keyFrom, const CAmount& nValueIn, const CKeyID& keyTo)
+{
+    CScript scriptFrom = GetScriptForRawPubKey(keyFrom.GetPubKey());
+    CMutableTransaction mtx;
+    mtx.vin.emplace_back(prevout);
+    mtx.vout.emplace_back(COIN, GetScriptForDestination(keyTo));
+    mtx.vout.emplace_back(nValueIn - COIN - 10000, scriptFrom);
+    std::vector<unsigned char> vchSig;
+    uint256 hash = SignatureHash(scriptFrom, mtx, 0, SIGHASH_ALL, nValueIn, SIGVERSION_BASE);
+    BOOST_CHECK(keyFrom.Sign(hash, vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    mtx.vin[0].scriptSig << vchSig;
+    return mtx;
+}
+
+BOOST_FIXTURE_TEST_CASE(rescan_keypool_topup, ListCoinsTestingSetup)
+{
+    gArgs.ForceSetArg("-keypool", "2");
+    CKey seed;
+    seed.MakeNewKey(true);
+
+    // The first three keys derived from the seed, in order
+    std::vector<CKeyID> vKeys;
+    {
+        std::unique_ptr<CWallet> walletKeys = MakeHDWallet("wallet_keys.dat", seed, 3);
+        LOCK(walletKeys->cs_wallet);
+        std::map<int64_t, CKeyID> mapIndexKey;
+        for (const auto& entry : walletKeys->GetAllReserveKeys())
+            mapIndexKey.emplace(entry.second, entry.first);
+        for (const auto& entry : mapIndexKey)
+            vKeys.push_back(entry.second);
+    }
+    BOOST_REQUIRE_EQUAL(vKeys.size(), 3U);
+
+    // One block pays the last key of a two key pool, then a key that is only
+    // derived once the pool is topped up after the first payment is seen
+    const CAmount nValueIn = coinbaseTxns[0].vout[0].nValue;
+    CMutableTransaction tx1 = SpendToKey(COutPoint(coinbaseTxns[0].GetHash(), 0), coinbaseKey, nValueIn, vKeys[1]);
+    CMutableTransaction tx2 = SpendToKey(COutPoint(tx1.GetHash(), 1), coinbaseKey, tx1.vout[1].nValue, vKeys[2]);
+    CreateAndProcessBlock({tx1, tx2}, GetScriptForRawPubKey(coinbaseKey.GetPubKey()));
+
+    std::unique_ptr<CWallet> walletRestored = MakeHDWallet("wallet_restored.dat", seed, 2);
+    {
+        LOCK(walletRestored->cs_wallet);
+        BOOST_CHECK(!walletRestored->HaveKey(vKeys[2]));
+    }
+    WalletRescanReserver reserver(walletRestored.get());
+    reserver.reserve();
+    BOOST_CHECK(walletRestored->ScanForWalletTransactions(chainActive.Tip(), nullptr, reserver) == nullptr);
+    {
+        LOCK(walletRestored->cs_wallet);
+        BOOST_CHECK(walletRestored->HaveKey(vKeys[2]));
+        BOOST_CHECK(walletRestored->mapWallet.count(tx1.GetHash()));
+        BOOST_CHECK(walletRestored->mapWallet.count(tx2.GetHash()));
+    }
+    gArgs.ForceSetArg("-keypool", std::to_string(DEFAULT_KEYPOOL_SIZE));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
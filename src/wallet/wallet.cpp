@@ -35,6 +35,7 @@
 #include <assert.h>
 #include <future>
 
+#include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/thread.hpp>
 
@@ -245,6 +246,7 @@ bool CWallet::AddKeyPubKeyWithDB(CWalletDB &walletdb, const CKey& secret, const
         return false;
     }
     if (needsDB) pwalletdbEncryption = nullptr;
+    nKeyStoreUpdates++;
 
     // check if we need to remove from watch-only
     CScript script;
@@ -330,6 +332,7 @@ bool CWallet::AddCScript(const CScript& redeemScript)
 {
     if (!CCryptoKeyStore::AddCScript(redeemScript))
         return false;
+    nKeyStoreUpdates++;
     return CWalletDB(*dbw).WriteCScript(Hash160(redeemScript), redeemScript);
 }
 
@@ -353,6 +356,7 @@ bool CWallet::AddWatchOnly(const CScript& dest)
 {
     if (!CCryptoKeyStore::AddWatchOnly(dest))
         return false;
+    nKeyStoreUpdates++;
     const CKeyMetadata& meta = m_script_metadata[CScriptID(dest)];
     UpdateTimeFirstKey(meta.nCreateTime);
     NotifyWatchonlyChanged(true);
@@ -370,6 +374,7 @@ bool CWallet::RemoveWatchOnly(const CScript &dest)
     AssertLockHeld(cs_wallet);
     if (!CCryptoKeyStore::RemoveWatchOnly(dest))
         return false;
+    nKeyStoreUpdates++;
     if (!HaveWatchOnly())
         NotifyWatchonlyChanged(false);
     if (!CWalletDB(*dbw).EraseWatchOnly(dest))
@@ -523,72 +528,145 @@ bool CWallet::HasWalletSpend(const uint256& txid) const
     return (iter != mapTxSpends.end() && iter->first.hash == txid);
 }
 
-bool CWallet::LoadScheduledTransactions()
+/** Scheduled transaction as stored by the old scheduledtx.dat file */
+struct LegacyScheduledTransaction
 {
-    LOCK(cs_wallet);
-    fs::path path = GetDataDir() / "drivechain" / "scheduledtx.dat";
-    CAutoFile filein(fsbridge::fopen(path, "r"), SER_DISK, CLIENT_VERSION);
+    std::string strTime;
+    uint256 wtxid;
+
+    ADD_SERIALIZE_METHODS
+
+    template<typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(strTime);
+        READWRITE(wtxid);
+    }
+};
+
+/** Parse a local time written in SCHEDULED_TX_TIME_FORMAT, e.g. "Tue January 4 2022 3:07 pm" */
+static bool ParseLegacyScheduledTime(const std::string& strTime, int64_t& nTime)
+{
+    static const std::vector<std::string> vMonth = {"january", "february", "march", "april", "may", "june",
+        "july", "august", "september", "october", "november", "december"};
+
+    std::vector<std::string> vField;
+    boost::split(vField, strTime, boost::is_any_of(" "), boost::token_compress_on);
+    if (vField.size() != 6)
+        return false;
+
+    struct tm tmTime = {};
+    auto itMonth = std::find(vMonth.begin(), vMonth.end(), boost::to_lower_copy(vField[1]));
+    if (itMonth == vMonth.end())
+        return false;
+    tmTime.tm_mon = itMonth - vMonth.begin();
+
+    int nDay, nYear, nHour, nMinute;
+    std::vector<std::string> vClock;
+    boost::split(vClock, vField[4], boost::is_any_of(":"));
+    if (!ParseInt32(vField[2], &nDay) || !ParseInt32(vField[3], &nYear) || vClock.size() != 2 ||
+            !ParseInt32(vClock[0], &nHour) || !ParseInt32(vClock[1], &nMinute) || nHour < 1 || nHour > 12)
+        return false;
+
+    const std::string strPeriod = boost::to_lower_copy(vField[5]);
+    if (strPeriod != "am" && strPeriod != "pm")
+        return false;
+    tmTime.tm_mday = nDay;
+    tmTime.tm_year = nYear - 1900;
+    tmTime.tm_hour = nHour % 12 + (strPeriod == "pm" ? 12 : 0);
+    tmTime.tm_min = nMinute;
+    tmTime.tm_isdst = -1;
+
+    time_t t = mktime(&tmTime);
+    if (t == -1)
+        return false;
+    nTime = t;
+    return true;
+}
+
+static fs::path GetLegacyScheduledPath()
+{
+    return GetDataDir() / "drivechain" / "scheduledtx.dat";
+}
+
+bool CWallet::MigrateScheduledTransactions()
+{
+    // The file is shared by all wallets, each takes the transactions it has.
+    // It is removed by RemoveLegacyScheduledTransactions once all are loaded.
+    CAutoFile filein(fsbridge::fopen(GetLegacyScheduledPath(), "rb"), SER_DISK, CLIENT_VERSION);
     if (filein.IsNull()) {
         return true;
     }
 
-    std::vector<ScheduledTransaction> vScheduledIn;
+    std::vector<LegacyScheduledTransaction> vLegacy;
     try {
         uint64_t nVersion;
         filein >> nVersion;
-        if (nVersion != SCHEDULED_TX_DUMP_VERSION) {
+        if (nVersion != 0) {
             return false;
         }
 
         int count = 0;
         filein >> count;
         for (int i = 0; i < count; i++) {
-            ScheduledTransaction tx;
+            LegacyScheduledTransaction tx;
             filein >> tx;
-            vScheduledIn.push_back(tx);
+            vLegacy.push_back(tx);
         }
     }
     catch (const std::exception& e) {
         LogPrintf("%s: Exception: %s\n", __func__, e.what());
         return false;
     }
+    filein.fclose();
+
+    unsigned int nMoved = 0;
+    for (const LegacyScheduledTransaction& tx : vLegacy) {
+        {
+            LOCK(cs_wallet);
+            if (!mapWallet.count(tx.wtxid) || mapScheduled.count(tx.wtxid))
+                continue;
+        }
+        int64_t nTime;
+        if (!ParseLegacyScheduledTime(tx.strTime, nTime)) {
+            LogPrintf("%s: Dropping %s, invalid time %s\n", __func__, tx.wtxid.ToString(), tx.strTime);
+            continue;
+        }
+        if (ScheduleTransaction(tx.wtxid, nTime))
+            nMoved++;
+    }
 
-    vScheduled = vScheduledIn;
+    LogPrintf("%s: Moved %u of %u scheduled transactions into %s\n", __func__, nMoved, vLegacy.size(), GetName());
 
     return true;
 }
 
-void CWallet::WriteScheduledTransactions()
+void CWallet::RemoveLegacyScheduledTransactions()
 {
-    int count = vScheduled.size();
-
-    // Write
-    fs::path path = GetDataDir() / "drivechain" / "scheduledtx.dat.new";
-    CAutoFile fileout(fsbridge::fopen(path, "w"), SER_DISK, CLIENT_VERSION);
-    if (fileout.IsNull()) {
-        return;
+    fs::path path = GetLegacyScheduledPath();
+    if (fs::exists(path)) {
+        fs::remove(path);
+        LogPrintf("%s: Removed %s\n", __func__, path.string());
     }
+}
 
-    try {
-        fileout << SCHEDULED_TX_DUMP_VERSION; // version required to read
-        fileout << count; // Number of tx in file
+void CWallet::ScheduleNextBroadcast()
+{
+    AssertLockHeld(cs_wallet);
 
-        for (const ScheduledTransaction& tx : vScheduled) {
-            fileout << tx;
-        }
-    }
-    catch (const std::exception& e) {
-        LogPrintf("%s: Exception: %s\n", __func__, e.what());
-    }
+    if (!pscheduler || queueScheduled.empty())
+        return;
 
-    FileCommit(fileout.Get());
-    fileout.fclose();
-    RenameOver(GetDataDir() / "drivechain" / "scheduledtx.dat.new", GetDataDir() /  "drivechain" / "scheduledtx.dat");
+    // An earlier wakeup will register the next one when it runs
+    const int64_t nNext = queueScheduled.top().first;
+    if (nScheduledWakeup && nScheduledWakeup <= nNext)
+        return;
 
-    LogPrintf("%s: Wrote %u\n", __func__, count);
+    nScheduledWakeup = nNext;
+    pscheduler->schedule(std::bind(&CWallet::ProcessScheduled, this),
+            boost::chrono::system_clock::from_time_t(nNext));
 }
 
-bool CWallet::ScheduleTransaction(const uint256& wtxid, const std::string& strTime)
+bool CWallet::ScheduleTransaction(const uint256& wtxid, int64_t nTime)
 {
     LOCK2(cs_main, cs_wallet);
 
@@ -596,45 +674,60 @@ bool CWallet::ScheduleTransaction(const uint256& wtxid, const std::string& strTi
         return false;
 
     // Check for duplicate
-    for (const ScheduledTransaction& s : vScheduled) {
-        if (s.wtxid == wtxid)
-            return false;
-    }
+    if (mapScheduled.count(wtxid))
+        return false;
 
-    ScheduledTransaction schedule;
-    schedule.wtxid = wtxid;
-    schedule.strTime = strTime;
+    ScheduledTransaction scheduled(wtxid, nTime);
+    if (!CWalletDB(*dbw).WriteScheduledTransaction(scheduled))
+        return false;
 
-    vScheduled.push_back(schedule);
+    LoadScheduledTransaction(scheduled);
+    ScheduleNextBroadcast();
 
     return true;
 }
 
-void CWallet::RemoveScheduledTransaction(const ScheduledTransaction& scheduled)
+void CWallet::LoadScheduledTransaction(const ScheduledTransaction& scheduled)
+{
+    AssertLockHeld(cs_wallet);
+
+    mapScheduled[scheduled.wtxid] = scheduled.nTime;
+    queueScheduled.emplace(scheduled.nTime, scheduled.wtxid);
+}
+
+bool CWallet::RemoveScheduledTransaction(const uint256& wtxid)
 {
     LOCK2(cs_main, cs_wallet);
 
-    for (size_t i = 0; i < vScheduled.size(); i++) {
-        if (vScheduled[i].wtxid == scheduled.wtxid) {
-            vScheduled[i] = vScheduled.back();
-            vScheduled.pop_back();
-            break;
-        }
-    }
+    // Any queued entry is skipped once it is no longer in mapScheduled
+    if (!mapScheduled.erase(wtxid))
+        return false;
+
+    CWalletDB(*dbw).EraseScheduledTransaction(wtxid);
+
+    return true;
 }
 
 std::vector<ScheduledTransaction> CWallet::GetScheduled() const
 {
+    LOCK(cs_wallet);
+
+    std::vector<ScheduledTransaction> vScheduled;
+    vScheduled.reserve(mapScheduled.size());
+    for (const auto& item : mapScheduled)
+        vScheduled.emplace_back(item.first, item.second);
+
+    std::sort(vScheduled.begin(), vScheduled.end(),
+            [](const ScheduledTransaction& a, const ScheduledTransaction& b) { return a.nTime < b.nTime; });
+
     return vScheduled;
 }
 
 bool CWallet::IsScheduled(const uint256& wtxid) const
 {
-    for (const ScheduledTransaction& s : vScheduled) {
-        if (s.wtxid == wtxid)
-            return true;
-    }
-    return false;
+    LOCK(cs_wallet);
+
+    return mapScheduled.count(wtxid);
 }
 
 bool CWallet::BroadcastScheduled(const uint256& wtxid)
@@ -656,10 +749,51 @@ bool CWallet::BroadcastScheduled(const uint256& wtxid)
     return true;
 }
 
+void CWallet::ProcessScheduled()
+{
+    LOCK2(cs_main, cs_wallet);
+
+    nScheduledWakeup = 0;
+
+    const int64_t nNow = GetTime();
+    std::set<uint256> setRetry;
+    while (!queueScheduled.empty() && queueScheduled.top().first <= nNow) {
+        const uint256 wtxid = queueScheduled.top().second;
+        queueScheduled.pop();
+
+        // Skip cancelled entries, entries rescheduled for later and
+        // duplicates of entries already tried
+        auto it = mapScheduled.find(wtxid);
+        if (it == mapScheduled.end() || it->second > nNow || setRetry.count(wtxid))
+            continue;
+
+        auto mi = mapWallet.find(wtxid);
+        if (mi == mapWallet.end() || mi->second.InMempool() || mi->second.GetDepthInMainChain() != 0) {
+            // Already broadcast, confirmed or conflicted
+            RemoveScheduledTransaction(wtxid);
+            continue;
+        }
+
+        if (!BroadcastScheduled(wtxid)) {
+            LogPrintf("%s: Failed to broadcast %s, retrying in %d seconds\n", __func__, wtxid.ToString(), SCHEDULED_TX_RETRY_INTERVAL);
+            setRetry.insert(wtxid);
+            continue;
+        }
+
+        LogPrintf("%s: Broadcast scheduled transaction %s\n", __func__, wtxid.ToString());
+        RemoveScheduledTransaction(wtxid);
+        NotifyTransactionChanged(this, wtxid, CT_UPDATED);
+    }
+
+    for (const uint256& wtxid : setRetry)
+        queueScheduled.emplace(nNow + SCHEDULED_TX_RETRY_INTERVAL, wtxid);
+
+    ScheduleNextBroadcast();
+}
+
 void CWallet::Flush(bool shutdown)
 {
     dbw->Flush(shutdown);
-    WriteScheduledTransactions();
 }
 
 void CWallet::SyncMetaData(std::pair<TxSpends::iterator, TxSpends::iterator> range)
@@ -1007,9 +1141,42 @@ void CWallet::MarkDirty()
         LOCK(cs_wallet);
         for (std::pair<const uint256, CWalletTx>& item : mapWallet)
             item.second.MarkDirty();
+
+        // Keys or transactions changed underneath the index
+        fWalletUTXODirty = true;
     }
 }
 
+void CWallet::AddWalletUTXO(const CWalletTx& wtx, unsigned int n)
+{
+    AssertLockHeld(cs_wallet);
+    if (n < wtx.tx->vout.size() && IsMine(wtx.tx->vout[n]) != ISMINE_NO)
+        setWalletUTXO.insert(COutPoint(wtx.GetHash(), n));
+}
+
+void CWallet::AddWalletUTXO(const CWalletTx& wtx)
+{
+    AssertLockHeld(cs_wallet);
+    for (unsigned int i = 0; i < wtx.tx->vout.size(); i++)
+        AddWalletUTXO(wtx, i);
+}
+
+void CWallet::RebuildWalletUTXO() const
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_wallet);
+
+    setWalletUTXO.clear();
+    for (const auto& entry : mapWallet) {
+        const CWalletTx& wtx = entry.second;
+        for (unsigned int i = 0; i < wtx.tx->vout.size(); i++) {
+            if (IsMine(wtx.tx->vout[i]) != ISMINE_NO && !IsSpent(entry.first, i))
+                setWalletUTXO.emplace_hint(setWalletUTXO.end(), entry.first, i);
+        }
+    }
+    fWalletUTXODirty = false;
+}
+
 bool CWallet::MarkReplaced(const uint256& originalHash, const uint256& newHash)
 {
     LOCK(cs_wallet);
@@ -1118,6 +1285,8 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
     // Break debit/credit balance caches:
     wtx.MarkDirty();
 
+    AddWalletUTXO(wtx);
+
     // Notify UI of new or updated transaction
     NotifyTransactionChanged(this, hash, fInsertedNew ? CT_NEW : CT_UPDATED);
 
@@ -1166,7 +1335,7 @@ bool CWallet::LoadToWallet(const CWalletTx& wtxIn)
  * Abandoned state should probably be more carefully tracked via different
  * posInBlock signals or by checking mempool presence when necessary.
  */
-bool CWallet::AddToWalletIfInvolvingMe(const CTransactionRef& ptx, const CBlockIndex* pIndex, int posInBlock, bool fUpdate)
+bool CWallet::AddToWalletIfInvolvingMe(const CTransactionRef& ptx, const CBlockIndex* pIndex, int posInBlock, bool fUpdate, const bool* pfIsMine)
 {
     const CTransaction& tx = *ptx;
     {
@@ -1187,7 +1356,7 @@ bool CWallet::AddToWalletIfInvolvingMe(const CTransactionRef& ptx, const CBlockI
 
         bool fExisted = mapWallet.count(tx.GetHash()) != 0;
         if (fExisted && !fUpdate) return false;
-        if (fExisted || IsMine(tx) || IsFromMe(tx))
+        if (fExisted || (pfIsMine ? *pfIsMine : IsMine(tx)) || IsFromMe(tx))
         {
             /* Check if any keys in the wallet keypool that were supposed to be unused
              * have appeared in a new transaction. If so, remove those keys from the keypool.
@@ -1292,6 +1461,7 @@ bool CWallet::AbandonTransaction(const uint256& hashTx, std::string* pstrReason)
                 auto it = mapWallet.find(txin.prevout.hash);
                 if (it != mapWallet.end()) {
                     it->second.MarkDirty();
+                    AddWalletUTXO(it->second, txin.prevout.n);
                 }
             }
         }
@@ -1355,6 +1525,7 @@ void CWallet::MarkConflicted(const uint256& hashBlock, const uint256& hashTx)
                 auto it = mapWallet.find(txin.prevout.hash);
                 if (it != mapWallet.end()) {
                     it->second.MarkDirty();
+                    AddWalletUTXO(it->second, txin.prevout.n);
                 }
             }
         }
@@ -1748,11 +1919,46 @@ int64_t CWallet::RescanFromTime(int64_t startTime, const WalletRescanReserver& r
     return startTime;
 }
 
+void CWallet::ReadRescanBlocks(std::vector<RescanBlock>& vBlocks) const
+{
+    ParallelForRanges(vBlocks.size(), GetNumCores(), [this, &vBlocks](size_t nBegin, size_t nEnd) {
+        for (size_t i = nBegin; i < nEnd; i++) {
+            RescanBlock& entry = vBlocks[i];
+            if (!entry.fRead)
+                entry.fRead = ReadBlockFromDisk(entry.block, entry.pindex, Params().GetConsensus());
+            if (!entry.fRead)
+                continue;
+            entry.vMine.resize(entry.block.vtx.size());
+            for (size_t j = 0; j < entry.block.vtx.size(); j++)
+                entry.vMine[j] = IsMine(*entry.block.vtx[j]);
+        }
+        return true;
+    });
+}
+
+/** The next batch of blocks to rescan, starting at pindex and ending at pindexStop at the latest */
+static std::vector<RescanBlock> GetRescanBatch(CBlockIndex* pindex, const CBlockIndex* pindexStop)
+{
+    std::vector<RescanBlock> vBlocks;
+    LOCK(cs_main);
+    while (pindex && vBlocks.size() < (size_t)RESCAN_BATCH_SIZE) {
+        vBlocks.emplace_back(pindex);
+        if (pindex == pindexStop)
+            break;
+        pindex = chainActive.Next(pindex);
+    }
+    return vBlocks;
+}
+
 /**
  * Scan the block chain (starting in pindexStart) for transactions
  * from or to us. If fUpdate is true, found transactions that already
  * exist in the wallet will be updated.
  *
+ * Blocks are read and matched against the keystore by a pool of threads,
+ * one batch ahead of the blocks being applied to the wallet, which happens
+ * in block order.
+ *
  * Returns null if scan was successful. Otherwise, if a complete rescan was not
  * possible (due to pruning or corruption), returns pointer to the most recent
  * block that could not be scanned.
@@ -1788,43 +1994,75 @@ CBlockIndex* CWallet::ScanForWalletTransactions(CBlockIndex* pindexStart, CBlock
             dProgressStart = GuessVerificationProgress(chainParams.TxData(), pindex);
             dProgressTip = GuessVerificationProgress(chainParams.TxData(), tip);
         }
-        while (pindex && !fAbortRescan)
+
+        const int64_t nTimeStart = GetTimeMillis();
+        int nBlocks = 0;
+        uint64_t nTransactions = 0;
+
+        std::vector<RescanBlock> vBatch = GetRescanBatch(pindex, pindexStop);
+        uint64_t nKeyStoreBatch = nKeyStoreUpdates;
+        ReadRescanBlocks(vBatch);
+
+        bool fDone = false;
+        while (!vBatch.empty() && !fDone && !fAbortRescan)
         {
-            if (pindex->nHeight % 100 == 0 && dProgressTip - dProgressStart > 0.0) {
-                double gvp = 0;
-                {
-                    LOCK(cs_main);
-                    gvp = GuessVerificationProgress(chainParams.TxData(), pindex);
-                }
-                ShowProgress(_("Rescanning..."), std::max(1, std::min(99, (int)((gvp - dProgressStart) / (dProgressTip - dProgressStart) * 100))));
-            }
-            if (GetTime() >= nNow + 60) {
-                nNow = GetTime();
+            // Read ahead the next batch while this one is applied
+            std::vector<RescanBlock> vNext;
+            if (vBatch.back().pindex != pindexStop) {
                 LOCK(cs_main);
-                LogPrintf("Still rescanning. At block %d. Progress=%f\n", pindex->nHeight, GuessVerificationProgress(chainParams.TxData(), pindex));
+                vNext = GetRescanBatch(chainActive.Next(vBatch.back().pindex), pindexStop);
             }
+            const uint64_t nKeyStoreNext = nKeyStoreUpdates;
+            std::future<void> prefetch = std::async(std::launch::async, [this, &vNext] { ReadRescanBlocks(vNext); });
+
+            for (RescanBlock& entry : vBatch) {
+                pindex = entry.pindex;
+                if (fAbortRescan)
+                    break;
+
+                if (pindex->nHeight % 100 == 0 && dProgressTip - dProgressStart > 0.0) {
+                    double gvp = 0;
+                    {
+                        LOCK(cs_main);
+                        gvp = GuessVerificationProgress(chainParams.TxData(), pindex);
+                    }
+                    ShowProgress(_("Rescanning..."), std::max(1, std::min(99, (int)((gvp - dProgressStart) / (dProgressTip - dProgressStart) * 100))));
+                }
+                if (GetTime() >= nNow + 60) {
+                    nNow = GetTime();
+                    LOCK(cs_main);
+                    LogPrintf("Still rescanning. At block %d. Progress=%f (%.1f blocks/s)\n", pindex->nHeight, GuessVerificationProgress(chainParams.TxData(), pindex), nBlocks * 1000.0 / std::max<int64_t>(1, GetTimeMillis() - nTimeStart));
+                }
+
+                if (!entry.fRead) {
+                    ret = pindex;
+                    continue;
+                }
 
-            CBlock block;
-            if (ReadBlockFromDisk(block, pindex, Params().GetConsensus())) {
                 LOCK2(cs_main, cs_wallet);
-                if (pindex && !chainActive.Contains(pindex)) {
+                if (!chainActive.Contains(pindex)) {
                     // Abort scan if current block is no longer active, to prevent
                     // marking transactions as coming from the wrong block.
                     ret = pindex;
+                    fDone = true;
                     break;
                 }
-                for (size_t posInBlock = 0; posInBlock < block.vtx.size(); ++posInBlock) {
-                    AddToWalletIfInvolvingMe(block.vtx[posInBlock], pindex, posInBlock, fUpdate);
+                for (size_t posInBlock = 0; posInBlock < entry.block.vtx.size(); ++posInBlock) {
+                    // New keys void the matches made ahead. The keypool can be
+                    // topped up by any transaction, so check before each one.
+                    const bool fMatched = nKeyStoreUpdates == nKeyStoreBatch;
+                    const bool fIsMine = entry.vMine[posInBlock];
+                    AddToWalletIfInvolvingMe(entry.block.vtx[posInBlock], pindex, posInBlock, fUpdate, fMatched ? &fIsMine : nullptr);
                 }
-            } else {
-                ret = pindex;
-            }
-            if (pindex == pindexStop) {
-                break;
+                nBlocks++;
+                nTransactions += entry.block.vtx.size();
             }
+            prefetch.wait();
+
+            vBatch.swap(vNext);
+            nKeyStoreBatch = nKeyStoreNext;
             {
                 LOCK(cs_main);
-                pindex = chainActive.Next(pindex);
                 if (tip != chainActive.Tip()) {
                     tip = chainActive.Tip();
                     // in case the tip has changed, update progress max
@@ -1835,6 +2073,8 @@ CBlockIndex* CWallet::ScanForWalletTransactions(CBlockIndex* pindexStart, CBlock
         if (pindex && fAbortRescan) {
             LogPrintf("Rescan aborted at block %d. Progress=%f\n", pindex->nHeight, GuessVerificationProgress(chainParams.TxData(), pindex));
         }
+        const int64_t nTimeElapsed = GetTimeMillis() - nTimeStart;
+        LogPrintf("Rescanned %d blocks, %u transactions in %.2fs (%.1f blocks/s)\n", nBlocks, nTransactions, nTimeElapsed * 0.001, nBlocks * 1000.0 / std::max<int64_t>(1, nTimeElapsed));
         ShowProgress(_("Rescanning..."), 100); // hide progress dialog in GUI
     }
     return ret;
@@ -2332,10 +2572,36 @@ void CWallet::AvailableCoins(std::vector<COutput> &vCoins, bool fOnlySafe, const
     vCoins.clear();
     CAmount nTotal = 0;
 
-    for (const auto& entry : mapWallet)
+    if (fWalletUTXODirty)
+        RebuildWalletUTXO();
+
+    // Outputs of the same transaction are adjacent in setWalletUTXO, and
+    // transactions come in the same order as in mapWallet
+    auto itNext = setWalletUTXO.begin();
+    while (itNext != setWalletUTXO.end())
     {
-        const uint256& wtxid = entry.first;
-        const CWalletTx* pcoin = &entry.second;
+        const uint256 wtxid = itNext->hash;
+
+        // Drop the outputs that have been spent since they were indexed
+        auto itFirst = setWalletUTXO.end();
+        for (; itNext != setWalletUTXO.end() && itNext->hash == wtxid; ) {
+            if (IsSpent(wtxid, itNext->n)) {
+                itNext = setWalletUTXO.erase(itNext);
+            } else {
+                if (itFirst == setWalletUTXO.end())
+                    itFirst = itNext;
+                ++itNext;
+            }
+        }
+        if (itFirst == setWalletUTXO.end())
+            continue;
+
+        auto mi = mapWallet.find(wtxid);
+        if (mi == mapWallet.end()) {
+            setWalletUTXO.erase(itFirst, itNext);
+            continue;
+        }
+        const CWalletTx* pcoin = &mi->second;
 
         if (IsScheduled(wtxid))
             continue;
@@ -2395,17 +2661,15 @@ void CWallet::AvailableCoins(std::vector<COutput> &vCoins, bool fOnlySafe, const
         if (nDepth < nMinDepth || nDepth > nMaxDepth)
             continue;
 
-        for (unsigned int i = 0; i < pcoin->tx->vout.size(); i++) {
+        for (auto itOut = itFirst; itOut != itNext; ++itOut) {
+            const unsigned int i = itOut->n;
             if (pcoin->tx->vout[i].nValue < nMinimumAmount || pcoin->tx->vout[i].nValue > nMaximumAmount)
                 continue;
 
-            if (coinControl && coinControl->HasSelected() && !coinControl->fAllowOtherInputs && !coinControl->IsSelected(COutPoint(entry.first, i)))
-                continue;
-
-            if (IsLockedCoin(entry.first, i))
+            if (coinControl && coinControl->HasSelected() && !coinControl->fAllowOtherInputs && !coinControl->IsSelected(*itOut))
                 continue;
 
-            if (IsSpent(wtxid, i))
+            if (IsLockedCoin(wtxid, i))
                 continue;
 
             isminetype mine = IsMine(pcoin->tx->vout[i]);
@@ -3196,20 +3460,13 @@ bool CWallet::CreateTransaction(const std::vector<CRecipient>& vecSend, CWalletT
     return true;
 }
 
-bool CWallet::CreateSidechainDeposit(CTransactionRef& tx, std::string& strFail, const CScript& sidechainScriptPubKey, const uint8_t nSidechain, const CAmount& nAmount, const CAmount& nFee, const std::string& strDest)
+static bool CheckSidechainDeposit(std::string& strFail, const CScript& sidechainScriptPubKey, const uint8_t nSidechain, const std::string& strDest)
 {
-    strFail = "Unknown error!";
-
     if (!scdb.IsSidechainActive(nSidechain)) {
         strFail = "Invalid Sidechain number!\n";
         return false;
     }
 
-    if (vpwallets.empty()) {
-        strFail = "No active wallet!\n";
-        return false;
-    }
-
     // User deposit data script
     CScript dataScript = CScript() << OP_RETURN << ParseHex(HexStr(strDest));
 
@@ -3229,26 +3486,42 @@ bool CWallet::CreateSidechainDeposit(CTransactionRef& tx, std::string& strFail,
         return false;
     }
 
-    // The deposit transaction
-    CMutableTransaction mtx;
+    Sidechain sidechain;
+    if (!scdb.GetSidechain(nSidechain, sidechain)) {
+        strFail = "Sidechain not found!\n";
+        return false;
+    }
 
-    BlockUntilSyncedToCurrentChain();
+    return true;
+}
 
-    LOCK2(cs_main, vpwallets[0]->cs_wallet);
+bool CWallet::BuildSidechainDeposit(CMutableTransaction& mtx, std::string& strFail, std::vector<COutput>& vCoins, const SidechainDepositRequest& deposit, const SidechainCTIP* pctip, CReserveKey& reserveKey)
+{
+    AssertLockHeld(cs_wallet);
+
+    mtx = CMutableTransaction();
+
+    // User deposit data script
+    CScript dataScript = CScript() << OP_RETURN << ParseHex(HexStr(deposit.strDest));
 
     // Select coins to cover sidechain deposit
-    std::vector<COutput> vCoins;
-    AvailableCoins(vCoins, true /* fOnlySafe */);
     std::set<CInputCoin> setCoins;
     CAmount nAmountRet = CAmount(0);
-    if (!SelectCoins(vCoins, nAmount + nFee, setCoins, nAmountRet)) {
+    if (!SelectCoins(vCoins, deposit.nAmount + deposit.nFee, setCoins, nAmountRet)) {
         strFail = "Could not collect enough coins to cover deposit + fee!\n";
         return false;
     }
 
+    // The selected coins are not available to deposits built after this one
+    std::set<COutPoint> setSelected;
+    for (const CInputCoin& coin : setCoins)
+        setSelected.insert(coin.outpoint);
+    vCoins.erase(std::remove_if(vCoins.begin(), vCoins.end(), [&setSelected](const COutput& out) {
+        return setSelected.count(COutPoint(out.tx->GetHash(), out.i)) != 0;
+    }), vCoins.end());
+
     // Handle change if there is any
-    const CAmount nChange = nAmountRet - (nAmount + nFee);
-    CReserveKey reserveKey(vpwallets[0]);
+    const CAmount nChange = nAmountRet - (deposit.nAmount + deposit.nFee);
     if (nChange > 0) {
         CScript scriptChange;
 
@@ -3275,19 +3548,14 @@ bool CWallet::CreateSidechainDeposit(CTransactionRef& tx, std::string& strFail,
     mtx.vout.push_back(CTxOut(CAmount(0), dataScript));
 
     // Add deposit output
-    mtx.vout.push_back(CTxOut(nAmount, sidechainScriptPubKey));
+    mtx.vout.push_back(CTxOut(deposit.nAmount, deposit.sidechainScriptPubKey));
 
-    // Handle existing sidechain utxo. We will look at our local mempool, and
-    // create a deposit based on the latest CTIP for the sidechain.
-    // Note: It will be rejected if other nodes have seen a newer CTIP.
-    SidechainCTIP ctip;
-    CAmount returnAmount = CAmount(0);
-    if (::mempool.GetMemPoolCTIP(nSidechain, ctip)) {
-        returnAmount = ctip.amount;
+    // Spend the existing sidechain utxo, if there is one
+    if (pctip) {
         // Amount returning to sidechain
-        mtx.vout.back().nValue += returnAmount;
+        mtx.vout.back().nValue += pctip->amount;
         // Spend the existing CTIP
-        mtx.vin.push_back(CTxIn(ctip.out));
+        mtx.vin.push_back(CTxIn(pctip->out));
     }
 
     // Dummy sign the transaction to calculate fee
@@ -3312,7 +3580,7 @@ bool CWallet::CreateSidechainDeposit(CTransactionRef& tx, std::string& strFail,
     }
 
     // Check the user set fee
-    if (nFee < nFeeNeeded) {
+    if (deposit.nFee < nFeeNeeded) {
         strFail = "The fee you have set is too small!";
         return false;
     }
@@ -3323,10 +3591,6 @@ bool CWallet::CreateSidechainDeposit(CTransactionRef& tx, std::string& strFail,
         vin.scriptWitness.SetNull();
     }
 
-    Sidechain sidechain;
-    if (!scdb.GetSidechain(nSidechain, sidechain))
-        return false;
-
     // Sign the non sidechain inputs
     const CTransaction txToSign = mtx;
     int nIn = 0;
@@ -3345,6 +3609,41 @@ bool CWallet::CreateSidechainDeposit(CTransactionRef& tx, std::string& strFail,
         nIn++;
     }
 
+    return true;
+}
+
+bool CWallet::CreateSidechainDeposit(CTransactionRef& tx, std::string& strFail, const CScript& sidechainScriptPubKey, const uint8_t nSidechain, const CAmount& nAmount, const CAmount& nFee, const std::string& strDest)
+{
+    strFail = "Unknown error!";
+
+    if (vpwallets.empty()) {
+        strFail = "No active wallet!\n";
+        return false;
+    }
+
+    if (!CheckSidechainDeposit(strFail, sidechainScriptPubKey, nSidechain, strDest))
+        return false;
+
+    BlockUntilSyncedToCurrentChain();
+
+    LOCK2(cs_main, vpwallets[0]->cs_wallet);
+
+    std::vector<COutput> vCoins;
+    AvailableCoins(vCoins, true /* fOnlySafe */);
+
+    // Handle existing sidechain utxo. We will look at our local mempool, and
+    // create a deposit based on the latest CTIP for the sidechain.
+    // Note: It will be rejected if other nodes have seen a newer CTIP.
+    SidechainCTIP ctip;
+    const bool fCTIP = ::mempool.GetMemPoolCTIP(nSidechain, ctip);
+
+    // The deposit transaction
+    CMutableTransaction mtx;
+    CReserveKey reserveKey(vpwallets[0]);
+    const SidechainDepositRequest deposit{sidechainScriptPubKey, nSidechain, nAmount, nFee, strDest};
+    if (!BuildSidechainDeposit(mtx, strFail, vCoins, deposit, fCTIP ? &ctip : nullptr, reserveKey))
+        return false;
+
     // Broadcast transaction
     CWalletTx wtxNew;
     wtxNew.fTimeReceivedIsTxTime = true;
@@ -3364,6 +3663,139 @@ bool CWallet::CreateSidechainDeposit(CTransactionRef& tx, std::string& strFail,
     return true;
 }
 
+bool CWallet::QueueSidechainDeposit(std::string& strFail, const CScript& sidechainScriptPubKey, const uint8_t nSidechain, const CAmount& nAmount, const CAmount& nFee, const std::string& strDest)
+{
+    strFail = "Unknown error!";
+
+    if (!CheckSidechainDeposit(strFail, sidechainScriptPubKey, nSidechain, strDest))
+        return false;
+
+    LOCK(cs_wallet);
+    mapQueuedDeposits[nSidechain].push_back(SidechainDepositRequest{sidechainScriptPubKey, nSidechain, nAmount, nFee, strDest});
+
+    return true;
+}
+
+std::vector<SidechainDepositRequest> CWallet::GetQueuedSidechainDeposits(const uint8_t nSidechain) const
+{
+    LOCK(cs_wallet);
+    auto it = mapQueuedDeposits.find(nSidechain);
+    if (it == mapQueuedDeposits.end())
+        return {};
+    return it->second;
+}
+
+void CWallet::ClearQueuedSidechainDeposits(const uint8_t nSidechain)
+{
+    LOCK(cs_wallet);
+    mapQueuedDeposits.erase(nSidechain);
+}
+
+bool CWallet::CreateQueuedSidechainDeposits(std::vector<CTransactionRef>& vtx, std::string& strFail, const uint8_t nSidechain)
+{
+    strFail = "Unknown error!";
+    vtx.clear();
+
+    if (!fBroadcastTransactions) {
+        strFail = "Transaction broadcast is disabled!\n";
+        return false;
+    }
+
+    // Holding cs_main from the CTIP lookup to the last submission keeps
+    // other deposits from taking the CTIP in between
+    LOCK2(cs_main, cs_wallet);
+
+    auto it = mapQueuedDeposits.find(nSidechain);
+    if (it == mapQueuedDeposits.end() || it->second.empty()) {
+        strFail = "No sidechain deposits queued!\n";
+        return false;
+    }
+    const std::vector<SidechainDepositRequest>& vDeposit = it->second;
+
+    std::vector<COutput> vCoins;
+    AvailableCoins(vCoins, true /* fOnlySafe */);
+
+    // Each deposit spends the CTIP created by the deposit before it
+    SidechainCTIP ctip;
+    bool fCTIP = ::mempool.GetMemPoolCTIP(nSidechain, ctip);
+
+    std::vector<CMutableTransaction> vMtx(vDeposit.size());
+    std::vector<std::unique_ptr<CReserveKey>> vReserveKey;
+    for (size_t i = 0; i < vDeposit.size(); i++) {
+        const SidechainDepositRequest& deposit = vDeposit[i];
+        if (!CheckSidechainDeposit(strFail, deposit.sidechainScriptPubKey, nSidechain, deposit.strDest))
+            return false;
+
+        vReserveKey.emplace_back(new CReserveKey(this));
+        if (!BuildSidechainDeposit(vMtx[i], strFail, vCoins, deposit, fCTIP ? &ctip : nullptr, *vReserveKey.back()))
+            return false;
+
+        // The deposit output is always the last one
+        ctip.out = COutPoint(vMtx[i].GetHash(), vMtx[i].vout.size() - 1);
+        ctip.amount = vMtx[i].vout.back().nValue;
+        fCTIP = true;
+    }
+
+    // Submit the whole chain to the mempool, or none of it
+    std::map<uint8_t, SidechainCTIP> mapCTIPPrev;
+    {
+        LOCK(::mempool.cs);
+        mapCTIPPrev = ::mempool.mapLastSidechainDeposit;
+    }
+    for (size_t i = 0; i < vMtx.size(); i++) {
+        CWalletTx wtxNew;
+        wtxNew.fTimeReceivedIsTxTime = true;
+        wtxNew.fFromMe = true;
+        wtxNew.nDenial = 0;
+        wtxNew.BindWallet(this);
+        wtxNew.SetTx(MakeTransactionRef(std::move(vMtx[i])));
+
+        AddToWallet(wtxNew);
+
+        // Notify that old coins are spent
+        for (const CTxIn& txin : wtxNew.tx->vin) {
+            auto mi = mapWallet.find(txin.prevout.hash);
+            if (mi != mapWallet.end())
+                NotifyTransactionChanged(this, mi->first, CT_UPDATED);
+        }
+
+        CWalletTx& wtx = mapWallet[wtxNew.GetHash()];
+        CValidationState state;
+        if (!wtx.AcceptToMemoryPool(maxTxFee, state)) {
+            strFail = strprintf("Failed to submit sidechain deposit %u of %u! Reject reason: %s\n", i + 1, vMtx.size(), FormatStateMessage(state));
+
+            // Take the deposits accepted so far back out of the mempool,
+            // and abandon the whole chain in the wallet. Abandoning needs
+            // the wallet to know they have left the mempool.
+            const uint256 hashFirst = vtx.empty() ? wtx.GetHash() : vtx.front()->GetHash();
+            if (!vtx.empty()) {
+                LOCK(::mempool.cs);
+                ::mempool.removeRecursive(*vtx.front(), MemPoolRemovalReason::UNKNOWN);
+            }
+            ::mempool.UpdateCTIPFromMempool(mapCTIPPrev);
+            for (const CTransactionRef& tx : vtx)
+                mapWallet[tx->GetHash()].fInMempool = false;
+            if (!AbandonTransaction(hashFirst))
+                LogPrintf("%s: Failed to abandon sidechain deposit %s!\n", __func__, hashFirst.ToString());
+            // The abandoned deposits stay in the wallet and still pay their
+            // change keys, which must not be handed out again
+            for (size_t j = 0; j <= i; j++)
+                vReserveKey[j]->KeepKey();
+            vtx.clear();
+            return false;
+        }
+        vtx.push_back(wtx.tx);
+    }
+
+    for (size_t i = 0; i < vtx.size(); i++) {
+        vReserveKey[i]->KeepKey();
+        mapWallet[vtx[i]->GetHash()].RelayWalletTransaction(g_connman.get());
+    }
+    mapQueuedDeposits.erase(it);
+
+    return true;
+}
+
 bool CWallet::CreateOPReturnTransaction(CTransactionRef& tx, std::string& strFail, const CAmount& nFee, const CScript& script)
 {
     strFail = "Unknown error!";
@@ -3486,22 +3918,11 @@ bool CWallet::CreateOPReturnTransaction(CTransactionRef& tx, std::string& strFai
     return true;
 }
 
-bool CWallet::DenyCoin(CWalletTx& wtx, std::string& strFail, const COutput& coin, bool fBroadcast, const CAmount& amountRequired, const CTxDestination& destRequired)
+bool CWallet::CreateDenialTx(CMutableTransaction& mtx, std::string& strFail, const COutput& coin, const CAmount& amountRequired, const CTxDestination& destRequired)
 {
-    strFail = "Unknown error!";
-    if (!fBroadcastTransactions) {
-        strFail = "Transaction broadcast is disabled!\n";
-        return false;
-    }
-
-    if (vpwallets.empty()) {
-        strFail = "No active wallet!\n";
-        return false;
-    }
-
-    LOCK2(cs_main, vpwallets[0]->cs_wallet);
+    AssertLockHeld(cs_wallet);
 
-    CMutableTransaction mtx;
+    mtx = CMutableTransaction();
 
     // Add the coin we want to spend as an input
     mtx.vin.push_back(CTxIn(coin.tx->GetHash(), coin.i, CScript()));
@@ -3627,17 +4048,28 @@ bool CWallet::DenyCoin(CWalletTx& wtx, std::string& strFail, const COutput& coin
         vin.scriptWitness.SetNull();
     }
 
+    return true;
+}
+
+bool CWallet::SignDenialTx(CMutableTransaction& mtx, const COutput& coin) const
+{
     // Sign the input
+    const CAmount amountIn = coin.tx->tx->vout[coin.i].nValue;
     const CTransaction txToSign = mtx;
     const CScript& scriptToSign = coin.tx->tx->vout[coin.i].scriptPubKey;
     SignatureData sigdata;
-    if (!ProduceSignature(TransactionSignatureCreator(this, &txToSign, 0, amountIn, SIGHASH_ALL), scriptToSign, sigdata)) {
-        strFail = "Signing input failed!\n";
+    if (!ProduceSignature(TransactionSignatureCreator(this, &txToSign, 0, amountIn, SIGHASH_ALL), scriptToSign, sigdata))
         return false;
-    }
 
     UpdateTransaction(mtx, 0, sigdata);
 
+    return true;
+}
+
+CWalletTx& CWallet::AddDenialTx(CWalletTx& wtx, const COutput& coin, CMutableTransaction&& mtx)
+{
+    AssertLockHeld(cs_wallet);
+
     // Create wallet transaction
 
     wtx.fTimeReceivedIsTxTime = true;
@@ -3659,9 +4091,36 @@ bool CWallet::DenyCoin(CWalletTx& wtx, std::string& strFail, const COutput& coin
     spentTx.BindWallet(this);
     NotifyTransactionChanged(this, spentTx.GetHash(), CT_UPDATED);
 
-    // Get the inserted-CWalletTx from mapWallet so that the
+    // Return the inserted-CWalletTx from mapWallet so that the
     // fInMempool flag is cached properly
-    CWalletTx& wtxFromCache = mapWallet[wtx.GetHash()];
+    return mapWallet[wtx.GetHash()];
+}
+
+bool CWallet::DenyCoin(CWalletTx& wtx, std::string& strFail, const COutput& coin, bool fBroadcast, const CAmount& amountRequired, const CTxDestination& destRequired)
+{
+    strFail = "Unknown error!";
+    if (!fBroadcastTransactions) {
+        strFail = "Transaction broadcast is disabled!\n";
+        return false;
+    }
+
+    if (vpwallets.empty()) {
+        strFail = "No active wallet!\n";
+        return false;
+    }
+
+    LOCK2(cs_main, cs_wallet);
+
+    CMutableTransaction mtx;
+    if (!CreateDenialTx(mtx, strFail, coin, amountRequired, destRequired))
+        return false;
+
+    if (!SignDenialTx(mtx, coin)) {
+        strFail = "Signing input failed!\n";
+        return false;
+    }
+
+    CWalletTx& wtxFromCache = AddDenialTx(wtx, coin, std::move(mtx));
 
     if (!fBroadcast)
         return true;
@@ -3687,6 +4146,100 @@ bool CWallet::DenyCoin(CWalletTx& wtx, std::string& strFail, const COutput& coin
     return true;
 }
 
+std::vector<COutput> CWallet::SelectDenialCoins(unsigned int nDenialGoal, size_t nMax) const
+{
+    std::vector<COutput> vAvailable;
+    AvailableCoins(vAvailable);
+
+    std::vector<COutput> vCoins;
+    for (const COutput& coin : vAvailable) {
+        if (coin.tx->nDenial < nDenialGoal)
+            vCoins.push_back(coin);
+    }
+
+    std::stable_sort(vCoins.begin(), vCoins.end(), [](const COutput& a, const COutput& b) {
+        return a.tx->nDenial < b.tx->nDenial;
+    });
+    if (nMax && vCoins.size() > nMax)
+        vCoins.erase(vCoins.begin() + nMax, vCoins.end());
+
+    return vCoins;
+}
+
+bool CWallet::CreateDenials(const std::vector<COutput>& vCoins, int64_t nMaxDelay, std::vector<ScheduledTransaction>& vScheduled, std::string& strFail)
+{
+    strFail = "Unknown error!";
+    vScheduled.clear();
+    if (!fBroadcastTransactions) {
+        strFail = "Transaction broadcast is disabled!\n";
+        return false;
+    }
+
+    LOCK2(cs_main, cs_wallet);
+
+    // Building uses the keypool, so it stays serial
+    std::vector<CMutableTransaction> vTx(vCoins.size());
+    for (size_t i = 0; i < vCoins.size(); i++) {
+        if (!CreateDenialTx(vTx[i], strFail, vCoins[i]))
+            return false;
+    }
+
+    // Signing only reads the keystore and dominates the cost of a batch
+    std::vector<char> vSigned(vCoins.size(), 0);
+    ParallelForRanges(vCoins.size(), GetNumCores(), [&](size_t nBegin, size_t nEnd) {
+        for (size_t i = nBegin; i < nEnd; i++)
+            vSigned[i] = SignDenialTx(vTx[i], vCoins[i]);
+        return true;
+    });
+
+    if (std::count(vSigned.begin(), vSigned.end(), 0)) {
+        strFail = "Signing input failed!\n";
+        return false;
+    }
+
+    // Write the schedule before adding anything to the wallet: a denial in
+    // the wallet without a schedule entry would be rebroadcast right away. A
+    // schedule entry without its transaction is dropped by ProcessScheduled.
+    const int64_t nNow = GetTime();
+    std::vector<ScheduledTransaction> vBatch;
+    vBatch.reserve(vCoins.size());
+    for (size_t i = 0; i < vCoins.size(); i++) {
+        const uint256 wtxid = CTransaction(vTx[i]).GetHash();
+        if (mapWallet.count(wtxid) || mapScheduled.count(wtxid)) {
+            strFail = "Failed to schedule transaction!\n";
+            return false;
+        }
+        vBatch.emplace_back(wtxid, nNow + (nMaxDelay > 0 ? GetRand(nMaxDelay) : 0));
+    }
+
+    CWalletDB walletdb(*dbw);
+    if (!walletdb.TxnBegin()) {
+        strFail = "Failed to schedule transaction!\n";
+        return false;
+    }
+    for (const ScheduledTransaction& scheduled : vBatch) {
+        if (!walletdb.WriteScheduledTransaction(scheduled)) {
+            walletdb.TxnAbort();
+            strFail = "Failed to schedule transaction!\n";
+            return false;
+        }
+    }
+    if (!walletdb.TxnCommit()) {
+        strFail = "Failed to schedule transaction!\n";
+        return false;
+    }
+
+    for (size_t i = 0; i < vCoins.size(); i++) {
+        CWalletTx wtx;
+        AddDenialTx(wtx, vCoins[i], std::move(vTx[i]));
+        LoadScheduledTransaction(vBatch[i]);
+    }
+    ScheduleNextBroadcast();
+
+    vScheduled = std::move(vBatch);
+    return true;
+}
+
 /**
  * Call after CreateTransaction unless you want to abort
  */
@@ -3786,7 +4339,7 @@ DBErrors CWallet::LoadWallet(bool& fFirstRunRet)
     if (nLoadWalletRet != DB_LOAD_OK)
         return nLoadWalletRet;
 
-    if (!LoadScheduledTransactions())
+    if (!MigrateScheduledTransactions())
         return DB_LOAD_FAIL;
 
     uiInterface.LoadWallet(this);
@@ -4751,6 +5304,13 @@ void CWallet::postInitProcess(CScheduler& scheduler)
     // Do this here as mempool requires genesis block to be loaded
     ReacceptWalletTransactions();
 
+    // Broadcast scheduled transactions as they become due
+    {
+        LOCK(cs_wallet);
+        pscheduler = &scheduler;
+        ScheduleNextBroadcast();
+    }
+
     // Run a thread to flush wallet periodically
     if (!CWallet::fFlushScheduled.exchange(true)) {
         scheduler.scheduleEvery(MaybeCompactWalletDB, 500);
@@ -8,6 +8,7 @@
 
 #include <amount.h>
 #include <policy/feerate.h>
+#include <primitives/block.h>
 #include <streams.h>
 #include <tinyformat.h>
 #include <ui_interface.h>
@@ -21,7 +22,9 @@
 
 #include <algorithm>
 #include <atomic>
+#include <functional>
 #include <map>
+#include <queue>
 #include <set>
 #include <stdexcept>
 #include <stdint.h>
@@ -80,6 +83,7 @@ class CTxMemPool;
 class CBlockPolicyEstimator;
 class CWalletTx;
 class CriticalData;
+struct SidechainCTIP;
 struct FeeCalculation;
 enum class FeeEstimateMode;
 
@@ -691,26 +695,55 @@ private:
     std::vector<char> _ssExtra;
 };
 
+//! Qt format used to display scheduled broadcast times
 static const std::string SCHEDULED_TX_TIME_FORMAT = "ddd MMMM d yyyy h:mm a";
-static const uint64_t SCHEDULED_TX_DUMP_VERSION = 0;
+//! Seconds to wait before retrying a scheduled transaction that failed to broadcast
+static const int64_t SCHEDULED_TX_RETRY_INTERVAL = 60;
 struct ScheduledTransaction
 {
-    // TODO I would prefer unix time, which requires updating Qt dep
-    // The date time in SCHEULED_TX_TIME_FORMAT to broadcast the TX
-    std::string strTime;
+    // The unix time at which to broadcast the TX
+    int64_t nTime;
 
     // The scheduled transaction
     uint256 wtxid; // WTX hash in mapWallet
 
+    ScheduledTransaction() : nTime(0) {}
+    ScheduledTransaction(const uint256& wtxidIn, int64_t nTimeIn) : nTime(nTimeIn), wtxid(wtxidIn) {}
+
     ADD_SERIALIZE_METHODS
 
     template<typename Stream, typename Operation>
     inline void SerializationOp(Stream& s, Operation ser_action) {
-        READWRITE(strTime);
+        READWRITE(nTime);
         READWRITE(wtxid);
     }
 };
 
+/** A sidechain deposit waiting in the wallet's deposit queue */
+struct SidechainDepositRequest
+{
+    CScript sidechainScriptPubKey;
+    uint8_t nSidechain;
+    CAmount nAmount;
+    CAmount nFee;
+    std::string strDest;
+};
+
+/** Number of blocks a wallet rescan reads and matches ahead of the blocks it applies */
+static const int RESCAN_BATCH_SIZE = 64;
+
+/** A block read ahead of a wallet rescan */
+struct RescanBlock
+{
+    CBlockIndex* pindex;
+    CBlock block;
+    bool fRead;
+    //! Whether each transaction of the block pays to the wallet's keystore
+    std::vector<char> vMine;
+
+    explicit RescanBlock(CBlockIndex* pindexIn) : pindex(pindexIn), fRead(false) {}
+};
+
 class WalletRescanReserver; //forward declarations for ScanForWalletTransactions/RescanFromTime
 /**
  * A CWallet is an extension of a keystore, which also maintains a set of transactions and balances,
@@ -722,6 +755,8 @@ private:
     static std::atomic<bool> fFlushScheduled;
     std::atomic<bool> fAbortRescan;
     std::atomic<bool> fScanningWallet; //controlled by WalletRescanReserver
+    //! Bumped whenever keys or scripts change, so matches made ahead of a rescan can be checked
+    std::atomic<uint64_t> nKeyStoreUpdates;
     std::mutex mutexScanning;
     friend class WalletRescanReserver;
 
@@ -755,6 +790,27 @@ private:
     void AddToSpends(const COutPoint& outpoint, const uint256& wtxid);
     void AddToSpends(const uint256& wtxid);
 
+    /**
+     * Outputs of wallet transactions that may still be spendable, so that
+     * AvailableCoins does not have to walk all of mapWallet. This is a
+     * superset of the wallet's unspent outputs: outputs are added when their
+     * transaction enters the wallet, or when the transaction spending them is
+     * conflicted or abandoned, and are only dropped by AvailableCoins once it
+     * finds them spent.
+     */
+    mutable std::set<COutPoint> setWalletUTXO;
+    //! setWalletUTXO must be rebuilt from mapWallet before its next use
+    mutable bool fWalletUTXODirty;
+    void AddWalletUTXO(const CWalletTx& wtx, unsigned int n);
+    void AddWalletUTXO(const CWalletTx& wtx);
+    void RebuildWalletUTXO() const;
+
+    //! Sidechain deposits waiting to be created, by sidechain number (not persisted)
+    std::map<uint8_t, std::vector<SidechainDepositRequest>> mapQueuedDeposits;
+
+    /** Build and sign a deposit, spending pctip if set and coins taken out of vCoins */
+    bool BuildSidechainDeposit(CMutableTransaction& mtx, std::string& strFail, std::vector<COutput>& vCoins, const SidechainDepositRequest& deposit, const SidechainCTIP* pctip, CReserveKey& reserveKey);
+
     /* Mark a transaction (and its in-wallet descendants) as conflicting with a particular block. */
     void MarkConflicted(const uint256& hashBlock, const uint256& hashTx);
 
@@ -802,13 +858,25 @@ private:
      */
     const CBlockIndex* m_last_block_processed;
 
-    /* Load list of scheduled transactions */
-    bool LoadScheduledTransactions();
+    /* Move this wallet's scheduled transactions from the old scheduledtx.dat file into the wallet database */
+    bool MigrateScheduledTransactions();
+
+    /* Register a scheduler wakeup for the next scheduled transaction, if needed */
+    void ScheduleNextBroadcast();
 
-    /* Write list of scheduled transactions */
-    void WriteScheduledTransactions();
+    //! Broadcast time of each scheduled transaction
+    std::map<uint256, int64_t> mapScheduled;
 
-    std::vector<ScheduledTransaction> vScheduled;
+    typedef std::pair<int64_t, uint256> ScheduledEntry;
+    //! Min-heap of scheduled transactions by broadcast time. Entries that were
+    //! cancelled, or were queued again for a retry, are skipped when popped.
+    std::priority_queue<ScheduledEntry, std::vector<ScheduledEntry>, std::greater<ScheduledEntry>> queueScheduled;
+
+    //! Scheduler that runs ProcessScheduled, set by postInitProcess
+    CScheduler* pscheduler = nullptr;
+
+    //! Time of the earliest wakeup registered with pscheduler, or 0 if none
+    int64_t nScheduledWakeup = 0;
 
 public:
     /*
@@ -882,6 +950,8 @@ public:
         nRelockTime = 0;
         fAbortRescan = false;
         fScanningWallet = false;
+        fWalletUTXODirty = true;
+        nKeyStoreUpdates = 0;
     }
 
     std::map<uint256, CWalletTx> mapWallet;
@@ -1007,7 +1077,16 @@ public:
     void TransactionAddedToMempool(const CTransactionRef& tx) override;
     void BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex *pindex, const std::vector<CTransactionRef>& vtxConflicted) override;
     void BlockDisconnected(const std::shared_ptr<const CBlock>& pblock) override;
-    bool AddToWalletIfInvolvingMe(const CTransactionRef& tx, const CBlockIndex* pIndex, int posInBlock, bool fUpdate);
+    /**
+     * pfIsMine, when set, is the already computed IsMine(tx), so the check
+     * against the keystore can be skipped.
+     */
+    bool AddToWalletIfInvolvingMe(const CTransactionRef& tx, const CBlockIndex* pIndex, int posInBlock, bool fUpdate, const bool* pfIsMine = nullptr);
+    /**
+     * Read the blocks that have not been read yet and match their
+     * transactions against the keystore, in parallel. Does not need cs_wallet.
+     */
+    void ReadRescanBlocks(std::vector<RescanBlock>& vBlocks) const;
     int64_t RescanFromTime(int64_t startTime, const WalletRescanReserver& reserver, bool update);
     CBlockIndex* ScanForWalletTransactions(CBlockIndex* pindexStart, CBlockIndex* pindexStop, const WalletRescanReserver& reserver, bool fUpdate = false);
     void TransactionRemovedFromMempool(const CTransactionRef &ptx) override;
@@ -1042,10 +1121,39 @@ public:
     /** Create a transaction with special format for sidechains */
     bool CreateSidechainDeposit(CTransactionRef& tx, std::string& strFail, const CScript& sidechainScriptPubKey, const uint8_t nSidechain, const CAmount& nAmount, const CAmount& nFee, const std::string& strDest);
 
+    /** Queue a sidechain deposit, to be created along with the other deposits queued for its sidechain */
+    bool QueueSidechainDeposit(std::string& strFail, const CScript& sidechainScriptPubKey, const uint8_t nSidechain, const CAmount& nAmount, const CAmount& nFee, const std::string& strDest);
+    std::vector<SidechainDepositRequest> GetQueuedSidechainDeposits(const uint8_t nSidechain) const;
+    void ClearQueuedSidechainDeposits(const uint8_t nSidechain);
+    /**
+     * Create the deposits queued for a sidechain as one chain of CTIP spends
+     * and submit them to the mempool together. If any of them is rejected,
+     * the ones accepted so far are taken back out of the mempool, the whole
+     * chain is marked abandoned in the wallet and the queue is left as it was.
+     */
+    bool CreateQueuedSidechainDeposits(std::vector<CTransactionRef>& vtx, std::string& strFail, const uint8_t nSidechain);
+
     bool CreateOPReturnTransaction(CTransactionRef& tx, std::string& strFail, const CAmount& nFee, const CScript& script);
 
+    /** Build the unsigned, fee paying transaction that denies coin (keys come from the keypool) */
+    bool CreateDenialTx(CMutableTransaction& mtx, std::string& strFail, const COutput& coin, const CAmount& amountRequired = CAmount(0), const CTxDestination& destRequired = CNoDestination());
+    /** Sign the input of a transaction made by CreateDenialTx. Only reads the keystore. */
+    bool SignDenialTx(CMutableTransaction& mtx, const COutput& coin) const;
+    /** Add a signed denial transaction to the wallet, returning the cached wallet transaction */
+    CWalletTx& AddDenialTx(CWalletTx& wtx, const COutput& coin, CMutableTransaction&& mtx);
+
     bool DenyCoin(CWalletTx& wtx, std::string& strFail, const COutput& coin, bool fBroadcast = true, const CAmount& amountRequired = CAmount(0), const CTxDestination& destRequired = CNoDestination());
 
+    /** Up to nMax spendable coins with a denial score below nDenialGoal, lowest score first */
+    std::vector<COutput> SelectDenialCoins(unsigned int nDenialGoal, size_t nMax = 0) const;
+
+    /**
+     * Deny a batch of coins: the transactions are built one after another,
+     * signed in parallel and scheduled for broadcast at random times within
+     * nMaxDelay seconds from now. On failure nothing is added to the wallet.
+     */
+    bool CreateDenials(const std::vector<COutput>& vCoins, int64_t nMaxDelay, std::vector<ScheduledTransaction>& vScheduled, std::string& strFail);
+
     bool CommitTransaction(CWalletTx& wtxNew, CReserveKey& reservekey, CConnman* connman, CValidationState& state, bool fRemoveIfFail = false, CAmount nAbsurdFee = CAmount(0));
 
     void ListAccountCreditDebit(const std::string& strAccount, std::list<CAccountingEntry>& entries);
@@ -1172,6 +1280,9 @@ public:
     /* Initializes the wallet, returns a new CWallet instance or a null pointer in case of an error */
     static CWallet* CreateWalletFromFile(const std::string walletFile);
 
+    /* Remove the old scheduledtx.dat file, once every wallet has been loaded and migrated its entries */
+    static void RemoveLegacyScheduledTransactions();
+
     /**
      * Wallet post-init setup
      * Gives the wallet a chance to register repetitive tasks and complete post-init tasks
@@ -1230,17 +1341,24 @@ public:
     /** Update the replay status of a wallet transaction */
     void UpdateReplayStatus(const uint256& txid, const int nReplayStatus);
 
-    /** Add to scheduled transaction cache */
-    bool ScheduleTransaction(const uint256& wtxid, const std::string& strTime);
+    /** Schedule a wallet transaction to be broadcast at unix time nTime */
+    bool ScheduleTransaction(const uint256& wtxid, int64_t nTime);
+
+    /** Add a scheduled transaction read from the wallet database (only used during LoadWallet) */
+    void LoadScheduledTransaction(const ScheduledTransaction& scheduled);
 
     /** Remove / cancel scheduled transaction */
-    void RemoveScheduledTransaction(const ScheduledTransaction& scheduled);
+    bool RemoveScheduledTransaction(const uint256& wtxid);
 
+    /** Scheduled transactions, ordered by broadcast time */
     std::vector<ScheduledTransaction> GetScheduled() const;
 
     bool IsScheduled(const uint256& wtxid) const;
 
     bool BroadcastScheduled(const uint256& wtxid);
+
+    /** Broadcast the scheduled transactions that are due. Run by the scheduler. */
+    void ProcessScheduled();
 };
 
 /** A key allocated from the key pool. */
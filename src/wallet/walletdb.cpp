@@ -496,6 +496,13 @@ ReadKeyValue(CWallet* pwallet, CDataStream& ssKey, CDataStream& ssValue,
                 return false;
             }
         }
+        else if (strType == "scheduledtx")
+        {
+            ScheduledTransaction scheduled;
+            ssKey >> scheduled.wtxid;
+            ssValue >> scheduled.nTime;
+            pwallet->LoadScheduledTransaction(scheduled);
+        }
         else if (strType == "hdchain")
         {
             CHDChain chain;
@@ -827,6 +834,16 @@ bool CWalletDB::EraseDestData(const std::string &address, const std::string &key
     return EraseIC(std::make_pair(std::string("destdata"), std::make_pair(address, key)));
 }
 
+bool CWalletDB::WriteScheduledTransaction(const ScheduledTransaction& scheduled)
+{
+    return WriteIC(std::make_pair(std::string("scheduledtx"), scheduled.wtxid), scheduled.nTime);
+}
+
+bool CWalletDB::EraseScheduledTransaction(const uint256& wtxid)
+{
+    return EraseIC(std::make_pair(std::string("scheduledtx"), wtxid));
+}
+
 
 bool CWalletDB::WriteHDChain(const CHDChain& chain)
 {
@@ -43,6 +43,7 @@ class CMasterKey;
 class CScript;
 class CWallet;
 class CWalletTx;
+struct ScheduledTransaction;
 class uint160;
 class uint256;
 
@@ -211,6 +212,11 @@ public:
     /// Erase destination data tuple from wallet database
     bool EraseDestData(const std::string &address, const std::string &key);
 
+    /// Write a transaction scheduled for later broadcast
+    bool WriteScheduledTransaction(const ScheduledTransaction& scheduled);
+    /// Erase a scheduled transaction
+    bool EraseScheduledTransaction(const uint256& wtxid);
+
     CAmount GetAccountCreditDebit(const std::string& strAccount);
     void ListAccountCreditDebit(const std::string& strAccount, std::list<CAccountingEntry>& acentries);
 
@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+# Copyright (c) 2022 The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test starting a node from a chainstate snapshot.
+
+1. node0 mines a chain and writes a snapshot with dumptxoutset.
+2. node1 refuses the snapshot without -loadtxoutsethash, or with a hash that
+   does not match.
+3. node1 starts from the snapshot with -loadtxoutset, -loadtxoutsethash and
+   -prune, then syncs the blocks node0 mines on top of it from node0.
+4. node1 keeps its chainstate across a restart, and does not have the data of
+   blocks below the snapshot.
+"""
+import os
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import (
+    assert_equal,
+    assert_raises_rpc_error,
+    connect_nodes,
+    sync_blocks,
+)
+
+ADDRESS = "mjTkW3DjgyZck4KbiRusZsqTgaYTxdSz6z"
+SNAPSHOT_HEIGHT = 150
+
+def utxo_summary(node):
+    # disk_size is an estimate of the database and differs between nodes
+    info = node.gettxoutsetinfo("rolling")
+    del info['disk_size']
+    return info
+
+class SnapshotTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+
+    def setup_network(self):
+        self.setup_nodes()
+
+    def run_test(self):
+        node0 = self.nodes[0]
+        node0.generatetoaddress(SNAPSHOT_HEIGHT, ADDRESS)
+
+        self.log.info("Write a snapshot at height %d" % SNAPSHOT_HEIGHT)
+        result = node0.dumptxoutset("snapshot.dat")
+        assert_equal(result['base_height'], SNAPSHOT_HEIGHT)
+        assert_equal(result['base_hash'], node0.getbestblockhash())
+        txoutset = node0.gettxoutsetinfo("rolling")
+        assert_equal(result['coins_written'], txoutset['txouts'])
+        assert_equal(result['hash_rolling'], txoutset['hash_rolling'])
+        path = result['path']
+        assert os.path.isfile(path)
+        assert_raises_rpc_error(-8, "already exists", node0.dumptxoutset, "snapshot.dat")
+
+        self.log.info("Refuse the snapshot without the expected hash")
+        self.stop_node(1)
+        self.assert_start_raises_init_error(1, ["-loadtxoutset=%s" % path, "-prune=550"],
+                                            "-loadtxoutset requires -loadtxoutsethash")
+        self.assert_start_raises_init_error(1, ["-loadtxoutset=%s" % path, "-loadtxoutsethash=%s" % result['hash_rolling'], "-prune=550"],
+                                            "Unable to load chainstate snapshot")
+
+        self.log.info("Start node1 from the snapshot")
+        self.start_node(1, extra_args=["-loadtxoutset=%s" % path, "-loadtxoutsethash=%s" % result['snapshot_hash'], "-prune=550"])
+        node1 = self.nodes[1]
+        assert_equal(node1.getblockcount(), SNAPSHOT_HEIGHT)
+        assert_equal(node1.getbestblockhash(), result['base_hash'])
+        assert_equal(node1.gettxoutsetinfo("rolling")['hash_rolling'], result['hash_rolling'])
+
+        self.log.info("Sync new blocks on top of the snapshot")
+        connect_nodes(node1, 0)
+        node0.generatetoaddress(10, ADDRESS)
+        sync_blocks(self.nodes)
+        assert_equal(utxo_summary(node1), utxo_summary(node0))
+        assert_raises_rpc_error(-1, "pruned data", node1.getblock, node1.getblockhash(SNAPSHOT_HEIGHT))
+        node1.getblock(node1.getblockhash(SNAPSHOT_HEIGHT + 1))
+
+        self.log.info("Keep the chainstate across a restart")
+        self.restart_node(1, extra_args=["-prune=550"])
+        assert_equal(self.nodes[1].getbestblockhash(), node0.getbestblockhash())
+        assert_equal(utxo_summary(self.nodes[1]), utxo_summary(node0))
+
+if __name__ == '__main__':
+    SnapshotTest().main()
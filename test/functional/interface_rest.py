@@ -265,6 +265,16 @@ class RESTTest (BitcoinTestFramework):
         json_obj = json.loads(response_header_json_str)
         assert_equal(len(json_obj), 5) #now we should have 5 header objects
 
+        #see if we can get several blocks in one response
+        response_blocks = http_get_call(url.hostname, url.port, '/rest/blocks/2/'+bb_hash+self.FORMAT_SEPARATOR+"bin", True)
+        assert_equal(response_blocks.status, 200)
+        response_blocks_str = response_blocks.read()
+        assert_equal(response_blocks_str[0:len(response_str)], response_str)
+        next_block_str = http_get_call(url.hostname, url.port, '/rest/block/'+json_obj[1]['hash']+self.FORMAT_SEPARATOR+"bin", True).read()
+        assert_equal(response_blocks_str[len(response_str):], next_block_str)
+        response_blocks = http_get_call(url.hostname, url.port, '/rest/blocks/2/'+bb_hash+self.FORMAT_SEPARATOR+"json", True)
+        assert_equal(response_blocks.status, 404)
+
         # do tx test
         tx_hash = block_json_obj['tx'][0]['txid']
         json_string = http_get_call(url.hostname, url.port, '/rest/tx/'+tx_hash+self.FORMAT_SEPARATOR+"json")
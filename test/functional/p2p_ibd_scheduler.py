@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+# Copyright (c) 2022 The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Benchmark initial block download from simulated peers of different speeds.
+
+Each node downloads a chain built by the test from several P2PInterface peers.
+The peers answer getdata one block at a time after a fixed delay, like a link
+with limited bandwidth.
+
+1. node0 syncs from three fast peers and one slow peer.
+
+2. node1 syncs from three fast peers, one of which stops answering part of
+   the way through. The blocks it was asked for must be reassigned to the
+   other peers, long before the block download timeout would disconnect it,
+   and it must only be asked for one block at a time from then on.
+
+How many blocks each peer serves, and the window it ends up with, depend on
+timing, so they are only logged along with the time each download took.
+"""
+import os
+import queue
+import re
+import threading
+import time
+
+from test_framework.blocktools import create_block, create_coinbase
+from test_framework.mininode import (
+    CBlockHeader,
+    NODE_NETWORK,
+    NODE_WITNESS,
+    P2PInterface,
+    msg_block,
+    msg_headers,
+    network_thread_running,
+    network_thread_start,
+)
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal, wait_until
+
+# Peers must support drivechain for us to download blocks from them
+NODE_DRIVECHAIN = (1 << 5)
+
+NUM_BLOCKS = 500
+# The block download timeout is at least one block interval, ten minutes on
+# regtest, so a download that finishes within this was not waiting for it
+DOWNLOAD_TIME_LIMIT = 60
+FAST_PEER_DELAY = 0.01
+SLOW_PEER_DELAY = 0.25
+
+class BlockServer(P2PInterface):
+    """Serve requested blocks in order, waiting delay seconds before each."""
+    def __init__(self, blocks, delay, stop_after=None):
+        super().__init__()
+        self.blocks = blocks
+        self.delay = delay
+        self.stop_after = stop_after
+        self.served = 0
+        self.requested_after_stop = 0
+        self.requests = queue.Queue()
+        self.worker = threading.Thread(target=self.serve_blocks, daemon=True)
+        self.worker.start()
+
+    def on_getdata(self, message):
+        for inv in message.inv:
+            if inv.hash in self.blocks:
+                if self.stop_after is not None and self.served >= self.stop_after:
+                    self.requested_after_stop += 1
+                self.requests.put(inv.hash)
+
+    def serve_blocks(self):
+        while True:
+            blockhash = self.requests.get()
+            if self.stop_after is not None and self.served >= self.stop_after:
+                continue
+            time.sleep(self.delay)
+            if self.state != "connected":
+                return
+            self.send_message(msg_block(self.blocks[blockhash]))
+            self.served += 1
+
+    def announce(self, chain):
+        headers_message = msg_headers()
+        headers_message.headers = [CBlockHeader(b) for b in chain]
+        self.send_message(headers_message)
+
+class IBDSchedulerTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+
+    def setup_network(self):
+        # The nodes only download from the simulated peers
+        self.setup_nodes()
+
+    def build_chain(self):
+        tip = int(self.nodes[0].getbestblockhash(), 16)
+        # Keep the blocks old so the nodes stay in initial block download
+        block_time = self.nodes[0].getblock(self.nodes[0].getbestblockhash())['time'] + 1
+        chain = []
+        for height in range(1, NUM_BLOCKS + 1):
+            block = create_block(tip, create_coinbase(height), block_time)
+            block.solve()
+            chain.append(block)
+            tip = block.sha256
+            block_time += 1
+        return chain
+
+    def download(self, node, chain, peers):
+        blocks = {b.sha256: b for b in chain}
+        for peer in peers:
+            peer.blocks = blocks
+            node.add_p2p_connection(peer, services=NODE_NETWORK | NODE_WITNESS | NODE_DRIVECHAIN)
+        if not network_thread_running():
+            network_thread_start()
+        for peer in peers:
+            peer.wait_for_verack()
+
+        start = time.time()
+        for peer in peers:
+            peer.announce(chain)
+        wait_until(lambda: node.getblockcount() == NUM_BLOCKS, timeout=DOWNLOAD_TIME_LIMIT)
+        elapsed = time.time() - start
+        assert_equal(node.getbestblockhash(), chain[-1].hash)
+
+        peerinfo = sorted(node.getpeerinfo(), key=lambda p: p['id'])
+        for peer, info in zip(peers, peerinfo):
+            self.log.info("  peer=%d delay=%.2fs served=%d window=%d interval=%.3fs" % (
+                info['id'], peer.delay, peer.served, info['blockwindow'], info['blockinterval']))
+        self.log.info("  downloaded %d blocks in %.2fs" % (NUM_BLOCKS, elapsed))
+        return peerinfo
+
+    def reassigned_from(self, node, peerid):
+        """Number of blocks node's debug log shows were reassigned from peerid."""
+        with open(os.path.join(node.datadir, "regtest", "debug.log"), encoding="utf-8") as log:
+            return len(re.findall(r"Reassigning block \w+ \(\d+\) from peer=%d to " % peerid, log.read()))
+
+    def run_test(self):
+        chain = self.build_chain()
+
+        # Peers can only be created while the network thread is not running
+        fast = [BlockServer({}, FAST_PEER_DELAY) for _ in range(3)]
+        slow = BlockServer({}, SLOW_PEER_DELAY)
+        stalling = BlockServer({}, FAST_PEER_DELAY, stop_after=20)
+        fast_with_stalling = [BlockServer({}, FAST_PEER_DELAY) for _ in range(2)]
+
+        self.log.info("Download from three fast peers and one slow peer")
+        peers = fast + [slow]
+        self.download(self.nodes[0], chain, peers)
+        # A peer counts a block as served only after sending it
+        wait_until(lambda: sum(p.served for p in peers) >= NUM_BLOCKS, timeout=10)
+
+        self.log.info("Download from three fast peers, one of which stalls")
+        peerinfo = self.download(self.nodes[1], chain, [stalling] + fast_with_stalling)
+        assert_equal(stalling.served, 20)
+        # The blocks the stalling peer held back came from the others
+        wait_until(lambda: sum(p.served for p in fast_with_stalling) >= NUM_BLOCKS - 20, timeout=10)
+        reassigned = self.reassigned_from(self.nodes[1], peerinfo[0]['id'])
+        self.log.info("  %d blocks reassigned from the stalling peer, which was asked for %d after it stopped" % (
+            reassigned, stalling.requested_after_stop))
+        assert reassigned > 0
+        # Once blocks are taken away from a peer it is only asked for one at a
+        # time until it delivers again
+        assert_equal(peerinfo[0]['blockwindow'], 1)
+        assert len(peerinfo[0]['inflight']) <= 1
+        assert stalling.requested_after_stop <= reassigned + 1
+
+if __name__ == '__main__':
+    IBDSchedulerTest().main()
@@ -156,6 +156,8 @@ EXTENDED_SCRIPTS = [
     'p2p_feefilter.py',
     'rpc_bind.py',
     # vv Tests less than 30s vv
+    'p2p_ibd_scheduler.py',
+    'feature_snapshot.py',
     'feature_assumevalid.py',
     'example_test.py',
     'wallet_txn_doublespend.py',